@@ -0,0 +1,177 @@
+#include "bigquery_credentials.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+
+#include <google/cloud/storage/oauth2/google_credentials.h>
+
+namespace gcpoauth2 = google::cloud::storage::oauth2;
+
+namespace duckdb {
+
+//! How often the tokens in use are checked. The credentials refresh their token within the last minutes before it
+//! expires, so this has to be shorter than that.
+static constexpr int64_t TOKEN_REFRESH_INTERVAL_MS = 60 * 1000;
+//! Tokens that have not been used for this long are refreshed on their next use instead
+static constexpr int64_t TOKEN_IDLE_MS = 15 * 60 * 1000;
+//! Credentials that have not been used for this long are dropped, along with the private key of the service account.
+//! Their token has expired by then, so the next use costs the same token request as keeping them would.
+static constexpr int64_t CREDENTIAL_IDLE_MS = 60 * 60 * 1000;
+
+static int64_t GetCurrentEpochMs() {
+	return Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp());
+}
+
+//! Adds the cached token to every gRPC call
+class BigQueryTokenPlugin : public grpc::MetadataCredentialsPlugin {
+public:
+	BigQueryTokenPlugin(BigQueryCredentialCache &cache, string service_account_json)
+	    : cache(cache), service_account_json(std::move(service_account_json)) {
+	}
+
+	bool IsBlocking() const override {
+		// the token is only fetched on the first call, and when the background refresh has not run in time
+		return true;
+	}
+
+	grpc::Status GetMetadata(grpc::string_ref service_url, grpc::string_ref method_name,
+	                         const grpc::AuthContext &channel_auth_context,
+	                         std::multimap<grpc::string, grpc::string> *metadata) override {
+		try {
+			metadata->emplace("authorization", "Bearer " + cache.GetAccessToken(service_account_json));
+		} catch (std::exception &ex) {
+			return grpc::Status(grpc::StatusCode::UNAUTHENTICATED, ex.what());
+		}
+		return grpc::Status::OK;
+	}
+
+private:
+	BigQueryCredentialCache &cache;
+	string service_account_json;
+};
+
+BigQueryCredentialCache::BigQueryCredentialCache() {
+	// the cache is never destroyed, the thread runs until the process exits
+	std::thread([this]() { RefreshLoop(); }).detach();
+}
+
+BigQueryCredentialCache &BigQueryCredentialCache::Get() {
+	// never destroyed: at exit, the destructor would have to join the refresh thread, which may be blocked in a token
+	// request for as long as its timeout
+	static auto cache = new BigQueryCredentialCache();
+	return *cache;
+}
+
+shared_ptr<BigQueryCredentialCache::CredentialEntry>
+BigQueryCredentialCache::CreateEntry(const string &service_account_json) {
+	google::cloud::StatusOr<std::shared_ptr<gcpoauth2::Credentials>> credentials;
+	if (service_account_json.empty()) {
+		credentials = gcpoauth2::GoogleDefaultCredentials();
+	} else {
+		credentials = gcpoauth2::CreateServiceAccountCredentialsFromJsonContents(service_account_json);
+	}
+	if (!credentials) {
+		throw std::runtime_error("Failed to create credentials: " + credentials.status().message());
+	}
+	auto entry = make_shared_ptr<CredentialEntry>();
+	entry->credentials = std::move(credentials).value();
+	return entry;
+}
+
+shared_ptr<BigQueryCredentialCache::CredentialEntry>
+BigQueryCredentialCache::GetEntry(const string &service_account_json) {
+	std::promise<shared_ptr<CredentialEntry>> promise;
+	std::shared_future<shared_ptr<CredentialEntry>> in_flight;
+	{
+		lock_guard<mutex> guard(lock);
+		auto entry = entries.find(service_account_json);
+		if (entry != entries.end()) {
+			entry->second->last_used = GetCurrentEpochMs();
+			return entry->second;
+		}
+		auto pending = pending_entries.find(service_account_json);
+		if (pending != pending_entries.end()) {
+			in_flight = pending->second;
+		} else {
+			pending_entries[service_account_json] = promise.get_future().share();
+		}
+	}
+	if (in_flight.valid()) {
+		// rethrows the error of the other caller
+		auto entry = in_flight.get();
+		entry->last_used = GetCurrentEpochMs();
+		return entry;
+	}
+	// the default credentials may go over the network, e.g. to the metadata server, so they are created without
+	// blocking the lookups of the other identities
+	shared_ptr<CredentialEntry> entry;
+	try {
+		entry = CreateEntry(service_account_json);
+	} catch (...) {
+		promise.set_exception(std::current_exception());
+		lock_guard<mutex> guard(lock);
+		pending_entries.erase(service_account_json);
+		throw;
+	}
+	entry->last_used = GetCurrentEpochMs();
+	promise.set_value(entry);
+	lock_guard<mutex> guard(lock);
+	entries[service_account_json] = entry;
+	pending_entries.erase(service_account_json);
+	return entry;
+}
+
+string BigQueryCredentialCache::RequestAccessToken(CredentialEntry &entry) {
+	// the credentials return their current token, and only request a new one when it is about to expire
+	auto header = entry.credentials->AuthorizationHeader();
+	if (!header) {
+		throw std::runtime_error("Failed to obtain access token: " + header.status().message());
+	}
+	// Remove the "Authorization: Bearer " prefix
+	static const string prefix = "Authorization: Bearer ";
+	if (header->compare(0, prefix.size(), prefix) != 0) {
+		throw std::runtime_error("Unexpected authorization header format");
+	}
+	return header->substr(prefix.size());
+}
+
+string BigQueryCredentialCache::GetAccessToken(const string &service_account_json) {
+	return RequestAccessToken(*GetEntry(service_account_json));
+}
+
+std::shared_ptr<grpc::ChannelCredentials>
+BigQueryCredentialCache::GetChannelCredentials(const string &service_account_json) {
+	auto call_credentials =
+	    grpc::MetadataCredentialsFromPlugin(std::make_unique<BigQueryTokenPlugin>(*this, service_account_json));
+	return grpc::CompositeChannelCredentials(grpc::SslCredentials(grpc::SslCredentialsOptions()),
+	                                         call_credentials);
+}
+
+void BigQueryCredentialCache::RefreshLoop() {
+	while (true) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(TOKEN_REFRESH_INTERVAL_MS));
+		unique_lock<mutex> guard(lock);
+		vector<shared_ptr<CredentialEntry>> active_entries;
+		auto now = GetCurrentEpochMs();
+		for (auto entry = entries.begin(); entry != entries.end();) {
+			auto idle_ms = now - entry->second->last_used;
+			if (idle_ms >= CREDENTIAL_IDLE_MS) {
+				// requests that are still using the credentials keep them alive
+				entry = entries.erase(entry);
+				continue;
+			}
+			if (idle_ms < TOKEN_IDLE_MS) {
+				active_entries.push_back(entry->second);
+			}
+			entry++;
+		}
+		guard.unlock();
+		for (auto &entry : active_entries) {
+			try {
+				RequestAccessToken(*entry);
+			} catch (std::exception &) {
+				// the next request for the token reports the error
+			}
+		}
+	}
+}
+
+} // namespace duckdb
@@ -3,7 +3,9 @@
 
 #include "bigquery_scanner.hpp"
 #include "bigquery_query.hpp"
+#include "bigquery_prefetch.hpp"
 #include "bigquery_storage.hpp"
+#include "bigquery_sync.hpp"
 #include "duckdb_bigquery_extension.hpp"
 
 #include "duckdb/catalog/catalog.hpp"
@@ -48,9 +50,24 @@ void SetBigQuerySecretParameters(CreateSecretFunction &function) {
 
 static void LoadInternal(DatabaseInstance &db) {
 
+	BigQueryScanFunction scan_func;
+	ExtensionUtil::RegisterFunction(db, scan_func);
+
 	BigQueryClearCacheFunction clear_cache_func;
 	ExtensionUtil::RegisterFunction(db, clear_cache_func);
 
+	BigQueryScanCacheFunction scan_cache_func;
+	ExtensionUtil::RegisterFunction(db, scan_cache_func);
+
+	BigQueryCatalogMemoryFunction catalog_memory_func;
+	ExtensionUtil::RegisterFunction(db, catalog_memory_func);
+
+	BigQueryPrefetchFunction prefetch_func;
+	ExtensionUtil::RegisterFunction(db, prefetch_func);
+
+	BigQuerySyncFunction sync_func;
+	ExtensionUtil::RegisterFunction(db, sync_func);
+
 	//Execute function cover action with side effects like insert, update, delete
 	// TODO support them in a future version
 	BigQueryExecuteFunction execute_function;
@@ -74,11 +91,71 @@ static void LoadInternal(DatabaseInstance &db) {
 
 	auto &config = DBConfig::GetConfig(db);
 	config.storage_extensions["duckdb_bigquery"] = make_uniq<BigQueryStorageExtension>();
+	config.replacement_scans.emplace_back(BigQueryScanFunction::ReplacementScan);
 
 	// Add BigQuery extension specific options
 	config.AddExtensionOption("bigquery_filter_pushdown",
 	                          "Whether or not to use filter pushdown", LogicalType::BOOLEAN,
 	                          Value::BOOLEAN(true));
+	config.AddExtensionOption("bigquery_late_materialization",
+	                          "Whether or not to first read only the primary key of filtered rows on wide tables, "
+	                          "and then read the remaining columns for the matching keys",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(false));
+	config.AddExtensionOption("bigquery_late_materialization_max_keys",
+	                          "The maximum number of matching keys for which late materialization is used",
+	                          LogicalType::UBIGINT, Value::UBIGINT(10000));
+	config.AddExtensionOption("bigquery_scan_cache_directory",
+	                          "Directory in which scan results are cached as Arrow IPC files (disabled if empty)",
+	                          LogicalType::VARCHAR, Value(""));
+	config.AddExtensionOption("bigquery_scan_cache_max_bytes",
+	                          "The maximum size of the scan cache, least recently used entries are evicted beyond it",
+	                          LogicalType::UBIGINT, Value::UBIGINT(10ULL * 1024 * 1024 * 1024));
+	config.AddExtensionOption("bigquery_table_cache_ttl",
+	                          "Seconds for which decoded scan results are kept in memory (disabled if 0)",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("bigquery_table_cache_max_bytes",
+	                          "The maximum size of the in-memory table cache, least recently used entries are evicted "
+	                          "beyond it",
+	                          LogicalType::UBIGINT, Value::UBIGINT(1ULL * 1024 * 1024 * 1024));
+	config.AddExtensionOption("bigquery_load_dataset_metadata",
+	                          "Whether or not the metadata of all tables of a dataset is loaded with a single query when "
+	                          "the dataset is first accessed, instead of one request per table",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(true));
+	config.AddExtensionOption("bigquery_metadata_cache_path",
+	                          "File in which the table metadata is kept across processes, read when a BigQuery database "
+	                          "is attached (disabled if empty)",
+	                          LogicalType::VARCHAR, Value(""));
+	config.AddExtensionOption("bigquery_prefetch_statement_metadata",
+	                          "Whether or not the metadata of all BigQuery tables referenced by a query is fetched "
+	                          "concurrently before the query is bound",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(true));
+	config.AddExtensionOption("bigquery_metadata_ttl",
+	                          "Seconds after which a cached table entry is revalidated in the background when it is "
+	                          "bound (disabled if 0)",
+	                          LogicalType::UBIGINT, Value::UBIGINT(3600));
+	config.AddExtensionOption("bigquery_catalog_max_bytes",
+	                          "The maximum memory used by the cached table metadata of all BigQuery databases, least "
+	                          "recently used tables are evicted beyond it (unlimited if 0)",
+	                          LogicalType::UBIGINT, Value::UBIGINT(1024ULL * 1024 * 1024));
+	config.AddExtensionOption("bigquery_view_cache_ttl",
+	                          "Seconds for which the query job results of views are reused by later scans, which may "
+	                          "then miss changes of the underlying tables (disabled if 0)",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("bigquery_read_session_cache",
+	                          "Whether or not the read sessions of earlier scans are reused by later scans of the same "
+	                          "table version, which costs a version check per reuse",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(false));
+	config.AddExtensionOption("bigquery_shared_scans",
+	                          "Whether or not concurrent scans of the same table share one read session",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(true));
+	config.AddExtensionOption("bigquery_external_tables_direct",
+	                          "Whether or not external tables over Parquet files are read from the files with "
+	                          "DuckDB's Parquet reader instead of through BigQuery",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(false));
+	config.AddExtensionOption("bigquery_snapshot_time",
+	                          "Point in time at which BigQuery tables are read (time travel), the start of the "
+	                          "transaction if NULL",
+	                          LogicalType::TIMESTAMP_TZ, Value(LogicalType::TIMESTAMP_TZ));
 	// config.AddExtensionOption("bigquery_debug_show_queries", "DEBUG SETTING: print all queries sent to BigQuery to stdout",
 	//                           LogicalType::BOOLEAN, Value::BOOLEAN(false), SetBigQueryDebugQueryPrint);
 
@@ -1,5 +1,10 @@
 #include "bigquery_filter_pushdown.hpp"
 #include "bigquery_utils.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
 
 namespace duckdb {
 
@@ -66,13 +71,16 @@ string BigQueryFilterPushdown::TransformFilter(string &column_name, TableFilter
 }
 
 string BigQueryFilterPushdown::TransformFilters(const vector<column_t> &column_ids, optional_ptr<TableFilterSet> filters,
-                                             const vector<string> &names) {
+                                             const vector<string> &names, optional_idx local_column) {
 	if (!filters || filters->filters.empty()) {
 		// no filters
 		return string();
 	}
 	string result;
 	for (auto &entry : filters->filters) {
+		if (local_column.IsValid() && column_ids[entry.first] == local_column.GetIndex()) {
+			continue;
+		}
 		if (!result.empty()) {
 			result += " AND ";
 		}
@@ -83,4 +91,109 @@ string BigQueryFilterPushdown::TransformFilters(const vector<column_t> &column_i
 	return result;
 }
 
+string BigQueryFilterPushdown::TransformNestedColumn(Expression &expr, LogicalGet &get, const vector<string> &names) {
+	vector<string> path;
+	auto column_ref = BigQueryUtils::GetStructExtractPath(expr, path);
+	if (!column_ref || path.empty() || column_ref->binding.table_index != get.table_index) {
+		// only filters on nested fields are handled here, top-level columns go through the table filters
+		return string();
+	}
+	auto column_index = column_ref->binding.column_index;
+	if (column_index >= get.column_ids.size() || get.column_ids[column_index] >= names.size()) {
+		return string();
+	}
+	auto result = BigQueryUtils::WriteIdentifier(names[get.column_ids[column_index]]);
+	for (auto &field : path) {
+		result += "." + BigQueryUtils::WriteIdentifier(field);
+	}
+	return result;
+}
+
+string BigQueryFilterPushdown::TransformNestedConstant(Expression &expr) {
+	if (expr.type != ExpressionType::VALUE_CONSTANT) {
+		return string();
+	}
+	auto &val = expr.Cast<BoundConstantExpression>().value;
+	if (val.IsNull() || val.type().id() == LogicalTypeId::BLOB) {
+		return string();
+	}
+	return TransformConstant(val);
+}
+
+string BigQueryFilterPushdown::TransformNestedFilter(Expression &expr, LogicalGet &get, const vector<string> &names) {
+	switch (expr.GetExpressionClass()) {
+	case ExpressionClass::BOUND_COMPARISON: {
+		switch (expr.type) {
+		case ExpressionType::COMPARE_EQUAL:
+		case ExpressionType::COMPARE_NOTEQUAL:
+		case ExpressionType::COMPARE_LESSTHAN:
+		case ExpressionType::COMPARE_GREATERTHAN:
+		case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+		case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+			break;
+		default:
+			return string();
+		}
+		auto &comparison = expr.Cast<BoundComparisonExpression>();
+		auto comparison_type = comparison.type;
+		auto column = TransformNestedColumn(*comparison.left, get, names);
+		auto constant = TransformNestedConstant(*comparison.right);
+		if (column.empty()) {
+			// constant on the left hand side
+			column = TransformNestedColumn(*comparison.right, get, names);
+			constant = TransformNestedConstant(*comparison.left);
+			comparison_type = FlipComparisonExpression(comparison_type);
+		}
+		if (column.empty() || constant.empty()) {
+			return string();
+		}
+		return StringUtil::Format("%s %s %s", column, TransformComparison(comparison_type), constant);
+	}
+	case ExpressionClass::BOUND_OPERATOR: {
+		auto &op = expr.Cast<BoundOperatorExpression>();
+		if (op.children.empty()) {
+			return string();
+		}
+		auto column = TransformNestedColumn(*op.children[0], get, names);
+		if (column.empty()) {
+			return string();
+		}
+		switch (op.type) {
+		case ExpressionType::OPERATOR_IS_NULL:
+			return column + " IS NULL";
+		case ExpressionType::OPERATOR_IS_NOT_NULL:
+			return column + " IS NOT NULL";
+		case ExpressionType::COMPARE_IN: {
+			vector<string> constants;
+			for (idx_t i = 1; i < op.children.size(); i++) {
+				auto constant = TransformNestedConstant(*op.children[i]);
+				if (constant.empty()) {
+					return string();
+				}
+				constants.push_back(std::move(constant));
+			}
+			return column + " IN (" + StringUtil::Join(constants, ", ") + ")";
+		}
+		default:
+			return string();
+		}
+	}
+	case ExpressionClass::BOUND_CONJUNCTION: {
+		auto &conjunction = expr.Cast<BoundConjunctionExpression>();
+		vector<string> filter_entries;
+		for (auto &child : conjunction.children) {
+			auto child_filter = TransformNestedFilter(*child, get, names);
+			if (child_filter.empty()) {
+				return string();
+			}
+			filter_entries.push_back(std::move(child_filter));
+		}
+		auto op = expr.type == ExpressionType::CONJUNCTION_AND ? " AND " : " OR ";
+		return "(" + StringUtil::Join(filter_entries, op) + ")";
+	}
+	default:
+		return string();
+	}
+}
+
 } // namespace duckdb
@@ -0,0 +1,319 @@
+#include "bigquery_geography.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
+
+#include <cstring>
+#include <limits>
+
+namespace duckdb {
+
+enum class WKBGeometryType : uint32_t {
+	POINT = 1,
+	LINESTRING = 2,
+	POLYGON = 3,
+	MULTIPOINT = 4,
+	MULTILINESTRING = 5,
+	MULTIPOLYGON = 6,
+	GEOMETRYCOLLECTION = 7
+};
+
+// Single pass WKT reader that writes little-endian WKB as it goes. BigQuery only ever emits 2D geographies,
+// so Z/M coordinates are not supported. A converter is reused for all values of a column, so that the output buffer
+// is only allocated once.
+class WKTToWKBConverter {
+public:
+	//! Converts the WKT into the returned buffer, which is valid until the next call
+	const string &Convert(const char *data_p, idx_t size_p) {
+		data = data_p;
+		size = size_p;
+		pos = 0;
+		wkb.clear();
+		ParseGeometry();
+		SkipWhitespace();
+		if (pos != size) {
+			throw InvalidInputException("Unexpected trailing characters in WKT \"%s\"", string(data, size));
+		}
+		return wkb;
+	}
+
+private:
+	void SkipWhitespace() {
+		while (pos < size && StringUtil::CharacterIsSpace(data[pos])) {
+			pos++;
+		}
+	}
+
+	bool TryConsume(char c) {
+		SkipWhitespace();
+		if (pos < size && data[pos] == c) {
+			pos++;
+			return true;
+		}
+		return false;
+	}
+
+	void Expect(char c) {
+		if (!TryConsume(c)) {
+			throw InvalidInputException("Expected '%c' at position %llu in WKT \"%s\"", c, pos, string(data, size));
+		}
+	}
+
+	string ParseKeyword() {
+		SkipWhitespace();
+		auto start = pos;
+		while (pos < size && StringUtil::CharacterIsAlpha(data[pos])) {
+			pos++;
+		}
+		return StringUtil::Upper(string(data + start, pos - start));
+	}
+
+	bool TryConsumeEmpty() {
+		auto start = pos;
+		if (ParseKeyword() == "EMPTY") {
+			return true;
+		}
+		pos = start;
+		return false;
+	}
+
+	double ParseDouble() {
+		SkipWhitespace();
+		auto start = pos;
+		while (pos < size && (StringUtil::CharacterIsDigit(data[pos]) || data[pos] == '-' || data[pos] == '+' ||
+		                      data[pos] == '.' || data[pos] == 'e' || data[pos] == 'E')) {
+			pos++;
+		}
+		if (start == pos) {
+			throw InvalidInputException("Expected a coordinate at position %llu in WKT \"%s\"", pos,
+			                            string(data, size));
+		}
+		return Cast::Operation<string_t, double>(string_t(data + start, static_cast<uint32_t>(pos - start)));
+	}
+
+	void WriteUInt32(uint32_t value) {
+		wkb.append(reinterpret_cast<const char *>(&value), sizeof(uint32_t));
+	}
+
+	void WriteDouble(double value) {
+		wkb.append(reinterpret_cast<const char *>(&value), sizeof(double));
+	}
+
+	void WriteHeader(WKBGeometryType type) {
+		// byte order: 1 = little endian
+		wkb.push_back(1);
+		WriteUInt32(static_cast<uint32_t>(type));
+	}
+
+	//! Reserves space for an element count that is only known once the list has been parsed
+	idx_t ReserveCount() {
+		auto count_pos = wkb.size();
+		WriteUInt32(0);
+		return count_pos;
+	}
+
+	void PatchCount(idx_t count_pos, uint32_t count) {
+		memcpy(&wkb[count_pos], &count, sizeof(uint32_t));
+	}
+
+	void ParseCoordinate() {
+		WriteDouble(ParseDouble());
+		WriteDouble(ParseDouble());
+	}
+
+	//! ( x y, x y, ... )
+	void ParseCoordinateList() {
+		Expect('(');
+		auto count_pos = ReserveCount();
+		uint32_t count = 0;
+		do {
+			ParseCoordinate();
+			count++;
+		} while (TryConsume(','));
+		Expect(')');
+		PatchCount(count_pos, count);
+	}
+
+	//! ( (ring), (ring), ... )
+	void ParseRingList() {
+		Expect('(');
+		auto count_pos = ReserveCount();
+		uint32_t count = 0;
+		do {
+			ParseCoordinateList();
+			count++;
+		} while (TryConsume(','));
+		Expect(')');
+		PatchCount(count_pos, count);
+	}
+
+	void ParsePoint() {
+		WriteHeader(WKBGeometryType::POINT);
+		if (TryConsumeEmpty()) {
+			// WKB has no empty point, by convention it is encoded with NaN coordinates
+			WriteDouble(std::numeric_limits<double>::quiet_NaN());
+			WriteDouble(std::numeric_limits<double>::quiet_NaN());
+			return;
+		}
+		Expect('(');
+		ParseCoordinate();
+		Expect(')');
+	}
+
+	void ParseLineString() {
+		WriteHeader(WKBGeometryType::LINESTRING);
+		if (TryConsumeEmpty()) {
+			WriteUInt32(0);
+			return;
+		}
+		ParseCoordinateList();
+	}
+
+	void ParsePolygon() {
+		WriteHeader(WKBGeometryType::POLYGON);
+		if (TryConsumeEmpty()) {
+			WriteUInt32(0);
+			return;
+		}
+		ParseRingList();
+	}
+
+	void ParseMultiPoint() {
+		WriteHeader(WKBGeometryType::MULTIPOINT);
+		if (TryConsumeEmpty()) {
+			WriteUInt32(0);
+			return;
+		}
+		Expect('(');
+		auto count_pos = ReserveCount();
+		uint32_t count = 0;
+		do {
+			// both "MULTIPOINT(1 2, 3 4)" and "MULTIPOINT((1 2), (3 4))" are valid WKT
+			WriteHeader(WKBGeometryType::POINT);
+			if (TryConsume('(')) {
+				ParseCoordinate();
+				Expect(')');
+			} else {
+				ParseCoordinate();
+			}
+			count++;
+		} while (TryConsume(','));
+		Expect(')');
+		PatchCount(count_pos, count);
+	}
+
+	void ParseMultiLineString() {
+		WriteHeader(WKBGeometryType::MULTILINESTRING);
+		if (TryConsumeEmpty()) {
+			WriteUInt32(0);
+			return;
+		}
+		Expect('(');
+		auto count_pos = ReserveCount();
+		uint32_t count = 0;
+		do {
+			WriteHeader(WKBGeometryType::LINESTRING);
+			ParseCoordinateList();
+			count++;
+		} while (TryConsume(','));
+		Expect(')');
+		PatchCount(count_pos, count);
+	}
+
+	void ParseMultiPolygon() {
+		WriteHeader(WKBGeometryType::MULTIPOLYGON);
+		if (TryConsumeEmpty()) {
+			WriteUInt32(0);
+			return;
+		}
+		Expect('(');
+		auto count_pos = ReserveCount();
+		uint32_t count = 0;
+		do {
+			WriteHeader(WKBGeometryType::POLYGON);
+			ParseRingList();
+			count++;
+		} while (TryConsume(','));
+		Expect(')');
+		PatchCount(count_pos, count);
+	}
+
+	void ParseGeometryCollection() {
+		WriteHeader(WKBGeometryType::GEOMETRYCOLLECTION);
+		if (TryConsumeEmpty()) {
+			WriteUInt32(0);
+			return;
+		}
+		Expect('(');
+		auto count_pos = ReserveCount();
+		uint32_t count = 0;
+		do {
+			ParseGeometry();
+			count++;
+		} while (TryConsume(','));
+		Expect(')');
+		PatchCount(count_pos, count);
+	}
+
+	void ParseGeometry() {
+		auto keyword = ParseKeyword();
+		if (keyword == "POINT") {
+			ParsePoint();
+		} else if (keyword == "LINESTRING") {
+			ParseLineString();
+		} else if (keyword == "POLYGON") {
+			ParsePolygon();
+		} else if (keyword == "MULTIPOINT") {
+			ParseMultiPoint();
+		} else if (keyword == "MULTILINESTRING") {
+			ParseMultiLineString();
+		} else if (keyword == "MULTIPOLYGON") {
+			ParseMultiPolygon();
+		} else if (keyword == "GEOMETRYCOLLECTION") {
+			ParseGeometryCollection();
+		} else {
+			throw InvalidInputException("Unsupported geometry type \"%s\" in WKT \"%s\"", keyword, string(data, size));
+		}
+	}
+
+private:
+	const char *data = nullptr;
+	idx_t size = 0;
+	idx_t pos = 0;
+	string wkb;
+};
+
+LogicalType BigQueryGeography::GeographyType() {
+	auto type = LogicalType(LogicalTypeId::BLOB);
+	type.SetAlias("WKB_BLOB");
+	return type;
+}
+
+bool BigQueryGeography::IsGeographyType(const LogicalType &type) {
+	return type.id() == LogicalTypeId::BLOB && type.HasAlias() && type.GetAlias() == "WKB_BLOB";
+}
+
+string BigQueryGeography::WKTToWKB(const string_t &wkt) {
+	WKTToWKBConverter converter;
+	return converter.Convert(wkt.GetData(), wkt.GetSize());
+}
+
+void BigQueryGeography::WKTColumnToWKB(const arrow::StringArray &column, idx_t offset, idx_t count, Vector &result,
+                                       idx_t result_offset) {
+	auto result_data = FlatVector::GetData<string_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+	// the values are read straight from the offsets and the data buffer of the slice, and converted into one buffer
+	// that is reused for every row
+	auto value_offsets = column.raw_value_offsets() + offset;
+	auto value_data = reinterpret_cast<const char *>(column.raw_data());
+	bool has_nulls = column.null_count() > 0;
+	WKTToWKBConverter converter;
+	for (idx_t i = 0; i < count; i++) {
+		if (has_nulls && column.IsNull(static_cast<int64_t>(offset + i))) {
+			result_validity.SetInvalid(result_offset + i);
+			continue;
+		}
+		auto &wkb = converter.Convert(value_data + value_offsets[i], value_offsets[i + 1] - value_offsets[i]);
+		result_data[result_offset + i] = StringVector::AddStringOrBlob(result, wkb.data(), wkb.size());
+	}
+}
+
+} // namespace duckdb
@@ -0,0 +1,224 @@
+#include "bigquery_prefetch.hpp"
+#include "bigquery_result.hpp"
+#include "bigquery_utils.hpp"
+#include "storage/bigquery_catalog.hpp"
+#include "storage/bigquery_table_entry.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+
+#include <algorithm>
+
+#include "google/cloud/bigquery/storage/v1/bigquery_read_client.h"
+
+namespace bigquery_storage = ::google::cloud::bigquery_storage_v1;
+namespace bigquery_storage_read = ::google::cloud::bigquery::storage::v1;
+
+namespace duckdb {
+
+BigQueryBackgroundScheduler::BigQueryBackgroundScheduler() : cancel_running(false) {
+	worker = std::thread([this]() { WorkerLoop(); });
+}
+
+BigQueryBackgroundScheduler::~BigQueryBackgroundScheduler() {
+	{
+		lock_guard<mutex> guard(lock);
+		shutdown = true;
+		cancel_running = true;
+	}
+	job_available.notify_all();
+	worker.join();
+}
+
+shared_ptr<BigQueryBackgroundScheduler> BigQueryBackgroundScheduler::Get(DatabaseInstance &db, const string &queue) {
+	return db.GetObjectCache().GetOrCreate<BigQueryBackgroundScheduler>(ObjectType() + ":" + queue);
+}
+
+void BigQueryBackgroundScheduler::Schedule(const void *owner, job_function_t function) {
+	{
+		lock_guard<mutex> guard(lock);
+		jobs.push_back(BackgroundJob {owner, std::move(function)});
+	}
+	job_available.notify_one();
+}
+
+void BigQueryBackgroundScheduler::Cancel(const void *owner) {
+	unique_lock<mutex> guard(lock);
+	jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [&](const BackgroundJob &job) { return job.owner == owner; }),
+	           jobs.end());
+	if (running_owner == owner) {
+		cancel_running = true;
+		job_finished.wait(guard, [&]() { return running_owner != owner; });
+	}
+}
+
+void BigQueryBackgroundScheduler::WorkerLoop() {
+	unique_lock<mutex> guard(lock);
+	while (true) {
+		job_available.wait(guard, [&]() { return shutdown || !jobs.empty(); });
+		if (shutdown) {
+			return;
+		}
+		auto job = std::move(jobs.front());
+		jobs.pop_front();
+		running_owner = job.owner;
+		cancel_running = false;
+		guard.unlock();
+		try {
+			job.function(cancel_running);
+		} catch (...) {
+			// prefetching is best effort, the query that needs the data reports the actual error
+		}
+		guard.lock();
+		running_owner = nullptr;
+		job_finished.notify_all();
+	}
+}
+
+void BigQueryPrefetch::WarmScanCache(shared_ptr<BigQueryScanCache> cache, const BigQueryPrefetchRequest &request,
+                                     const std::atomic<bool> &cancelled) {
+	if (request.key.version.empty() || cache->TryOpen(request.key)) {
+		// the version of the table is unknown, or the data is already cached
+		return;
+	}
+	// projects/<project>/datasets/<dataset>/tables/<table>
+	auto table_path = StringUtil::Split(request.key.table, '/');
+	if (table_path.size() != 6) {
+		throw InvalidInputException("Invalid BigQuery table path \"%s\"", request.key.table);
+	}
+	auto client = bigquery_storage::BigQueryReadClient(
+	    BigQueryUtils::CreateReadConnection(request.service_account_json));
+	bigquery_storage_read::ReadSession read_session;
+	read_session.set_data_format(google::cloud::bigquery::storage::v1::DataFormat::ARROW);
+	read_session.set_table(request.key.table);
+	// the data is read as of now, which is the requested version if the table has not changed since
+	auto snapshot_time = Timestamp::GetCurrentTimestamp();
+	auto snapshot = read_session.mutable_table_modifiers()->mutable_snapshot_time();
+	snapshot->set_seconds(snapshot_time.value / Interval::MICROS_PER_SEC);
+	snapshot->set_nanos(static_cast<int32_t>(snapshot_time.value % Interval::MICROS_PER_SEC) * 1000);
+	for (auto &field : request.key.fields) {
+		read_session.mutable_read_options()->add_selected_fields(field);
+	}
+	if (!request.key.row_restriction.empty()) {
+		read_session.mutable_read_options()->set_row_restriction(request.key.row_restriction);
+	}
+	auto session = client.CreateReadSession("projects/" + request.execution_project, read_session, 1);
+	if (!session) {
+		throw std::move(session).status();
+	}
+	if (session->streams_size() == 0) {
+		return;
+	}
+	// a version that is still current after the snapshot was taken is the version of the snapshot
+	auto version = BigQueryUtils::BigQueryReadTableVersion(table_path[1], table_path[3], table_path[5],
+	                                                       request.service_account_json);
+	if (version.last_modified_time != request.key.version || cancelled) {
+		return;
+	}
+	BigQueryStreamBatchReader reader(client, *session, 0, 0);
+	BigQueryScanCacheWriter writer(std::move(cache), request.key, reader.GetSchema());
+	while (auto batch = reader.Next()) {
+		if (cancelled) {
+			// the writer drops the partial entry
+			return;
+		}
+		writer.Append(*batch);
+	}
+	writer.Commit();
+}
+
+struct PrefetchFunctionData : public TableFunctionData {
+	bool finished = false;
+	//! The catalog the table belongs to, its prefetches are cancelled when it is detached
+	optional_ptr<BigQueryCatalog> catalog;
+	shared_ptr<BigQueryScanCache> scan_cache;
+	BigQueryPrefetchRequest request;
+};
+
+static unique_ptr<FunctionData> PrefetchBind(ClientContext &context, TableFunctionBindInput &input,
+                                             vector<LogicalType> &return_types, vector<string> &names) {
+	auto qualified_name = QualifiedName::Parse(input.inputs[0].GetValue<string>());
+	auto &table = Catalog::GetEntry<TableCatalogEntry>(context, qualified_name.catalog, qualified_name.schema,
+	                                                    qualified_name.name);
+	if (table.catalog.GetCatalogType() != "bigquery") {
+		throw BinderException("bigquery_prefetch can only prefetch BigQuery tables");
+	}
+	auto &bigquery_table = table.Cast<BigQueryTableEntry>();
+	if (bigquery_table.wildcard) {
+		throw BinderException("bigquery_prefetch cannot prefetch wildcard tables");
+	}
+	if (bigquery_table.IsView()) {
+		throw BinderException("bigquery_prefetch cannot prefetch views");
+	}
+	auto &bigquery_catalog = table.catalog.Cast<BigQueryCatalog>();
+	auto scan_cache = BigQueryScanCache::TryGet(context);
+	if (!scan_cache) {
+		throw BinderException("bigquery_prefetch requires the scan cache, set bigquery_scan_cache_directory first");
+	}
+
+	BigQueryPrefetchRequest request;
+	request.execution_project = bigquery_catalog.execution_project;
+	request.service_account_json = bigquery_catalog.service_account_json;
+	request.key.table = "projects/" + bigquery_catalog.storage_project + "/datasets/" + table.schema.name +
+	                    "/tables/" + table.name;
+	request.key.version = bigquery_table.last_modified_time;
+	if (bigquery_table.revalidate) {
+		// the entry was loaded from the metadata cache file, the data is prefetched for the current version
+		auto current_table = bigquery_catalog.PreloadTable(table.schema.name, table.name);
+		request.key.version = current_table ? current_table->last_modified_time : string();
+	}
+	// prefetches are unfiltered: the scan cache matches row restrictions by their text, which only the scan's own
+	// filter pushdown produces, so a filtered prefetch would never be read
+	auto &columns = table.GetColumns();
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "columns") {
+			for (auto &column : ListValue::GetChildren(kv.second)) {
+				auto column_name = column.GetValue<string>();
+				if (!columns.ColumnExists(column_name)) {
+					throw BinderException("Table \"%s\" does not have a column named \"%s\"", table.name,
+					                      column_name);
+				}
+				request.key.fields.push_back(columns.GetColumn(column_name).GetName());
+			}
+		}
+	}
+	if (request.key.fields.empty()) {
+		for (auto &column : columns.Logical()) {
+			request.key.fields.push_back(column.GetName());
+		}
+	}
+	std::sort(request.key.fields.begin(), request.key.fields.end());
+
+	return_types.push_back(LogicalType::BOOLEAN);
+	names.emplace_back("Success");
+	auto result = make_uniq<PrefetchFunctionData>();
+	result->catalog = &bigquery_catalog;
+	result->scan_cache = std::move(scan_cache);
+	result->request = std::move(request);
+	return std::move(result);
+}
+
+static void PrefetchFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &data = data_p.bind_data->CastNoConst<PrefetchFunctionData>();
+	if (data.finished) {
+		return;
+	}
+	// the prefetch completes in the background, through the catalog so that it is cancelled on detach
+	auto scan_cache = data.scan_cache;
+	auto request = data.request;
+	auto &scheduler = data.catalog->GetDownloadScheduler(context);
+	scheduler.Schedule(data.catalog.get(), [scan_cache, request](const std::atomic<bool> &cancelled) {
+		BigQueryPrefetch::WarmScanCache(scan_cache, request, cancelled);
+	});
+	output.SetValue(0, 0, Value::BOOLEAN(true));
+	output.SetCardinality(1);
+	data.finished = true;
+}
+
+BigQueryPrefetchFunction::BigQueryPrefetchFunction()
+    : TableFunction("bigquery_prefetch", {LogicalType::VARCHAR}, PrefetchFunction, PrefetchBind) {
+	named_parameters["columns"] = LogicalType::LIST(LogicalType::VARCHAR);
+}
+
+} // namespace duckdb
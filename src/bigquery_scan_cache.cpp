@@ -0,0 +1,348 @@
+#include "bigquery_scan_cache.hpp"
+#include "bigquery_utils.hpp"
+#include "duckdb/common/local_file_system.hpp"
+#include "duckdb/common/optional_idx.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/common/types/uuid.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace duckdb {
+
+static constexpr const char *SCAN_CACHE_INDEX_FILE = "bigquery_scan_cache.json";
+
+static int64_t CurrentTimeMs() {
+	return Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp());
+}
+
+//! Whether a version (lastModifiedTime in milliseconds) precedes another, versions that do not parse are never older
+static bool IsOlderVersion(const string &version, const string &other) {
+	try {
+		return std::stoll(version) < std::stoll(other);
+	} catch (std::exception &) {
+		return false;
+	}
+}
+
+//! Reads a cached Arrow IPC file through a memory map, the batches reference the mapped pages directly
+class BigQueryCachedBatchReader : public BigQueryBatchReader {
+public:
+	BigQueryCachedBatchReader(std::shared_ptr<arrow::io::MemoryMappedFile> file_p,
+	                          std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader_p)
+	    : file(std::move(file_p)), reader(std::move(reader_p)) {
+	}
+
+	std::shared_ptr<arrow::Schema> GetSchema() override {
+		return reader->schema();
+	}
+
+	std::shared_ptr<arrow::RecordBatch> Next() override {
+		if (next_batch >= reader->num_record_batches()) {
+			return nullptr;
+		}
+		auto result = reader->ReadRecordBatch(next_batch++);
+		if (!result.ok()) {
+			throw IOException("Failed to read cached BigQuery batch: " + result.status().message());
+		}
+		return result.ValueOrDie();
+	}
+
+private:
+	std::shared_ptr<arrow::io::MemoryMappedFile> file;
+	std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader;
+	int next_batch = 0;
+};
+
+BigQueryScanCacheWriter::BigQueryScanCacheWriter(shared_ptr<BigQueryScanCache> cache_p, BigQueryScanCacheKey key,
+                                                 const std::shared_ptr<arrow::Schema> &schema)
+    : cache(std::move(cache_p)) {
+	entry.key = std::move(key);
+	entry.file_name = UUID::ToString(UUID::GenerateRandomUUID()) + ".arrow";
+	temp_path = cache->GetPath(entry.file_name + ".tmp");
+
+	auto file_result = arrow::io::FileOutputStream::Open(temp_path);
+	if (!file_result.ok()) {
+		throw IOException("Failed to create BigQuery scan cache file \"%s\": %s", temp_path,
+		                  file_result.status().message());
+	}
+	file = file_result.ValueOrDie();
+	auto writer_result = arrow::ipc::MakeFileWriter(file, schema);
+	if (!writer_result.ok()) {
+		throw IOException("Failed to create BigQuery scan cache file \"%s\": %s", temp_path,
+		                  writer_result.status().message());
+	}
+	writer = writer_result.ValueOrDie();
+}
+
+BigQueryScanCacheWriter::~BigQueryScanCacheWriter() {
+	if (committed) {
+		return;
+	}
+	// the scan did not run to completion, drop the partial file
+	if (writer) {
+		(void)writer->Close();
+	}
+	if (file) {
+		(void)file->Close();
+	}
+	std::remove(temp_path.c_str());
+}
+
+void BigQueryScanCacheWriter::Append(const arrow::RecordBatch &batch) {
+	auto status = writer->WriteRecordBatch(batch);
+	if (!status.ok()) {
+		throw IOException("Failed to write BigQuery scan cache file \"%s\": %s", temp_path, status.message());
+	}
+}
+
+void BigQueryScanCacheWriter::Commit() {
+	auto status = writer->Close();
+	if (!status.ok()) {
+		throw IOException("Failed to write BigQuery scan cache file \"%s\": %s", temp_path, status.message());
+	}
+	auto size = file->Tell();
+	if (!size.ok()) {
+		throw IOException("Failed to write BigQuery scan cache file \"%s\": %s", temp_path,
+		                  size.status().message());
+	}
+	entry.size = static_cast<idx_t>(size.ValueOrDie());
+	status = file->Close();
+	if (!status.ok()) {
+		throw IOException("Failed to write BigQuery scan cache file \"%s\": %s", temp_path, status.message());
+	}
+	if (std::rename(temp_path.c_str(), cache->GetPath(entry.file_name).c_str()) != 0) {
+		throw IOException("Failed to move BigQuery scan cache file \"%s\" into place", temp_path);
+	}
+	committed = true;
+	cache->Register(std::move(entry));
+}
+
+BigQueryScanCache::BigQueryScanCache(string directory_p) : fs(make_uniq<LocalFileSystem>()) {
+	directory = fs->ExpandPath(directory_p);
+	if (!fs->DirectoryExists(directory)) {
+		fs->CreateDirectory(directory);
+	}
+	LoadIndex();
+}
+
+shared_ptr<BigQueryScanCache> BigQueryScanCache::TryGet(ClientContext &context) {
+	Value directory;
+	if (!context.TryGetCurrentSetting("bigquery_scan_cache_directory", directory) || directory.IsNull() ||
+	    StringValue::Get(directory).empty()) {
+		return nullptr;
+	}
+	auto &directory_name = StringValue::Get(directory);
+	auto cache = ObjectCache::GetObjectCache(context).GetOrCreate<BigQueryScanCache>(
+	    ObjectType() + ":" + directory_name, directory_name);
+	Value max_bytes;
+	if (context.TryGetCurrentSetting("bigquery_scan_cache_max_bytes", max_bytes)) {
+		lock_guard<mutex> guard(cache->lock);
+		cache->max_bytes = UBigIntValue::Get(max_bytes);
+	}
+	return cache;
+}
+
+string BigQueryScanCache::GetPath(const string &file_name) const {
+	return fs->JoinPath(directory, file_name);
+}
+
+bool BigQueryScanCacheKey::Covers(const BigQueryScanCacheKey &other) const {
+	if (table != other.table || version != other.version || row_restriction != other.row_restriction) {
+		return false;
+	}
+	// a wider entry can serve a narrower projection, the scan picks its columns by name
+	return std::includes(fields.begin(), fields.end(), other.fields.begin(), other.fields.end());
+}
+
+unique_ptr<BigQueryBatchReader> BigQueryScanCache::TryOpen(const BigQueryScanCacheKey &key) {
+	lock_guard<mutex> guard(lock);
+	optional_idx best_entry;
+	bool removed_entries = false;
+	for (idx_t i = 0; i < entries.size(); i++) {
+		auto &entry = entries[i];
+		if (entry.key.table == key.table && IsOlderVersion(entry.key.version, key.version)) {
+			// the table has been modified since this entry was written. Newer entries are kept: a process with
+			// outdated metadata must not drop what another one wrote, LRU eviction removes them if unused
+			RemoveEntry(i);
+			removed_entries = true;
+			i--;
+			continue;
+		}
+		if (!entry.key.Covers(key)) {
+			continue;
+		}
+		if (!best_entry.IsValid() || entry.size < entries[best_entry.GetIndex()].size) {
+			best_entry = i;
+		}
+	}
+	if (!best_entry.IsValid()) {
+		if (removed_entries) {
+			SaveIndex();
+		}
+		return nullptr;
+	}
+	auto &entry = entries[best_entry.GetIndex()];
+	auto file = arrow::io::MemoryMappedFile::Open(GetPath(entry.file_name), arrow::io::FileMode::READ);
+	if (!file.ok()) {
+		// the file has been removed from under us
+		RemoveEntry(best_entry.GetIndex());
+		SaveIndex();
+		return nullptr;
+	}
+	auto reader = arrow::ipc::RecordBatchFileReader::Open(file.ValueOrDie());
+	if (!reader.ok()) {
+		RemoveEntry(best_entry.GetIndex());
+		SaveIndex();
+		return nullptr;
+	}
+	entry.last_access = CurrentTimeMs();
+	SaveIndex();
+	return make_uniq<BigQueryCachedBatchReader>(file.ValueOrDie(), reader.ValueOrDie());
+}
+
+vector<BigQueryScanCacheEntry> BigQueryScanCache::GetEntries() {
+	lock_guard<mutex> guard(lock);
+	return entries;
+}
+
+idx_t BigQueryScanCache::Purge() {
+	lock_guard<mutex> guard(lock);
+	// the entries that other processes added since the index was loaded are purged as well
+	auto index_lock = BigQueryUtils::LockFile(*fs, GetPath(SCAN_CACHE_INDEX_FILE));
+	MergeIndex();
+	auto entry_count = entries.size();
+	while (!entries.empty()) {
+		RemoveEntry(entries.size() - 1);
+	}
+	WriteIndex();
+	return entry_count;
+}
+
+void BigQueryScanCache::Register(BigQueryScanCacheEntry entry) {
+	lock_guard<mutex> guard(lock);
+	entry.last_access = CurrentTimeMs();
+	entries.push_back(std::move(entry));
+	SaveIndex();
+}
+
+void BigQueryScanCache::RemoveEntry(idx_t entry_idx) {
+	// open memory maps of the file stay valid after it has been removed
+	auto path = GetPath(entries[entry_idx].file_name);
+	if (fs->FileExists(path)) {
+		fs->RemoveFile(path);
+	}
+	// the index on disk still lists the entry until it is written next, merging it must not bring the entry back
+	removed_files.insert(entries[entry_idx].file_name);
+	entries.erase_at(entry_idx);
+}
+
+void BigQueryScanCache::EvictEntries() {
+	idx_t total_size = 0;
+	for (auto &entry : entries) {
+		total_size += entry.size;
+	}
+	while (total_size > max_bytes && !entries.empty()) {
+		idx_t lru_entry = 0;
+		for (idx_t i = 1; i < entries.size(); i++) {
+			if (entries[i].last_access < entries[lru_entry].last_access) {
+				lru_entry = i;
+			}
+		}
+		total_size -= entries[lru_entry].size;
+		RemoveEntry(lru_entry);
+	}
+}
+
+void BigQueryScanCache::LoadIndex() {
+	entries = ReadIndex();
+}
+
+vector<BigQueryScanCacheEntry> BigQueryScanCache::ReadIndex() {
+	vector<BigQueryScanCacheEntry> result;
+	auto index_path = GetPath(SCAN_CACHE_INDEX_FILE);
+	if (!fs->FileExists(index_path)) {
+		return result;
+	}
+	std::ifstream index_file(index_path);
+	auto index = json::parse(index_file, nullptr, false);
+	if (index.is_discarded() || !index.is_array()) {
+		// a corrupt index is treated as an empty cache
+		return result;
+	}
+	for (auto &json_entry : index) {
+		BigQueryScanCacheEntry entry;
+		entry.key.table = json_entry.value("table", "");
+		entry.key.version = json_entry.value("version", "");
+		auto fields = json_entry.value("fields", std::vector<std::string>());
+		entry.key.fields = vector<string>(fields.begin(), fields.end());
+		entry.key.row_restriction = json_entry.value("row_restriction", "");
+		entry.file_name = json_entry.value("file", "");
+		entry.size = json_entry.value("size", idx_t(0));
+		entry.last_access = json_entry.value("last_access", int64_t(0));
+		if (entry.file_name.empty() || !fs->FileExists(GetPath(entry.file_name))) {
+			continue;
+		}
+		result.push_back(std::move(entry));
+	}
+	return result;
+}
+
+void BigQueryScanCache::MergeIndex() {
+	// other processes sharing the directory add entries, and remove the files of the entries they evict
+	auto index_entries = ReadIndex();
+	for (idx_t i = 0; i < entries.size(); i++) {
+		if (!fs->FileExists(GetPath(entries[i].file_name))) {
+			entries.erase_at(i);
+			i--;
+		}
+	}
+	for (auto &index_entry : index_entries) {
+		if (removed_files.count(index_entry.file_name) || !fs->FileExists(GetPath(index_entry.file_name))) {
+			continue;
+		}
+		auto it = std::find_if(entries.begin(), entries.end(), [&](const BigQueryScanCacheEntry &entry) {
+			return entry.file_name == index_entry.file_name;
+		});
+		if (it == entries.end()) {
+			entries.push_back(std::move(index_entry));
+		} else {
+			it->last_access = MaxValue(it->last_access, index_entry.last_access);
+		}
+	}
+}
+
+void BigQueryScanCache::SaveIndex() {
+	auto index_lock = BigQueryUtils::LockFile(*fs, GetPath(SCAN_CACHE_INDEX_FILE));
+	MergeIndex();
+	EvictEntries();
+	WriteIndex();
+}
+
+void BigQueryScanCache::WriteIndex() {
+	auto index = json::array();
+	for (auto &entry : entries) {
+		json json_entry;
+		json_entry["table"] = entry.key.table;
+		json_entry["version"] = entry.key.version;
+		json_entry["fields"] = std::vector<std::string>(entry.key.fields.begin(), entry.key.fields.end());
+		json_entry["row_restriction"] = entry.key.row_restriction;
+		json_entry["file"] = entry.file_name;
+		json_entry["size"] = entry.size;
+		json_entry["last_access"] = entry.last_access;
+		index.push_back(std::move(json_entry));
+	}
+	auto index_path = GetPath(SCAN_CACHE_INDEX_FILE);
+	// the temporary file is written under the index lock, its name does not have to be unique
+	auto temp_path = index_path + ".tmp";
+	{
+		std::ofstream index_file(temp_path, std::ios::trunc);
+		index_file << index.dump();
+	}
+	std::rename(temp_path.c_str(), index_path.c_str());
+}
+
+} // namespace duckdb
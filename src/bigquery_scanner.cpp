@@ -8,9 +8,23 @@
 #include "storage/bigquery_catalog.hpp"
 #include "storage/bigquery_transaction.hpp"
 #include "storage/bigquery_table_set.hpp"
+#include "storage/bigquery_table_entry.hpp"
 #include "bigquery_filter_pushdown.hpp"
+#include "bigquery_geography.hpp"
+#include "bigquery_scan_cache.hpp"
+#include "storage/bigquery_shared_scan.hpp"
+#include "bigquery_storage.hpp"
 #include "duckdb/main/database_manager.hpp"
 #include "duckdb/main/attached_database.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/parser/expression/constant_expression.hpp"
+#include "duckdb/parser/expression/function_expression.hpp"
+#include "duckdb/parser/tableref/table_function_ref.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_reference_expression.hpp"
+#include "duckdb/planner/expression_iterator.hpp"
 #include <string>
 #include <string_view>
 #include <algorithm>
@@ -24,6 +38,28 @@ namespace bigquery_storage_read = ::google::cloud::bigquery::storage::v1;
 
 namespace duckdb {
 
+BigQueryScanBindData::BigQueryScanBindData(BigQueryTableEntry &table)
+    : table(&table), dataset(table.schema.name), table_name(table.name) {
+	auto &bigquery_catalog = table.catalog.Cast<BigQueryCatalog>();
+	execution_project = bigquery_catalog.execution_project;
+	storage_project = bigquery_catalog.storage_project;
+	service_account_json = bigquery_catalog.service_account_json;
+	table.pin_count++;
+}
+
+BigQueryScanBindData::BigQueryScanBindData(string execution_project_p, string storage_project_p, string dataset_p,
+                                           string table_name_p, string service_account_json_p)
+    : execution_project(std::move(execution_project_p)), storage_project(std::move(storage_project_p)),
+      dataset(std::move(dataset_p)), table_name(std::move(table_name_p)),
+      service_account_json(std::move(service_account_json_p)) {
+}
+
+BigQueryScanBindData::~BigQueryScanBindData() {
+	if (table) {
+		table->pin_count--;
+	}
+}
+
 struct BigQueryScannerLocalState : public LocalTableFunctionState {};
 
 struct BigQueryScannerGlobalState : public GlobalTableFunctionState {
@@ -61,15 +97,421 @@ struct BigQueryScannerGlobalState : public GlobalTableFunctionState {
 
 	idx_t current_offset;
 	idx_t global_row_count;
+	//! The column id of every output column (filter-only columns are pruned)
+	vector<column_t> projected_column_ids;
+	//! Set once the scan has produced all of its rows
+	bool finished = false;
+
+	//! Source of the record batches, a read stream or a cached scan result
+	unique_ptr<BigQueryBatchReader> reader;
+	//! Fills the scan cache while reading from BigQuery, if enabled
+	unique_ptr<BigQueryScanCacheWriter> cache_writer;
+	//! The scan cache that the writer is created for once the first batch, and with it the schema, has arrived
+	shared_ptr<BigQueryScanCache> scan_cache;
+	BigQueryScanCacheKey cache_key;
+	//! The batch that is currently being emitted, and the number of its rows that have been emitted
+	std::shared_ptr<arrow::RecordBatch> current_batch;
+	idx_t batch_offset = 0;
+	//! The index of every output column in the record batches (-1 for the row id), resolved with the first batch
+	vector<int> arrow_column_indexes;
+
+	//! Set when the scan is served from the in-memory table cache
+	shared_ptr<BigQueryTableCacheEntry> cached_table;
+	ColumnDataScanState cached_table_scan;
+	//! The entry that is filled for the in-memory table cache while reading
+	shared_ptr<BigQueryTableCacheEntry> table_cache_fill;
+	int64_t table_cache_ttl = 0;
+	idx_t table_cache_max_bytes = 0;
 
 	idx_t MaxThreads() const override {
 		return 1;
 	}
 };
 
+static void SetSnapshotTime(bigquery_storage_read::ReadSession &read_session, timestamp_t snapshot_time) {
+	auto snapshot = read_session.mutable_table_modifiers()->mutable_snapshot_time();
+	snapshot->set_seconds(snapshot_time.value / Interval::MICROS_PER_SEC);
+	snapshot->set_nanos(static_cast<int32_t>(snapshot_time.value % Interval::MICROS_PER_SEC) * 1000);
+}
+
+//! The snapshot that bigquery_scan reads without a catalog transaction: bigquery_snapshot_time if it is set, and
+//! otherwise the current time
+static timestamp_t GetScanSnapshotTime(ClientContext &context) {
+	Value snapshot_setting;
+	if (context.TryGetCurrentSetting("bigquery_snapshot_time", snapshot_setting) && !snapshot_setting.IsNull()) {
+		return snapshot_setting.GetValue<timestamp_t>();
+	}
+	return Timestamp::GetCurrentTimestamp();
+}
+
+//! Binds bigquery_scan(project, dataset, table) without a catalog: the read session over all columns is created
+//! right away, its Arrow schema gives the columns, so the table is not looked up separately
 static unique_ptr<FunctionData> BigQueryBind(ClientContext &context, TableFunctionBindInput &input,
                                           vector<LogicalType> &return_types, vector<string> &names) {
-	throw InternalException("Unimplemented BigQueryBind for BigQueryScanFunction");
+	for (auto &parameter : input.inputs) {
+		if (parameter.IsNull()) {
+			throw BinderException("Parameters to bigquery_scan cannot be NULL");
+		}
+	}
+	auto storage_project = input.inputs[0].GetValue<string>();
+	auto dataset = input.inputs[1].GetValue<string>();
+	auto table = input.inputs[2].GetValue<string>();
+	// as with ATTACH, the jobs run in the project of the table unless another one is given
+	auto execution_project = storage_project;
+	string secret_name;
+	for (auto &kv : input.named_parameters) {
+		auto loption = StringUtil::Lower(kv.first);
+		if (loption == "execution_project") {
+			execution_project = kv.second.ToString();
+		} else if (loption == "secret") {
+			secret_name = kv.second.ToString();
+		}
+	}
+	auto bind_data = make_uniq<BigQueryScanBindData>(execution_project, storage_project, dataset, table,
+	                                                 GetServiceAccountJSON(context, secret_name));
+
+	// all scans of the table in the statement read the same snapshot
+	bind_data->snapshot_time = GetScanSnapshotTime(context);
+	bind_data->bind_query = context.transaction.GetActiveQuery();
+	bigquery_storage_read::ReadSession read_session;
+	read_session.set_data_format(google::cloud::bigquery::storage::v1::DataFormat::ARROW);
+	read_session.set_table("projects/" + storage_project + "/datasets/" + dataset + "/tables/" + table);
+	SetSnapshotTime(read_session, bind_data->snapshot_time);
+	auto client = bigquery_storage::BigQueryReadClient(
+	    BigQueryUtils::CreateReadConnection(bind_data->service_account_json));
+	auto session = client.CreateReadSession("projects/" + execution_project, read_session, 1);
+	if (!session) {
+		throw BinderException("Failed to read BigQuery table \"%s.%s.%s\": %s", storage_project, dataset, table,
+		                      session.status().message());
+	}
+	if (session->arrow_schema().serialized_schema().empty()) {
+		// BigQuery returns no schema (and no streams) for an empty table, its columns are read with tables.get
+		auto table_metadata = BigQueryUtils::BigQueryReadTableMetadata(execution_project, storage_project, dataset,
+		                                                               table, bind_data->service_account_json);
+		for (auto &column : table_metadata.columns) {
+			names.push_back(column.name);
+			return_types.push_back(column.type);
+		}
+	} else {
+		auto schema = BigQueryUtils::GetArrowSchema(session->arrow_schema());
+		for (auto &field : schema->fields()) {
+			names.push_back(field->name());
+			return_types.push_back(BigQueryUtils::ArrowFieldToLogicalType(*field));
+		}
+	}
+	if (names.empty()) {
+		throw BinderException("Failed to read BigQuery table \"%s.%s.%s\": the table has no columns", storage_project,
+		                      dataset, table);
+	}
+	bind_data->column_names = names;
+	bind_data->column_types = return_types;
+	bind_data->estimated_rows = static_cast<idx_t>(session->estimated_row_count());
+	bind_data->estimated_bytes = static_cast<idx_t>(session->estimated_total_bytes_scanned());
+	bind_data->bind_session = make_shared_ptr<const bigquery_storage_read::ReadSession>(*std::move(session));
+	return std::move(bind_data);
+}
+
+static bool IsSuffixColumn(const BigQueryScanBindData &bind_data, column_t column_id) {
+	return bind_data.suffix_column.IsValid() && column_id == bind_data.suffix_column.GetIndex();
+}
+
+bool BigQueryScanFunction::SuffixMatchesFilter(const TableFilter &filter, const Value &suffix) {
+	switch (filter.filter_type) {
+	case TableFilterType::CONSTANT_COMPARISON: {
+		auto &constant_filter = filter.Cast<ConstantFilter>();
+		auto &constant = constant_filter.constant;
+		switch (constant_filter.comparison_type) {
+		case ExpressionType::COMPARE_EQUAL:
+			return suffix == constant;
+		case ExpressionType::COMPARE_NOTEQUAL:
+			return suffix != constant;
+		case ExpressionType::COMPARE_LESSTHAN:
+			return suffix < constant;
+		case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+			return suffix <= constant;
+		case ExpressionType::COMPARE_GREATERTHAN:
+			return suffix > constant;
+		case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+			return suffix >= constant;
+		default:
+			return true;
+		}
+	}
+	case TableFilterType::IS_NULL:
+		return false;
+	case TableFilterType::IS_NOT_NULL:
+		return true;
+	case TableFilterType::CONJUNCTION_AND: {
+		for (auto &child_filter : filter.Cast<ConjunctionAndFilter>().child_filters) {
+			if (!SuffixMatchesFilter(*child_filter, suffix)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	case TableFilterType::CONJUNCTION_OR: {
+		for (auto &child_filter : filter.Cast<ConjunctionOrFilter>().child_filters) {
+			if (SuffixMatchesFilter(*child_filter, suffix)) {
+				return true;
+			}
+		}
+		return false;
+	}
+	default:
+		return true;
+	}
+}
+
+//! Returns the shards of a wildcard table that pass the table filters on _TABLE_SUFFIX
+static vector<string> GetScannedShards(const BigQueryScanBindData &bind_data, TableFunctionInitInput &input) {
+	vector<string> result;
+	for (auto &suffix : bind_data.shard_suffixes) {
+		bool matches = true;
+		if (input.filters) {
+			for (auto &entry : input.filters->filters) {
+				if (IsSuffixColumn(bind_data, input.column_ids[entry.first]) &&
+				    !BigQueryScanFunction::SuffixMatchesFilter(*entry.second, Value(suffix))) {
+					matches = false;
+					break;
+				}
+			}
+		}
+		if (matches) {
+			result.push_back(suffix);
+		}
+	}
+	return result;
+}
+
+static string GetNarrowestColumn(const BigQueryScanBindData &bind_data) {
+	for (idx_t i = 0; i < bind_data.column_types.size(); i++) {
+		if (TypeIsConstantSize(bind_data.column_types[i].InternalType())) {
+			return bind_data.column_names[i];
+		}
+	}
+	return bind_data.column_names[0];
+}
+
+//! Rows at least this wide on average make a second, key-restricted read pay off
+static constexpr idx_t LATE_MATERIALIZATION_MIN_ROW_WIDTH = 1024;
+
+static bool UseLateMaterialization(ClientContext &context, const BigQueryScanBindData &bind_data,
+                                   const vector<column_t> &projected_column_ids, const string &filters) {
+	Value setting;
+	if (!context.TryGetCurrentSetting("bigquery_late_materialization", setting) || !BooleanValue::Get(setting)) {
+		return false;
+	}
+	if (filters.empty() || bind_data.has_limit || bind_data.key_columns.empty() || bind_data.estimated_rows == 0) {
+		return false;
+	}
+	if (bind_data.estimated_bytes / bind_data.estimated_rows < LATE_MATERIALIZATION_MIN_ROW_WIDTH) {
+		return false;
+	}
+	for (auto &key_column : bind_data.key_columns) {
+		auto it = std::find(bind_data.column_names.begin(), bind_data.column_names.end(), key_column);
+		if (it == bind_data.column_names.end()) {
+			return false;
+		}
+		auto &key_type = bind_data.column_types[it - bind_data.column_names.begin()];
+		if (key_type.IsNested() || key_type.id() == LogicalTypeId::BLOB) {
+			return false;
+		}
+	}
+	// only worth it if there is a wide column to skip in the first phase
+	for (auto &column_id : projected_column_ids) {
+		if (IsRowIdColumnId(column_id)) {
+			continue;
+		}
+		auto &column_name = bind_data.column_names[column_id];
+		auto is_key = std::find(bind_data.key_columns.begin(), bind_data.key_columns.end(), column_name) !=
+		              bind_data.key_columns.end();
+		if (!is_key && !TypeIsConstantSize(bind_data.column_types[column_id].InternalType())) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//! The Storage Read API rejects row restrictions longer than 1 MB
+static constexpr idx_t MAX_ROW_RESTRICTION_BYTES = 1000000;
+
+//! The primary key of the table, which phase one of late materialization reads
+struct BigQueryKeyColumns {
+	vector<string> names;
+	vector<LogicalType> types;
+};
+
+//! Phase one of late materialization: reads only the key columns of the rows matching the filters, and
+//! renders a row restriction selecting those keys (empty if nothing matches). Returns false if there are more than
+//! max_keys matches, or if the restriction would exceed the size limit of the Storage Read API.
+static bool BigQueryCollectKeyRestriction(bigquery_storage::BigQueryReadClient &client, const string &project_name,
+                                          const bigquery_storage_read::ReadSession &read_session,
+                                          const BigQueryKeyColumns &key_columns, const string &filters,
+                                          idx_t max_keys, const std::atomic<bool> &cancelled,
+                                          string &key_restriction) {
+	// the keys are read from the same table snapshot as the remaining columns
+	bigquery_storage_read::ReadSession key_session;
+	key_session.set_data_format(google::cloud::bigquery::storage::v1::DataFormat::ARROW);
+	key_session.set_table(read_session.table());
+	*key_session.mutable_table_modifiers() = read_session.table_modifiers();
+	auto &key_types = key_columns.types;
+	for (auto &key_column : key_columns.names) {
+		key_session.mutable_read_options()->add_selected_fields(key_column);
+	}
+	key_session.mutable_read_options()->set_row_restriction(filters);
+	// the key predicates are combined with the filters, the budget leaves room for the parentheses and operators
+	auto max_bytes = MAX_ROW_RESTRICTION_BYTES > filters.size() + 16 ? MAX_ROW_RESTRICTION_BYTES - filters.size() - 16
+	                                                                  : 0;
+	vector<string> key_identifiers;
+	for (auto &key_column : key_columns.names) {
+		key_identifiers.push_back(BigQueryUtils::WriteIdentifier(key_column));
+	}
+	// the size of the restriction so far: "key IN (...)", or "(... OR ...)" for composite keys
+	idx_t restriction_bytes = key_identifiers.size() == 1 ? key_identifiers[0].size() + 6 : 2;
+
+	auto session = client.CreateReadSession(project_name, key_session, 1);
+	if (!session) {
+		throw std::move(session).status();
+	}
+	if (session->streams_size() == 0) {
+		// nothing matches
+		return true;
+	}
+	auto schema = BigQueryUtils::GetArrowSchema(session->arrow_schema());
+	vector<int> key_indexes;
+	for (auto &key_column : key_columns.names) {
+		key_indexes.push_back(schema->GetFieldIndex(key_column));
+	}
+
+	// the literals of every matching key, one entry per key column
+	vector<vector<string>> keys;
+	for (auto const &read_rows_response : client.ReadRows(session->streams(0).name(), 0)) {
+		if (!read_rows_response.ok()) {
+			throw read_rows_response.status();
+		}
+		if (cancelled) {
+			throw InterruptException();
+		}
+		auto record_batch = BigQueryResult::GetArrowRecordBatch(read_rows_response->arrow_record_batch(), schema);
+		if (keys.size() + record_batch->num_rows() > max_keys) {
+			return false;
+		}
+		for (int64_t r = 0; r < record_batch->num_rows(); r++) {
+			vector<string> key_literals;
+			for (idx_t k = 0; k < key_indexes.size(); k++) {
+				auto scalar = record_batch->column(key_indexes[k])->GetScalar(r);
+				if (!scalar.ok()) {
+					throw scalar.status();
+				}
+				auto key = BigQueryUtils::ValueFromArrowScalar(scalar.ValueOrDie(), key_types[k]);
+				if (key.IsNull()) {
+					// NULL keys cannot be selected with a key predicate
+					return false;
+				}
+				key_literals.push_back(BigQueryFilterPushdown::TransformConstant(key));
+				// an upper bound of the rendered key: the literal and the separators, and for composite keys the
+				// column name, the comparison and the conjunctions
+				restriction_bytes += key_literals.back().size() + 2;
+				if (key_identifiers.size() > 1) {
+					restriction_bytes += key_identifiers[k].size() + 12;
+				}
+			}
+			if (restriction_bytes > max_bytes) {
+				return false;
+			}
+			keys.push_back(std::move(key_literals));
+		}
+	}
+	if (keys.empty()) {
+		return true;
+	}
+	if (key_identifiers.size() == 1) {
+		vector<string> literals;
+		for (auto &key : keys) {
+			literals.push_back(std::move(key[0]));
+		}
+		key_restriction = key_identifiers[0] + " IN (" + StringUtil::Join(literals, ", ") + ")";
+		return true;
+	}
+	// composite keys: (a = 1 AND b = 2) OR (a = 1 AND b = 3) ...
+	vector<string> key_predicates;
+	for (auto &key : keys) {
+		vector<string> column_predicates;
+		for (idx_t k = 0; k < key.size(); k++) {
+			column_predicates.push_back(key_identifiers[k] + " = " + key[k]);
+		}
+		key_predicates.push_back("(" + StringUtil::Join(column_predicates, " AND ") + ")");
+	}
+	key_restriction = "(" + StringUtil::Join(key_predicates, " OR ") + ")";
+	return true;
+}
+
+//! The selected fields come back in table order, looks up every output column by name
+static void SetArrowColumnIndexes(const BigQueryScanBindData &bind_data, BigQueryScannerGlobalState &gstate) {
+	auto schema = gstate.reader->GetSchema();
+	for (auto &column_id : gstate.projected_column_ids) {
+		if (IsRowIdColumnId(column_id)) {
+			gstate.arrow_column_indexes.push_back(-1);
+			continue;
+		}
+		auto arrow_column_index = schema->GetFieldIndex(bind_data.column_names[column_id]);
+		if (arrow_column_index < 0) {
+			throw InternalException("Column \"%s\" missing from the BigQuery read session",
+			                        bind_data.column_names[column_id]);
+		}
+		gstate.arrow_column_indexes.push_back(arrow_column_index);
+	}
+}
+
+//! Builds the query that reads a view with the projection, filters and limit of the scan pushed into it
+static string GetViewQuery(const BigQueryScanBindData &bind_data, const string &storage_project,
+                           const vector<column_t> &projected_column_ids, const string &filters) {
+	vector<string> select_list;
+	for (auto &column_id : projected_column_ids) {
+		if (IsRowIdColumnId(column_id)) {
+			continue;
+		}
+		select_list.push_back(BigQueryUtils::WriteIdentifier(bind_data.column_names[column_id]));
+	}
+	if (select_list.empty()) {
+		select_list.push_back(BigQueryUtils::WriteIdentifier(GetNarrowestColumn(bind_data)));
+	}
+	auto query = "SELECT " + StringUtil::Join(select_list, ", ") + " FROM " +
+	             BigQueryUtils::WriteIdentifier(storage_project + "." + bind_data.dataset + "." + bind_data.table_name);
+	if (!filters.empty()) {
+		query += " WHERE " + filters;
+	}
+	if (bind_data.has_limit) {
+		query += " LIMIT " + to_string(bind_data.limit);
+	}
+	if (bind_data.offset > 0) {
+		if (!bind_data.has_limit) {
+			// BigQuery only accepts OFFSET after a LIMIT
+			query += " LIMIT " + to_string(NumericLimits<int64_t>::Maximum());
+		}
+		query += " OFFSET " + to_string(bind_data.offset);
+	}
+	return query;
+}
+
+//! Returns the version (lastModifiedTime) of the table data at the snapshot, or an empty string if it is not known.
+//! The version of the catalog entry can be up to bigquery_metadata_ttl old, it is read again unless the entry was
+//! validated after the snapshot was taken. A version that is current after the snapshot is the version of the
+//! snapshot unless it was written after the snapshot.
+static string GetSnapshotVersion(const BigQueryScanBindData &bind_data, const BigQueryTableEntry &table_entry,
+                                 timestamp_t snapshot_time) {
+	auto snapshot_ms = Timestamp::GetEpochMs(snapshot_time);
+	auto version = table_entry.last_modified_time;
+	if (table_entry.validated_at < snapshot_ms) {
+		version = BigQueryUtils::BigQueryReadTableVersion(bind_data.storage_project, bind_data.dataset,
+		                                                  bind_data.table_name, bind_data.service_account_json)
+		              .last_modified_time;
+	}
+	if (version.empty() || std::stoll(version) > snapshot_ms) {
+		// e.g. another connection wrote to the table after this transaction started
+		return string();
+	}
+	return version;
 }
 
 static unique_ptr<GlobalTableFunctionState> BigQueryInitGlobalState(ClientContext &context,
@@ -77,18 +519,24 @@ static unique_ptr<GlobalTableFunctionState> BigQueryInitGlobalState(ClientContex
 	// Prepare the BigQuery Client
 	//Printer::Print("BigQueryInitGlobalState");
 	auto &bind_data = input.bind_data->Cast<BigQueryScanBindData>();
-	auto &entry = bind_data.table;
-	auto &bigquery_catalog = entry.catalog.Cast<BigQueryCatalog>();
+	// scans of attached tables go through the caches of their catalog, bigquery_scan has neither
+	auto entry = bind_data.table;
+	optional_ptr<BigQueryCatalog> bigquery_catalog;
+	optional_ptr<BigQueryTransaction> transaction;
+	if (entry) {
+		bigquery_catalog = &entry->catalog.Cast<BigQueryCatalog>();
+		transaction = &BigQueryTransaction::Get(context, *bigquery_catalog);
+	}
 
-	auto execution_project = bigquery_catalog.execution_project;
-	auto storage_project = bigquery_catalog.storage_project;
-	auto dataset = entry.schema.name;
-	auto table = entry.name;
+	auto execution_project = bind_data.execution_project;
+	auto storage_project = bind_data.storage_project;
+	auto dataset = bind_data.dataset;
+	auto table = bind_data.table_name;
 	auto column_names = bind_data.column_names;
 	auto limit = bind_data.limit;
 	auto offset = bind_data.offset;
 	auto has_limit = bind_data.has_limit;
-	auto service_account_json = bigquery_catalog.service_account_json;
+	auto service_account_json = bind_data.service_account_json;
 
 	//Printer::Print("BigQueryReadTable: " + execution_project + " " + storage_project + "." + dataset + "." + table);
 	//Printer::Print("limit: " + to_string(limit) + " offset: " + to_string(offset) + " has_limit: " + to_string(has_limit));
@@ -100,35 +548,90 @@ static unique_ptr<GlobalTableFunctionState> BigQueryInitGlobalState(ClientContex
 
 	//constexpr int max_streams = 1;
 
-	std::shared_ptr<google::cloud::bigquery_storage_v1::BigQueryReadConnection> connection;
-	if(service_account_json.empty()){
-		connection = bigquery_storage::MakeBigQueryReadConnection();
-	}
-	else {
-		//Printer::Print("GetAccessToken service_account_json: " + service_account_json);
-		auto options = google::cloud::Options{}
-	.set<google::cloud::UnifiedCredentialsOption>(
-		google::cloud::MakeServiceAccountCredentials(service_account_json));
-		connection = bigquery_storage::MakeBigQueryReadConnection(options);
-	}
+	auto connection = BigQueryUtils::CreateReadConnection(service_account_json);
 
 	// Create the ReadSession.
 	auto read_session = make_uniq<bigquery_storage_read::ReadSession>();
 	read_session->set_data_format(google::cloud::bigquery::storage::v1::DataFormat::ARROW);
 	read_session->set_table(table_name);
-	for(auto &column_id : input.column_ids){
+	// the read session and the snapshot of bigquery_scan's bind are only used by the query that bound it. Prepared
+	// statements read the data as of their execution, and the bind session may have expired by then.
+	bool bind_is_current = bind_data.bind_session && bind_data.bind_query == context.transaction.GetActiveQuery();
+	// every scan of a transaction reads the same snapshot, so that self-joins and repeated reads are consistent
+	timestamp_t snapshot_time;
+	if (transaction) {
+		snapshot_time = transaction->GetSnapshotTime(context);
+	} else {
+		snapshot_time = bind_is_current ? bind_data.snapshot_time : GetScanSnapshotTime(context);
+	}
+	SetSnapshotTime(*read_session, snapshot_time);
+	// with filter_prune, columns that are only referenced by (fully pushed) filters are not part of the output
+	// and do not need to be downloaded at all
+	vector<column_t> projected_column_ids;
+	if (input.projection_ids.empty()) {
+		projected_column_ids = input.column_ids;
+	} else {
+		for (auto &projection_id : input.projection_ids) {
+			projected_column_ids.push_back(input.column_ids[projection_id]);
+		}
+	}
+	idx_t selected_field_count = 0;
+	for(auto &column_id : projected_column_ids){
+			if (IsRowIdColumnId(column_id) || IsSuffixColumn(bind_data, column_id)) {
+				// the row id and the _TABLE_SUFFIX of wildcard tables are filled in locally
+				continue;
+			}
+			selected_field_count++;
 			auto column_name = bind_data.column_names[column_id];
+			auto subfields = bind_data.selected_subfields.find(column_id);
+			if (subfields != bind_data.selected_subfields.end()) {
+				// only download the parts of the record that are used, the rest of the struct is filled with NULLs
+				for (auto &subfield : subfields->second) {
+					read_session->mutable_read_options()->add_selected_fields(column_name + "." + subfield);
+				}
+				continue;
+			}
 			//Printer::Print("Adding column: " + column_name);
 			read_session->mutable_read_options()->add_selected_fields(column_name);
 	}
-	auto filters = BigQueryFilterPushdown::TransformFilters(input.column_ids, input.filters, bind_data.column_names);
+	if (selected_field_count == 0) {
+		// BigQuery returns every column when no field is selected, only the row count matters here
+		read_session->mutable_read_options()->add_selected_fields(GetNarrowestColumn(bind_data));
+	}
+	auto filters = BigQueryFilterPushdown::TransformFilters(input.column_ids, input.filters, bind_data.column_names,
+	                                                        bind_data.suffix_column);
+	for (auto &nested_filter : bind_data.nested_filters) {
+		if (!filters.empty()) {
+			filters += " AND ";
+		}
+		filters += nested_filter;
+	}
 	//Printer::Print("filters: " + filters);
+	auto client = bigquery_storage::BigQueryReadClient(connection);
+	bool is_view = entry && entry->IsView();
+	// phase one of late materialization runs in the background together with the session of the scan, the shards of
+	// wildcard tables are read without it
+	bool late_materialization = !is_view && !bind_data.suffix_column.IsValid() &&
+	                            UseLateMaterialization(context, bind_data, projected_column_ids, filters);
+	idx_t max_keys = 10000;
+	BigQueryKeyColumns key_columns;
+	if (late_materialization) {
+		Value max_keys_setting;
+		if (context.TryGetCurrentSetting("bigquery_late_materialization_max_keys", max_keys_setting)) {
+			max_keys = UBigIntValue::Get(max_keys_setting);
+		}
+		for (auto &key_column : bind_data.key_columns) {
+			auto it = std::find(bind_data.column_names.begin(), bind_data.column_names.end(), key_column);
+			key_columns.names.push_back(key_column);
+			key_columns.types.push_back(bind_data.column_types[it - bind_data.column_names.begin()]);
+		}
+	}
 	if(!filters.empty()){
 		read_session->mutable_read_options()->set_row_restriction(filters);
 	}
 	//Printer::Print("column_names size: " + to_string(column_names.size()));
 
-	return make_uniq<BigQueryScannerGlobalState>(
+	auto result = make_uniq<BigQueryScannerGlobalState>(
 			execution_project,
 			storage_project,
 			dataset,
@@ -139,108 +642,465 @@ static unique_ptr<GlobalTableFunctionState> BigQueryInitGlobalState(ClientContex
 			offset,
 			has_limit
 	);
-}
+	result->projected_column_ids = std::move(projected_column_ids);
 
-static unique_ptr<LocalTableFunctionState> BigQueryInitLocalState(ExecutionContext &context, TableFunctionInitInput &input,
-                                                               GlobalTableFunctionState *global_state) {
-	//Printer::Print("BigQueryInitLocalState");
-	return make_uniq<BigQueryScannerLocalState>();
-}
-
-static void BigQueryScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
-	//Printer::Print("BigQueryScan");
-	auto &gstate = data.global_state->Cast<BigQueryScannerGlobalState>();
-	auto connection = gstate.connection;
-	auto execution_project = gstate.execution_project;
-	auto storage_project = gstate.storage_project;
-	auto dataset = gstate.dataset;
-	auto table = gstate.table;
-	auto &read_session = gstate.read_session;
-
-	//Printer::Print("gstate.has_limit: " + to_string(gstate.has_limit));
-
-	//Printer::Print("BigQueryScan: got rows response");
-	std::string const project_name = "projects/" + execution_project;
-	auto client = bigquery_storage::BigQueryReadClient(connection);
-	auto session =
-      client.CreateReadSession(project_name, *read_session, 1);
-
-	if (!session) {
-		//Printer::Print("Error creating ReadSession: " + session.status().message());
-		throw std::move(session).status();
+	if (is_view) {
+		// the Storage Read API only reads tables, views run as a query job whose result table is read with one
+		// stream per thread. The results are reused while they are younger than bigquery_view_cache_ttl.
+		if (transaction->IsTimeTravel()) {
+			throw NotImplementedException("Time travel is not supported for the BigQuery view \"%s\"", table);
+		}
+		auto view_query = GetViewQuery(bind_data, storage_project, result->projected_column_ids, filters);
+		auto &view_cache = bigquery_catalog->GetViewCache();
+		auto view_cache_ttl = BigQueryViewCache::GetTTL(context);
+		auto parallelism = static_cast<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads());
+		// the limit and offset are applied by the query
+		result->current_offset = 0;
+		// the job runs while the other scans of the query are initialized
+		result->reader = make_uniq<BigQueryAsyncBatchReader>(
+		    [client, &view_cache, view_query, view_cache_ttl, execution_project, service_account_json,
+		     parallelism](const std::atomic<bool> &cancelled) mutable -> unique_ptr<BigQueryBatchReader> {
+			string destination_table;
+			if (view_cache_ttl > 0) {
+				destination_table = view_cache.TryGet(view_query, view_cache_ttl);
+			}
+			if (destination_table.empty()) {
+				destination_table =
+				    BigQueryUtils::BigQueryRunQueryJob(execution_project, view_query, service_account_json, &cancelled);
+				if (view_cache_ttl > 0 && !cancelled) {
+					view_cache.Put(view_query, destination_table);
+				}
+			}
+			if (cancelled) {
+				// the scan is gone, and with it possibly the catalog
+				return nullptr;
+			}
+			bigquery_storage_read::ReadSession view_session;
+			view_session.set_data_format(google::cloud::bigquery::storage::v1::DataFormat::ARROW);
+			view_session.set_table(destination_table);
+			auto session = client.CreateReadSession("projects/" + execution_project, view_session,
+			                                        static_cast<std::int32_t>(parallelism));
+			if (!session) {
+				throw std::move(session).status();
+			}
+			if (session->streams_size() == 0) {
+				return nullptr;
+			}
+			return make_uniq<BigQueryMultiStreamBatchReader>(
+			    client, make_shared_ptr<const bigquery_storage_read::ReadSession>(*std::move(session)), parallelism);
+		});
+		return std::move(result);
 	}
 
-	idx_t duckdb_row_idx = 0;
-	//Printer::Print("BigQueryScan: created ReadSession with offset: " + to_string(gstate.current_offset));
-	auto read_rows = client.ReadRows(session->streams(0).name(), gstate.current_offset);
-
-	// Get schema.
-	auto schema = BigQueryUtils::GetArrowSchema(session->arrow_schema());
-	//Printer::Print("Got schema");
+	if (bind_data.suffix_column.IsValid()) {
+		// wildcard tables read the matching shards through parallel sessions, none of the caches apply
+		auto shards = GetScannedShards(bind_data, input);
+		if (shards.empty()) {
+			result->finished = true;
+			return std::move(result);
+		}
+		auto table_prefix = "projects/" + storage_project + "/datasets/" + dataset + "/tables/" +
+		                    entry->shard_prefix;
+		auto parallelism = static_cast<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads());
+		auto session_template = *result->read_session;
+		// the sessions of the shards are opened in the background like those of other scans
+		result->reader = make_uniq<BigQueryAsyncBatchReader>([client, execution_project, session_template,
+		                                                      table_prefix, shards, parallelism](
+		                                                         const std::atomic<bool> &cancelled)
+		                                                         -> unique_ptr<BigQueryBatchReader> {
+			if (cancelled) {
+				return nullptr;
+			}
+			auto reader = make_uniq<BigQueryShardedBatchReader>(client, "projects/" + execution_project,
+			                                                     session_template, table_prefix, shards, parallelism);
+			if (!reader->GetSchema()) {
+				// none of the shards has rows
+				return nullptr;
+			}
+			return std::move(reader);
+		});
+		return std::move(result);
+	}
 
-  	for (auto const& read_rows_response : read_rows) {
-	//Printer::Print("---- read rows response ----");
-    if (read_rows_response.ok()) {
-      auto record_batch =
-          BigQueryResult::GetArrowRecordBatch(
-			read_rows_response->arrow_record_batch(), schema);
+	// scans without a limit are served from, or else stored in, the in-memory table cache and the local scan cache
+	// if they are enabled. Entries are keyed by table version, which does not identify the data of an earlier
+	// snapshot, so time travel reads bypass them. So do entries from the metadata cache file that are not yet
+	// revalidated, whose version may be outdated. bigquery_scan does not know the version of the table.
+	bool versioned =
+	    entry && !entry->last_modified_time.empty() && !entry->revalidate && !transaction->IsTimeTravel();
+	string version;
+	if (versioned) {
+		// the caches are only used with the version of the data this scan reads
+		version = GetSnapshotVersion(bind_data, *entry, snapshot_time);
+		versioned = !version.empty();
+	}
+	bool cacheable = CanCacheResult(bind_data) && versioned;
+	BigQueryScanCacheKey cache_key;
+	if (versioned) {
+		cache_key.table = table_name;
+		cache_key.version = version;
+		auto &selected_fields = result->read_session->read_options().selected_fields();
+		cache_key.fields = vector<string>(selected_fields.begin(), selected_fields.end());
+		std::sort(cache_key.fields.begin(), cache_key.fields.end());
+		cache_key.row_restriction = filters;
+	}
+	auto table_cache_ttl = cacheable ? BigQueryTableCache::GetTTL(context) : 0;
+	if (table_cache_ttl > 0) {
+		auto &table_cache = bigquery_catalog->GetTableCache();
+		result->cached_table = table_cache.TryGet(cache_key, result->projected_column_ids, table_cache_ttl);
+		if (result->cached_table) {
+			vector<column_t> collection_column_ids;
+			auto &cached_column_ids = result->cached_table->column_ids;
+			for (auto &column_id : result->projected_column_ids) {
+				auto it = std::find(cached_column_ids.begin(), cached_column_ids.end(), column_id);
+				collection_column_ids.push_back(it - cached_column_ids.begin());
+			}
+			result->cached_table->collection->InitializeScan(result->cached_table_scan, collection_column_ids);
+			return std::move(result);
+		}
+		vector<LogicalType> types;
+		for (auto &column_id : result->projected_column_ids) {
+			types.push_back(IsRowIdColumnId(column_id) ? LogicalType(LogicalType::ROW_TYPE)
+			                                           : bind_data.column_types[column_id]);
+		}
+		result->table_cache_ttl = table_cache_ttl;
+		result->table_cache_max_bytes = BigQueryTableCache::GetMaxBytes(context);
+		result->table_cache_fill = make_shared_ptr<BigQueryTableCacheEntry>();
+		result->table_cache_fill->key = cache_key;
+		result->table_cache_fill->column_ids = result->projected_column_ids;
+		result->table_cache_fill->collection =
+		    make_shared_ptr<ColumnDataCollection>(BufferManager::GetBufferManager(context), types);
+	}
+	shared_ptr<BigQueryScanCache> scan_cache;
+	if (cacheable) {
+		scan_cache = BigQueryScanCache::TryGet(context);
+	}
+	if (scan_cache) {
+		result->reader = scan_cache->TryOpen(cache_key);
+	}
+	if (!result->reader) {
+		// concurrent scans of the same data share one read session, whose batches are multicast to all of them
+		shared_ptr<BigQuerySharedScan> shared_scan;
+		bool created_shared_scan = false;
+		if (versioned && offset == 0 && BigQuerySharedScans::IsEnabled(context)) {
+			shared_scan = bigquery_catalog->GetSharedScans().GetOrCreate(cache_key, created_shared_scan);
+		}
+		// only one of the scans sharing a session fills the scan cache, its writer is created with the first batch
+		if (scan_cache && (!shared_scan || created_shared_scan)) {
+			result->scan_cache = scan_cache;
+			result->cache_key = cache_key;
+		}
+		// the session is created in the background, so that the scans of a query wait for their sessions together
+		// instead of one after another
+		optional_ptr<BigQueryReadSessionCache> read_session_cache;
+		if (versioned && BigQueryReadSessionCache::IsEnabled(context)) {
+			read_session_cache = &bigquery_catalog->GetReadSessionCache();
+		}
+		// the session that bigquery_scan created at bind time reads all columns, it is used as-is if that is what
+		// the scan reads
+		shared_ptr<const bigquery_storage_read::ReadSession> bind_session;
+		if (bind_is_current && filters.empty() && bind_data.selected_subfields.empty() &&
+		    selected_field_count == bind_data.column_names.size()) {
+			bind_session = bind_data.bind_session;
+		}
+		auto session_template = *result->read_session;
+		result->reader = make_uniq<BigQueryAsyncBatchReader>([client, execution_project, session_template,
+		                                                      read_session_cache, bind_session, cache_key, shared_scan,
+		                                                      created_shared_scan, offset, late_materialization,
+		                                                      key_columns, filters, max_keys, service_account_json](
+		                                                         const std::atomic<bool> &cancelled) mutable
+		                                                     -> unique_ptr<BigQueryBatchReader> {
+			// read sessions stay valid for hours, with bigquery_read_session_cache a session of an earlier scan of the
+			// same table version is reused. Returns nullptr if no rows match.
+			auto get_session = [&]() -> shared_ptr<const bigquery_storage_read::ReadSession> {
+				auto session = bind_session;
+				if (!session && read_session_cache) {
+					session = read_session_cache->TryGet(cache_key, service_account_json);
+				}
+				if (!session && late_materialization) {
+					// phase one reads just the keys of the matching rows, so that the wide columns are only
+					// downloaded for those rows. The filters are kept in the restriction, the keys are not enforced
+					// to be unique. The result is the same as without the keys, the session is cached as such.
+					string key_restriction;
+					if (BigQueryCollectKeyRestriction(client, "projects/" + execution_project, session_template,
+					                                  key_columns, filters, max_keys, cancelled, key_restriction)) {
+						if (key_restriction.empty()) {
+							return nullptr;
+						}
+						session_template.mutable_read_options()->set_row_restriction("(" + filters + ") AND " +
+						                                                             key_restriction);
+					}
+					late_materialization = false;
+				}
+				if (!session) {
+					if (cancelled) {
+						throw InterruptException();
+					}
+					auto new_session = client.CreateReadSession("projects/" + execution_project, session_template, 1);
+					if (!new_session) {
+						throw std::move(new_session).status();
+					}
+					session = make_shared_ptr<const bigquery_storage_read::ReadSession>(*std::move(new_session));
+					if (read_session_cache && !cancelled) {
+						read_session_cache->Put(cache_key, session);
+					}
+				}
+				return session;
+			};
+			if (created_shared_scan) {
+				try {
+					auto session = get_session();
+					if (!session || session->streams_size() == 0) {
+						shared_scan->Fail();
+					} else {
+						shared_scan->Start(client, std::move(session));
+					}
+				} catch (...) {
+					// scans waiting for the session open their own
+					shared_scan->Fail();
+					throw;
+				}
+			}
+			if (shared_scan) {
+				auto shared_reader = BigQuerySharedScan::Attach(shared_scan);
+				if (shared_reader) {
+					return shared_reader;
+				}
+			}
+			auto session = get_session();
+			if (!session || session->streams_size() == 0) {
+				// BigQuery does not create streams if there are no rows to read
+				return nullptr;
+			}
+			return make_uniq<BigQueryStreamBatchReader>(client, *session, 0, offset);
+		});
+	}
 
-	  std::int64_t batch_num_rows = record_batch->num_rows();
-	  std::int64_t limit_rows = gstate.limit - gstate.global_row_count;
-	  //Printer::Print("limit_rows: " + to_string(limit_rows));
-	  //Printer::Print("batch_num_rows: " + to_string(batch_num_rows));
-	  //Printer::Print("current duckdb_row_idx: " + to_string(duckdb_row_idx));
+	return std::move(result);
+}
 
-	  auto first_min =  gstate.has_limit ? std::min(batch_num_rows, limit_rows) : batch_num_rows;
+//! Replaces the references to _TABLE_SUFFIX by references to the first column of a chunk. Returns false if the
+//! expression references any other column or cannot be evaluated per shard.
+static bool BindSuffixFilter(unique_ptr<Expression> &expr, LogicalGet &get, const BigQueryScanBindData &bind_data,
+                             bool &references_suffix) {
+	if (expr->IsVolatile()) {
+		return false;
+	}
+	if (expr->type == ExpressionType::BOUND_COLUMN_REF) {
+		auto &column_ref = expr->Cast<BoundColumnRefExpression>();
+		if (column_ref.binding.table_index != get.table_index ||
+		    column_ref.binding.column_index >= get.column_ids.size() ||
+		    !IsSuffixColumn(bind_data, get.column_ids[column_ref.binding.column_index])) {
+			return false;
+		}
+		references_suffix = true;
+		expr = make_uniq<BoundReferenceExpression>(expr->return_type, 0);
+		return true;
+	}
+	if (expr->GetExpressionClass() == ExpressionClass::BOUND_SUBQUERY) {
+		return false;
+	}
+	bool bound = true;
+	ExpressionIterator::EnumerateChildren(*expr, [&](unique_ptr<Expression> &child) {
+		bound = bound && BindSuffixFilter(child, get, bind_data, references_suffix);
+	});
+	return bound;
+}
 
-	  idx_t max_rows = std::min(
-			 first_min,
-			 static_cast<int64_t>(STANDARD_VECTOR_SIZE));
+void BigQueryScanFunction::PruneShards(ClientContext &context, Expression &filter, BigQueryScanBindData &bind_data) {
+	ExpressionExecutor executor(context, filter);
+	DataChunk chunk;
+	chunk.Initialize(Allocator::Get(context), {LogicalType::VARCHAR});
+	SelectionVector selection(STANDARD_VECTOR_SIZE);
+	vector<string> remaining_suffixes;
+	auto &suffixes = bind_data.shard_suffixes;
+	for (idx_t offset = 0; offset < suffixes.size(); offset += STANDARD_VECTOR_SIZE) {
+		auto count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, suffixes.size() - offset);
+		chunk.Reset();
+		for (idx_t i = 0; i < count; i++) {
+			chunk.SetValue(0, i, Value(suffixes[offset + i]));
+		}
+		chunk.SetCardinality(count);
+		auto match_count = executor.SelectExpression(chunk, selection);
+		for (idx_t i = 0; i < match_count; i++) {
+			remaining_suffixes.push_back(suffixes[offset + selection.get_index(i)]);
+		}
+	}
+	suffixes = std::move(remaining_suffixes);
+}
 
-	  //Printer::Print("max_rows: " + to_string(max_rows));
+static void BigQueryPushdownComplexFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                          vector<unique_ptr<Expression>> &filters) {
+	auto &bind_data = bind_data_p->Cast<BigQueryScanBindData>();
+	if (bind_data.suffix_column.IsValid()) {
+		// filters on _TABLE_SUFFIX of wildcard tables are evaluated at plan time to prune the shards
+		for (idx_t i = 0; i < filters.size(); i++) {
+			auto suffix_filter = filters[i]->Copy();
+			bool references_suffix = false;
+			if (!BindSuffixFilter(suffix_filter, get, bind_data, references_suffix) || !references_suffix) {
+				continue;
+			}
+			BigQueryScanFunction::PruneShards(context, *suffix_filter, bind_data);
+			filters.erase_at(i);
+			i--;
+		}
+	}
+	// table filters only cover top-level columns, filters on STRUCT fields are pushed from here
+	for (idx_t i = 0; i < filters.size(); i++) {
+		auto nested_filter = BigQueryFilterPushdown::TransformNestedFilter(*filters[i], get, bind_data.column_names);
+		if (nested_filter.empty()) {
+			continue;
+		}
+		bind_data.nested_filters.push_back(std::move(nested_filter));
+		filters.erase_at(i);
+		i--;
+	}
+}
 
-	  //Printer::Print("Column count : " + to_string(output.ColumnCount()));
+static unique_ptr<LocalTableFunctionState> BigQueryInitLocalState(ExecutionContext &context, TableFunctionInitInput &input,
+                                                               GlobalTableFunctionState *global_state) {
+	//Printer::Print("BigQueryInitLocalState");
+	return make_uniq<BigQueryScannerLocalState>();
+}
 
-	  for (idx_t c = 0; c < output.ColumnCount(); c++) {
+static void BigQueryStringColumnToVector(const arrow::StringArray &column, idx_t count, Vector &result,
+                                         idx_t result_offset) {
+	auto result_data = FlatVector::GetData<string_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+	for (idx_t r = 0; r < count; r++) {
+		auto row = static_cast<int64_t>(r);
+		if (column.IsNull(row)) {
+			result_validity.SetInvalid(result_offset + r);
+			continue;
+		}
+		auto v = column.GetView(row);
+		result_data[result_offset + r] = StringVector::AddString(result, v.data(), v.size());
+	}
+}
 
-		std::shared_ptr<arrow::Array> column = record_batch->column(c);
+static void BigQueryBatchToChunk(BigQueryScannerGlobalState &gstate, arrow::RecordBatch &record_batch,
+                                 DataChunk &output) {
+	idx_t count = static_cast<idx_t>(record_batch.num_rows());
+	for (idx_t c = 0; c < output.ColumnCount(); c++) {
+		if (gstate.arrow_column_indexes[c] < 0) {
+			// row id: number the rows in the order they are read
+			auto row_ids = FlatVector::GetData<int64_t>(output.data[c]);
+			for (idx_t r = 0; r < count; r++) {
+				row_ids[r] = static_cast<int64_t>(gstate.global_row_count + r);
+			}
+			continue;
+		}
+		std::shared_ptr<arrow::Array> column = record_batch.column(gstate.arrow_column_indexes[c]);
+		auto &column_type = output.data[c].GetType();
 
-		for(idx_t r = 0; r < max_rows; r++){
-			//Printer::Print("Setting value for column: " + to_string(c) + " bq arrow row: " + to_string(r));
+		if (column->type_id() == arrow::Type::STRING && BigQueryGeography::IsGeographyType(column_type)) {
+			// GEOGRAPHY arrives as WKT, convert the whole slice to WKB at once
+			BigQueryGeography::WKTColumnToWKB(static_cast<arrow::StringArray &>(*column), 0, count, output.data[c], 0);
+			continue;
+		}
+		if (column->type_id() == arrow::Type::STRING && column_type.id() == LogicalTypeId::VARCHAR) {
+			// VARCHAR and JSON are copied over as-is
+			BigQueryStringColumnToVector(static_cast<arrow::StringArray &>(*column), count, output.data[c], 0);
+			continue;
+		}
 
-			arrow::Result<std::shared_ptr<arrow::Scalar> > result =
-        	  column->GetScalar(r);
+		for (idx_t r = 0; r < count; r++) {
+			arrow::Result<std::shared_ptr<arrow::Scalar>> result = column->GetScalar(static_cast<int64_t>(r));
 			if (!result.ok()) {
-				std::cout << "Unable to parse scalar\n";
 				throw result.status();
 			}
+			auto v = BigQueryUtils::ValueFromArrowScalar(result.ValueOrDie(), column_type);
+			output.SetValue(c, r, v);
+		}
+	}
+}
 
-			std::shared_ptr<arrow::Scalar> scalar = result.ValueOrDie();
+static void BigQueryScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	//Printer::Print("BigQueryScan");
+	auto &bind_data = data.bind_data->Cast<BigQueryScanBindData>();
+	auto &gstate = data.global_state->Cast<BigQueryScannerGlobalState>();
+	if (gstate.finished) {
+		return;
+	}
+	if (gstate.has_limit && gstate.global_row_count >= gstate.limit) {
+		gstate.finished = true;
+		return;
+	}
+	if (gstate.cached_table) {
+		gstate.cached_table->collection->Scan(gstate.cached_table_scan, output);
+		return;
+	}
 
-			auto v = BigQueryUtils::ValueFromArrowScalar(scalar);
-			output.SetValue(c, gstate.current_offset + r, v);
+	// the read stream is kept open across calls, every call emits (part of) a single batch
+	while (!gstate.current_batch || gstate.batch_offset >= static_cast<idx_t>(gstate.current_batch->num_rows())) {
+		gstate.current_batch = gstate.reader->Next();
+		gstate.batch_offset = 0;
+		if (!gstate.current_batch) {
+			// done
+			if (gstate.cache_writer) {
+				gstate.cache_writer->Commit();
+				gstate.cache_writer.reset();
+			}
+			if (gstate.table_cache_fill) {
+				auto &bigquery_catalog = bind_data.table->catalog.Cast<BigQueryCatalog>();
+				bigquery_catalog.GetTableCache().Put(std::move(gstate.table_cache_fill), gstate.table_cache_ttl,
+				                                     gstate.table_cache_max_bytes);
+			}
+			gstate.finished = true;
+			return;
 		}
-	  }
-	gstate.current_offset = gstate.current_offset + max_rows;
-	gstate.global_row_count = gstate.global_row_count + max_rows;
-	duckdb_row_idx = duckdb_row_idx + max_rows;
-
-    }
-  }
+		if (gstate.arrow_column_indexes.size() != gstate.projected_column_ids.size()) {
+			// the schema is known once the reader has opened its read session
+			SetArrowColumnIndexes(bind_data, gstate);
+		}
+		if (gstate.scan_cache) {
+			gstate.cache_writer = make_uniq<BigQueryScanCacheWriter>(std::move(gstate.scan_cache),
+			                                                         std::move(gstate.cache_key),
+			                                                         gstate.reader->GetSchema());
+		}
+		if (gstate.cache_writer) {
+			gstate.cache_writer->Append(*gstate.current_batch);
+		}
+	}
 
-	if (duckdb_row_idx == 0) {
-		// done
-		return;
+	auto batch_rows = static_cast<idx_t>(gstate.current_batch->num_rows());
+	auto count = MinValue<idx_t>(batch_rows - gstate.batch_offset, STANDARD_VECTOR_SIZE);
+	if (gstate.has_limit) {
+		count = MinValue<idx_t>(count, gstate.limit - gstate.global_row_count);
 	}
+	auto slice = gstate.current_batch->Slice(static_cast<int64_t>(gstate.batch_offset), static_cast<int64_t>(count));
+	BigQueryBatchToChunk(gstate, *slice, output);
 
-	output.SetCardinality(duckdb_row_idx);
-	//Printer::Print("SetCardinality with r: " + to_string(duckdb_row_idx));
+	gstate.batch_offset += count;
+	gstate.current_offset += count;
+	gstate.global_row_count += count;
+	output.SetCardinality(count);
+	if (gstate.table_cache_fill) {
+		// appending without a persistent append state does not keep any block pinned between calls
+		try {
+			gstate.table_cache_fill->collection->Append(output);
+		} catch (std::exception &) {
+			// e.g. out of memory or temp space, the query itself does not need the cached copy
+			gstate.table_cache_fill.reset();
+		}
+	}
+	if (gstate.table_cache_fill && gstate.table_cache_fill->collection->SizeInBytes() > gstate.table_cache_max_bytes) {
+		// the result would not fit into the cache, stop buffering it
+		gstate.table_cache_fill.reset();
+	}
+}
 
+static unique_ptr<NodeStatistics> BigQueryScanCardinality(ClientContext &context, const FunctionData *bind_data_p) {
+	auto &bind_data = bind_data_p->Cast<BigQueryScanBindData>();
+	if (bind_data.estimated_rows == 0) {
+		return nullptr;
+	}
+	return make_uniq<NodeStatistics>(bind_data.estimated_rows, bind_data.estimated_rows);
 }
 
 static string BigQueryScanToString(const FunctionData *bind_data_p) {
 	auto &bind_data = bind_data_p->Cast<BigQueryScanBindData>();
-	return bind_data.table.name;
+	return bind_data.table_name;
 }
 
 static void BigQueryScanSerialize(Serializer &serializer,
@@ -254,15 +1114,63 @@ static unique_ptr<FunctionData> BigQueryScanDeserialize(Deserializer &deserializ
 	throw NotImplementedException("BigQueryScanDeserialize");
 }
 
+bool BigQueryScanFunction::CanCacheResult(const BigQueryScanBindData &bind_data) {
+	// the cache keys do not hold the limit and the offset, a scan that skips rows would store a result that is not
+	// the one of its key
+	return !bind_data.has_limit && bind_data.offset == 0;
+}
+
 BigQueryScanFunction::BigQueryScanFunction(): TableFunction(
 	"bigquery_scan",
 	{LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR},
 	BigQueryScan, BigQueryBind, BigQueryInitGlobalState, BigQueryInitLocalState) {
+	named_parameters["execution_project"] = LogicalType::VARCHAR;
+	named_parameters["secret"] = LogicalType::VARCHAR;
 	to_string = BigQueryScanToString;
+	cardinality = BigQueryScanCardinality;
 	serialize = BigQueryScanSerialize;
 	deserialize = BigQueryScanDeserialize;
+	pushdown_complex_filter = BigQueryPushdownComplexFilter;
 	projection_pushdown = true;
 	filter_pushdown = true;
+	filter_prune = true;
+}
+
+static constexpr const char *BIGQUERY_URL_PREFIX = "bq://";
+
+unique_ptr<TableRef> BigQueryScanFunction::ReplacementScan(ClientContext &context, ReplacementScanInput &input,
+                                                           optional_ptr<ReplacementScanData> data) {
+	string project;
+	string dataset;
+	string table;
+	if (!ParseTableURL(input.table_name, project, dataset, table)) {
+		return nullptr;
+	}
+	vector<unique_ptr<ParsedExpression>> children;
+	children.push_back(make_uniq<ConstantExpression>(Value(project)));
+	children.push_back(make_uniq<ConstantExpression>(Value(dataset)));
+	children.push_back(make_uniq<ConstantExpression>(Value(table)));
+	auto table_function = make_uniq<TableFunctionRef>();
+	table_function->function = make_uniq<FunctionExpression>("bigquery_scan", std::move(children));
+	table_function->alias = table;
+	return std::move(table_function);
+}
+
+bool BigQueryScanFunction::ParseTableURL(const string &url, string &project, string &dataset, string &table) {
+	if (!StringUtil::StartsWith(url, BIGQUERY_URL_PREFIX)) {
+		return false;
+	}
+	// project ids may contain dots ("example.com:project"), dataset and table names cannot
+	auto path = url.substr(strlen(BIGQUERY_URL_PREFIX));
+	auto table_dot = path.rfind('.');
+	auto dataset_dot = table_dot == string::npos || table_dot == 0 ? string::npos : path.rfind('.', table_dot - 1);
+	if (dataset_dot == string::npos || dataset_dot == 0 || table_dot == dataset_dot + 1 || table_dot + 1 == path.size()) {
+		throw BinderException("Invalid BigQuery table \"%s\", expected bq://project.dataset.table", url);
+	}
+	project = path.substr(0, dataset_dot);
+	dataset = path.substr(dataset_dot + 1, table_dot - dataset_dot - 1);
+	table = path.substr(table_dot + 1);
+	return true;
 }
 
 } // namespace duckdb
@@ -2,6 +2,7 @@
 
 #include "bigquery_storage.hpp"
 #include "storage/bigquery_catalog.hpp"
+#include "storage/bigquery_metadata_prefetch.hpp"
 #include "duckdb/parser/parsed_data/attach_info.hpp"
 #include "storage/bigquery_transaction_manager.hpp"
 #include "duckdb/main/secret/secret_manager.hpp"
@@ -33,6 +34,22 @@ string SecretValueOrEmpty(const KeyValueSecret &kv_secret, const string &name) {
 	return input_val.ToString();
 }
 
+string GetServiceAccountJSON(ClientContext &context, const string &secret_name) {
+	// if no secret is specified we default to the unnamed bigquery secret, if it
+	// exists
+	auto secret_entry = GetSecret(context, secret_name.empty() ? "__default_bigquery" : secret_name);
+	if (secret_entry) {
+		// secret found - read data
+		const auto &kv_secret = dynamic_cast<const KeyValueSecret &>(*secret_entry->secret);
+		return SecretValueOrEmpty(kv_secret, "service_account_json");
+	}
+	if (!secret_name.empty()) {
+		// secret not found and one was explicitly provided - throw an error
+		throw BinderException("Secret with name \"%s\" not found", secret_name);
+	}
+	return string();
+}
+
 static unique_ptr<Catalog> BigQueryAttach(StorageExtensionInfo *storage_info, ClientContext &context, AttachedDatabase &db,
                                        const string &name, AttachInfo &info, AccessMode access_mode) {
 	//Printer::Print("BigQueryAttach");
@@ -41,6 +58,8 @@ static unique_ptr<Catalog> BigQueryAttach(StorageExtensionInfo *storage_info, Cl
 	string service_account_json = "";
 	// check if we have a secret provided
 	string secret_name;
+	// "dataset.table" names whose metadata and data are prefetched in the background
+	vector<string> hot_tables;
 	for (auto &entry : info.options) {
 		auto lower_name = StringUtil::Lower(entry.first);
 		if (lower_name == "type" || lower_name == "read_only") {
@@ -49,35 +68,29 @@ static unique_ptr<Catalog> BigQueryAttach(StorageExtensionInfo *storage_info, Cl
 			execution_project = entry.second.ToString();
 		} else if (lower_name == "secret") {
 			secret_name = entry.second.ToString();
+		} else if (lower_name == "hot_tables") {
+			for (auto &hot_table : StringUtil::Split(entry.second.ToString(), ',')) {
+				StringUtil::Trim(hot_table);
+				if (!hot_table.empty()) {
+					hot_tables.push_back(hot_table);
+				}
+			}
 		} else {
 			throw BinderException("Unrecognized option for BigQuery attach: %s", entry.first);
 		}
 	}
 
-	// if no secret is specified we default to the unnamed bigquery secret, if it
-	// exists
-	bool explicit_secret = !secret_name.empty();
-	if (!explicit_secret) {
-		// look up settings from the default unnamed bigquery secret if none is
-		// provided
-		secret_name = "__default_bigquery";
-	}
-
-	auto secret_entry = GetSecret(context, secret_name);
-	if (secret_entry) {
-		// secret found - read data
-		const auto &kv_secret = dynamic_cast<const KeyValueSecret &>(*secret_entry->secret);
-		service_account_json = SecretValueOrEmpty(kv_secret, "service_account_json");
-	} else if (explicit_secret) {
-		// secret not found and one was explicitly provided - throw an error
-		throw BinderException("Secret with name \"%s\" not found", secret_name);
-	}
+	service_account_json = GetServiceAccountJSON(context, secret_name);
 
 	//Printer::Print("service_account_json: " + service_account_json + "\n");
 	//Printer::Print("execution_project: " + execution_project + "\n");
 	//Printer::Print("database: " + database + "\n");
 
-	return make_uniq<BigQueryCatalog>(db, database, execution_project, access_mode, service_account_json);
+	auto catalog = make_uniq<BigQueryCatalog>(db, database, execution_project, access_mode, service_account_json);
+	catalog->LoadMetadataCache(context);
+	catalog->PrefetchHotTables(context, hot_tables);
+	BigQueryMetadataPrefetch::Register(context);
+	return std::move(catalog);
 }
 
 static unique_ptr<TransactionManager> BigQueryCreateTransactionManager(StorageExtensionInfo *storage_info,
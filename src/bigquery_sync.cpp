@@ -0,0 +1,383 @@
+#include "bigquery_sync.hpp"
+#include "bigquery_utils.hpp"
+#include "storage/bigquery_catalog.hpp"
+#include "storage/bigquery_table_entry.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+
+namespace duckdb {
+
+struct SyncFunctionData : public TableFunctionData {
+	//! The BigQuery table as passed to the function, and as a DuckDB SQL name
+	string source_name;
+	string source_sql;
+	//! The local table as passed to the function, and as a DuckDB SQL name
+	string local_name;
+	string local_sql;
+	//! The table that records the synced partitions, next to the local table
+	string state_sql;
+	bool local_exists = false;
+
+	string execution_project;
+	string storage_project;
+	string dataset;
+	string table;
+	string service_account_json;
+
+	BigQueryPartitioning partitioning;
+
+	//! Column that only grows for append-only tables, syncs then only read rows beyond the local maximum
+	string append_column;
+	LogicalType append_column_type;
+
+	bool executed = false;
+	vector<vector<Value>> results;
+	idx_t offset = 0;
+};
+
+static string QualifiedNameToSQL(const string &catalog, const string &schema, const string &name) {
+	string result;
+	if (!catalog.empty()) {
+		result += KeywordHelper::WriteOptionallyQuoted(catalog) + ".";
+	}
+	if (!schema.empty()) {
+		result += KeywordHelper::WriteOptionallyQuoted(schema) + ".";
+	}
+	return result + KeywordHelper::WriteOptionallyQuoted(name);
+}
+
+static unique_ptr<FunctionData> SyncBind(ClientContext &context, TableFunctionBindInput &input,
+                                         vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<SyncFunctionData>();
+	result->source_name = input.inputs[0].GetValue<string>();
+	result->local_name = input.inputs[1].GetValue<string>();
+
+	auto source_name = QualifiedName::Parse(result->source_name);
+	auto &source = Catalog::GetEntry<TableCatalogEntry>(context, source_name.catalog, source_name.schema,
+	                                                     source_name.name);
+	if (source.catalog.GetCatalogType() != "bigquery") {
+		throw BinderException("bigquery_sync can only sync BigQuery tables");
+	}
+	auto &source_table = source.Cast<BigQueryTableEntry>();
+	auto &bigquery_catalog = source.catalog.Cast<BigQueryCatalog>();
+	result->source_sql = QualifiedNameToSQL(source_name.catalog, source_name.schema, source_name.name);
+	result->execution_project = bigquery_catalog.execution_project;
+	result->storage_project = bigquery_catalog.storage_project;
+	result->dataset = source.schema.name;
+	result->table = source.name;
+	result->service_account_json = bigquery_catalog.service_account_json;
+	auto &partitioning = result->partitioning;
+	partitioning.type = source_table.partition_type;
+	partitioning.column = source_table.partition_column;
+	partitioning.range_interval = source_table.partition_range_interval;
+	auto &columns = source.GetColumns();
+	if (!partitioning.column.empty() && columns.ColumnExists(partitioning.column)) {
+		partitioning.column_type = columns.GetColumn(partitioning.column).GetType();
+	} else {
+		// ingestion time partitioning, partitions cannot be told apart locally
+		partitioning.column.clear();
+	}
+
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "append_column") {
+			result->append_column = StringValue::Get(kv.second);
+			if (!columns.ColumnExists(result->append_column)) {
+				throw BinderException("Table \"%s\" does not have a column named \"%s\"", source.name,
+				                      result->append_column);
+			}
+			result->append_column_type = columns.GetColumn(result->append_column).GetType();
+		}
+	}
+
+	if (source_table.wildcard && result->append_column.empty()) {
+		throw BinderException("Wildcard tables can only be synced with an append_column");
+	}
+
+	auto local_name = QualifiedName::Parse(result->local_name);
+	result->local_sql = QualifiedNameToSQL(local_name.catalog, local_name.schema, local_name.name);
+	result->state_sql = QualifiedNameToSQL(local_name.catalog, local_name.schema, "bigquery_sync_state");
+	result->local_exists = Catalog::GetEntry<TableCatalogEntry>(context, local_name.catalog, local_name.schema,
+	                                                            local_name.name, OnEntryNotFound::RETURN_NULL) !=
+	                       nullptr;
+
+	names.emplace_back("partition_id");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("action");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("rows");
+	return_types.push_back(LogicalType::BIGINT);
+	return std::move(result);
+}
+
+static unique_ptr<MaterializedQueryResult> SyncQuery(Connection &con, const string &sql) {
+	auto result = con.Query(sql);
+	if (result->HasError()) {
+		result->ThrowError();
+	}
+	return result;
+}
+
+//! Runs an INSERT/DELETE/CREATE TABLE AS statement and returns the number of affected rows
+static int64_t SyncUpdate(Connection &con, const string &sql) {
+	auto result = SyncQuery(con, sql);
+	return result->GetValue(0, 0).GetValue<int64_t>();
+}
+
+static string PartitionBoundLiteral(const LogicalType &type, timestamp_t bound) {
+	switch (type.id()) {
+	case LogicalTypeId::DATE:
+		return "DATE " + KeywordHelper::WriteQuoted(Date::ToString(Timestamp::GetDate(bound)), '\'');
+	case LogicalTypeId::TIMESTAMP_TZ:
+		// BigQuery partitions TIMESTAMP columns by their UTC value
+		return "TIMESTAMPTZ " + KeywordHelper::WriteQuoted(Timestamp::ToString(bound) + "+00", '\'');
+	default:
+		return "TIMESTAMP " + KeywordHelper::WriteQuoted(Timestamp::ToString(bound), '\'');
+	}
+}
+
+bool BigQuerySyncFunction::PartitionPredicate(const BigQueryPartitioning &partitioning, const string &partition_id,
+                                              const vector<string> &partition_ids, string &predicate) {
+	if (partitioning.column.empty()) {
+		return false;
+	}
+	auto column = KeywordHelper::WriteOptionallyQuoted(partitioning.column);
+	if (partition_id == "__NULL__") {
+		predicate = column + " IS NULL";
+		return true;
+	}
+	if (partition_id == "__UNPARTITIONED__") {
+		// rows that are not (yet) assigned to a partition: those of the streaming buffer, and those outside the
+		// range of the partitioning. These are the rows that fall into none of the other partitions.
+		vector<string> partition_predicates;
+		for (auto &other_id : partition_ids) {
+			if (other_id == partition_id || other_id == "__NULL__") {
+				continue;
+			}
+			string other_predicate;
+			if (!PartitionPredicate(partitioning, other_id, partition_ids, other_predicate)) {
+				return false;
+			}
+			partition_predicates.push_back("(" + other_predicate + ")");
+		}
+		predicate = column + " IS NOT NULL";
+		if (!partition_predicates.empty()) {
+			predicate += " AND NOT (" + StringUtil::Join(partition_predicates, " OR ") + ")";
+		}
+		return true;
+	}
+	if (StringUtil::StartsWith(partition_id, "__") || partition_id.empty()) {
+		return false;
+	}
+	try {
+		if (partitioning.type == "RANGE") {
+			auto start = std::stoll(partition_id);
+			predicate = column + " >= " + std::to_string(start) + " AND " + column + " < " +
+			            std::to_string(start + partitioning.range_interval);
+			return true;
+		}
+		// partition ids are YYYY, YYYYMM, YYYYMMDD or YYYYMMDDHH
+		auto year = std::stoi(partition_id.substr(0, 4));
+		auto month = partition_id.size() >= 6 ? std::stoi(partition_id.substr(4, 2)) : 1;
+		auto day = partition_id.size() >= 8 ? std::stoi(partition_id.substr(6, 2)) : 1;
+		auto hour = partition_id.size() >= 10 ? std::stoi(partition_id.substr(8, 2)) : 0;
+		auto lower = Timestamp::FromDatetime(Date::FromDate(year, month, day), dtime_t(hour * Interval::MICROS_PER_HOUR));
+		timestamp_t upper;
+		if (partitioning.type == "HOUR") {
+			upper = timestamp_t(lower.value + Interval::MICROS_PER_HOUR);
+		} else if (partitioning.type == "DAY") {
+			upper = timestamp_t(lower.value + Interval::MICROS_PER_DAY);
+		} else if (partitioning.type == "MONTH") {
+			upper = Timestamp::FromDatetime(Date::FromDate(month == 12 ? year + 1 : year, month == 12 ? 1 : month + 1, 1),
+			                                dtime_t(0));
+		} else if (partitioning.type == "YEAR") {
+			upper = Timestamp::FromDatetime(Date::FromDate(year + 1, 1, 1), dtime_t(0));
+		} else {
+			return false;
+		}
+		predicate = column + " >= " + PartitionBoundLiteral(partitioning.column_type, lower) + " AND " + column +
+		            " < " + PartitionBoundLiteral(partitioning.column_type, upper);
+		return true;
+	} catch (std::exception &) {
+		return false;
+	}
+}
+
+static void AddSyncResult(SyncFunctionData &data, const string &partition_id, const string &action, int64_t rows) {
+	data.results.push_back({partition_id.empty() ? Value() : Value(partition_id), Value(action), Value::BIGINT(rows)});
+}
+
+static void SyncAppendOnly(Connection &con, SyncFunctionData &data) {
+	if (!data.local_exists) {
+		AddSyncResult(data, "", "create",
+		              SyncUpdate(con, "CREATE TABLE " + data.local_sql + " AS SELECT * FROM " + data.source_sql));
+		return;
+	}
+	auto column = KeywordHelper::WriteOptionallyQuoted(data.append_column);
+	auto max_value = SyncQuery(con, "SELECT MAX(" + column + ")::VARCHAR FROM " + data.local_sql)->GetValue(0, 0);
+	string filter;
+	int64_t removed_rows = 0;
+	if (!max_value.IsNull()) {
+		// the column does not have to be unique: rows with the maximum value may have been added after the previous
+		// sync, so they are all read again and replace the local ones. The filter is a constant, so that it is pushed
+		// into the read session.
+		auto bound = "CAST(" + KeywordHelper::WriteQuoted(max_value.ToString(), '\'') + " AS " +
+		             data.append_column_type.ToString() + ")";
+		removed_rows = SyncUpdate(con, "DELETE FROM " + data.local_sql + " WHERE " + column + " = " + bound);
+		filter = " WHERE " + column + " >= " + bound;
+	}
+	auto inserted_rows = SyncUpdate(con, "INSERT INTO " + data.local_sql + " BY NAME SELECT * FROM " +
+	                                         data.source_sql + filter);
+	AddSyncResult(data, "", "append", inserted_rows - removed_rows);
+}
+
+static void SyncPartitions(Connection &con, SyncFunctionData &data) {
+	// the last modification time of every partition, the partition id is NULL for tables without partitioning
+	auto partitions_query = "SELECT partition_id, UNIX_MILLIS(last_modified_time) FROM " +
+	                        BigQueryUtils::WriteIdentifier(data.storage_project) + "." +
+	                        BigQueryUtils::WriteIdentifier(data.dataset) +
+	                        ".INFORMATION_SCHEMA.PARTITIONS WHERE table_name = " +
+	                        BigQueryUtils::WriteLiteral(data.table);
+	auto partitions = BigQueryUtils::BigQueryRunQuery(data.execution_project, partitions_query,
+	                                                  data.service_account_json);
+	map<string, int64_t> source_partitions;
+	for (auto &row : partitions["rows"]) {
+		auto &partition_id = row["f"][0]["v"];
+		auto &last_modified = row["f"][1]["v"];
+		source_partitions[partition_id.is_null() ? "" : partition_id.get<std::string>()] =
+		    last_modified.is_null() ? 0 : std::stoll(last_modified.get<std::string>());
+	}
+
+	SyncQuery(con, "CREATE TABLE IF NOT EXISTS " + data.state_sql +
+	                   " (source VARCHAR, local_table VARCHAR, partition_id VARCHAR, last_modified_time BIGINT)");
+	auto state_filter = " WHERE source = " + KeywordHelper::WriteQuoted(data.source_name, '\'') +
+	                    " AND local_table = " + KeywordHelper::WriteQuoted(data.local_name, '\'');
+	map<string, int64_t> synced_partitions;
+	if (data.local_exists) {
+		auto state = SyncQuery(con, "SELECT COALESCE(partition_id, ''), last_modified_time FROM " + data.state_sql +
+		                                state_filter);
+		for (idx_t r = 0; r < state->RowCount(); r++) {
+			synced_partitions[state->GetValue(0, r).ToString()] = state->GetValue(1, r).GetValue<int64_t>();
+		}
+	}
+
+	if (!data.local_exists) {
+		AddSyncResult(data, "", "create",
+		              SyncUpdate(con, "CREATE TABLE " + data.local_sql + " AS SELECT * FROM " + data.source_sql));
+	} else {
+		vector<string> changed_partitions;
+		vector<string> dropped_partitions;
+		for (auto &partition : source_partitions) {
+			auto synced = synced_partitions.find(partition.first);
+			if (synced == synced_partitions.end() || synced->second != partition.second) {
+				changed_partitions.push_back(partition.first);
+			}
+		}
+		for (auto &partition : synced_partitions) {
+			if (source_partitions.find(partition.first) == source_partitions.end()) {
+				dropped_partitions.push_back(partition.first);
+			}
+		}
+		// every partition has to map to a filter on the partitioning column, otherwise the table is reloaded
+		vector<string> partition_ids;
+		for (auto &partition : source_partitions) {
+			partition_ids.push_back(partition.first);
+		}
+		bool full_refresh = false;
+		map<string, string> predicates;
+		for (auto &partition_id : changed_partitions) {
+			full_refresh = full_refresh || !BigQuerySyncFunction::PartitionPredicate(data.partitioning, partition_id,
+			                                                                         partition_ids,
+			                                                                         predicates[partition_id]);
+		}
+		for (auto &partition_id : dropped_partitions) {
+			full_refresh = full_refresh || !BigQuerySyncFunction::PartitionPredicate(data.partitioning, partition_id,
+			                                                                         partition_ids,
+			                                                                         predicates[partition_id]);
+		}
+
+		if (full_refresh) {
+			SyncUpdate(con, "DELETE FROM " + data.local_sql);
+			AddSyncResult(data, "", "reload",
+			              SyncUpdate(con, "INSERT INTO " + data.local_sql + " BY NAME SELECT * FROM " +
+			                                  data.source_sql));
+		} else {
+			for (auto &partition_id : dropped_partitions) {
+				AddSyncResult(data, partition_id, "delete",
+				              SyncUpdate(con, "DELETE FROM " + data.local_sql + " WHERE " + predicates[partition_id]));
+			}
+			for (auto &partition_id : changed_partitions) {
+				auto &predicate = predicates[partition_id];
+				auto is_new = synced_partitions.find(partition_id) == synced_partitions.end();
+				// new partitions can also hold rows that were synced from __UNPARTITIONED__ before BigQuery moved
+				// them into their partition
+				SyncUpdate(con, "DELETE FROM " + data.local_sql + " WHERE " + predicate);
+				// the predicate is pushed into the row restriction, so only this partition is read
+				AddSyncResult(data, partition_id, is_new ? "insert" : "replace",
+				              SyncUpdate(con, "INSERT INTO " + data.local_sql + " BY NAME SELECT * FROM " +
+				                                  data.source_sql + " WHERE " + predicate));
+			}
+		}
+	}
+
+	SyncQuery(con, "DELETE FROM " + data.state_sql + state_filter);
+	if (source_partitions.empty()) {
+		return;
+	}
+	string insert_state = "INSERT INTO " + data.state_sql + " VALUES ";
+	bool first = true;
+	for (auto &partition : source_partitions) {
+		if (!first) {
+			insert_state += ", ";
+		}
+		first = false;
+		insert_state += "(" + KeywordHelper::WriteQuoted(data.source_name, '\'') + ", " +
+		                KeywordHelper::WriteQuoted(data.local_name, '\'') + ", " +
+		                (partition.first.empty() ? string("NULL") : KeywordHelper::WriteQuoted(partition.first, '\'')) +
+		                ", " + std::to_string(partition.second) + ")";
+	}
+	SyncQuery(con, insert_state);
+}
+
+static void SyncFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &data = data_p.bind_data->CastNoConst<SyncFunctionData>();
+	if (!data.executed) {
+		data.executed = true;
+		// the local table and the sync state are updated in one transaction on a separate connection
+		Connection con(DatabaseInstance::GetDatabase(context));
+		con.BeginTransaction();
+		try {
+			if (data.append_column.empty()) {
+				SyncPartitions(con, data);
+			} else {
+				SyncAppendOnly(con, data);
+			}
+			con.Commit();
+		} catch (...) {
+			if (con.HasActiveTransaction()) {
+				con.Rollback();
+			}
+			throw;
+		}
+	}
+	idx_t count = 0;
+	while (data.offset < data.results.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &row = data.results[data.offset++];
+		for (idx_t c = 0; c < row.size(); c++) {
+			output.SetValue(c, count, row[c]);
+		}
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+BigQuerySyncFunction::BigQuerySyncFunction()
+    : TableFunction("bigquery_sync", {LogicalType::VARCHAR, LogicalType::VARCHAR}, SyncFunction, SyncBind) {
+	named_parameters["append_column"] = LogicalType::VARCHAR;
+}
+
+} // namespace duckdb
@@ -1,18 +1,29 @@
 #include "storage/bigquery_schema_entry.hpp"
 #include "bigquery_utils.hpp"
+#include "bigquery_credentials.hpp"
 #include "bigquery_result.hpp"
+#include "bigquery_geography.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
 
 #include "google/cloud/bigquery/storage/v1/bigquery_read_client.h"
 #include <google/cloud/credentials.h>
+#include <google/cloud/grpc_options.h>
 #include <google/cloud/status_or.h>
-#include <google/cloud/storage/oauth2/google_credentials.h>
 #include <nlohmann/json.hpp>
 #include <cpprest/http_client.h>
 #include <cpprest/filestream.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <mutex>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <thread>
 
 #include <arrow/api.h>
 #include <arrow/array/data.h>
@@ -24,7 +35,6 @@
 namespace bigquery_storage = ::google::cloud::bigquery_storage_v1;
 namespace bigquery_storage_read = ::google::cloud::bigquery::storage::v1;
 namespace gcs = google::cloud::storage;
-namespace gcpoauth2 = google::cloud::storage::oauth2;
 using json = nlohmann::json;
 using namespace web::http;
 using namespace web::http::client;
@@ -55,12 +65,15 @@ namespace duckdb {
 				}
 
 				auto field_type = TypeToLogicalType(field_type_str, subfields);
+				if (field.value("mode", "") == "REPEATED") {
+					field_type = LogicalType::LIST(field_type);
+				}
 				column_list.push_back(BQField(field_name, field_type));
 			}
 			return column_list;
 		}
 
-		LogicalType TypeToLogicalType(const std::string &bq_type, std::vector<BQField> subfields) {
+		static LogicalType TypeToLogicalType(const std::string &bq_type, std::vector<BQField> subfields) {
 			if (bq_type == "INTEGER") {
 				return LogicalType::BIGINT;
 			} else if (bq_type == "FLOAT") {
@@ -84,8 +97,12 @@ namespace duckdb {
 				// Assume a default precision and scale for this example; these could be parameterized if needed
 				return LogicalType::DECIMAL(38, 9);
 			} else if (bq_type == "JSON") {
-				// FIXME
-				return LogicalType::VARCHAR;
+				// JSON is delivered as text, exposing it with the JSON alias lets the json extension work on it
+				// without a round trip through a VARCHAR cast
+				return LogicalType::JSON();
+			} else if (bq_type == "GEOGRAPHY") {
+				// GEOGRAPHY is delivered as WKT, the scanner converts it to WKB so spatial functions can consume it
+				return BigQueryGeography::GeographyType();
 			} else if (bq_type == "BYTES") {
 				return LogicalType::BLOB;
 			} else if (bq_type == "STRING") {
@@ -109,23 +126,179 @@ namespace duckdb {
 		}
 };
 
+static void SkipSpaces(const string &text, idx_t &pos) {
+	while (pos < text.size() && StringUtil::CharacterIsSpace(text[pos])) {
+		pos++;
+	}
+}
+
+static void ExpectCharacter(const string &text, idx_t &pos, char c) {
+	SkipSpaces(text, pos);
+	if (pos >= text.size() || text[pos] != c) {
+		throw IOException("Failed to parse BigQuery type \"%s\": expected '%c' at position %llu", text, c, pos);
+	}
+	pos++;
+}
+
+//! Reads a (possibly backquoted) identifier
+static string ParseTypeIdentifier(const string &text, idx_t &pos) {
+	SkipSpaces(text, pos);
+	if (pos < text.size() && text[pos] == '`') {
+		auto end = text.find('`', pos + 1);
+		if (end == string::npos) {
+			throw IOException("Failed to parse BigQuery type \"%s\": unterminated identifier", text);
+		}
+		auto identifier = text.substr(pos + 1, end - pos - 1);
+		pos = end + 1;
+		return identifier;
+	}
+	auto start = pos;
+	while (pos < text.size() && (StringUtil::CharacterIsAlphaNumeric(text[pos]) || text[pos] == '_')) {
+		pos++;
+	}
+	if (start == pos) {
+		throw IOException("Failed to parse BigQuery type \"%s\": expected an identifier at position %llu", text, pos);
+	}
+	return text.substr(start, pos - start);
+}
+
+//! Parses a type as written in SQL, e.g. in INFORMATION_SCHEMA.COLUMNS, into the type the REST schema would give
+static LogicalType ParseSQLType(const string &text, idx_t &pos) {
+	auto name = StringUtil::Upper(ParseTypeIdentifier(text, pos));
+	SkipSpaces(text, pos);
+	if (name == "ARRAY") {
+		ExpectCharacter(text, pos, '<');
+		auto child_type = ParseSQLType(text, pos);
+		ExpectCharacter(text, pos, '>');
+		return LogicalType::LIST(child_type);
+	}
+	if (name == "STRUCT") {
+		ExpectCharacter(text, pos, '<');
+		vector<BQField> subfields;
+		while (true) {
+			auto field_name = ParseTypeIdentifier(text, pos);
+			auto field_type = ParseSQLType(text, pos);
+			subfields.emplace_back(std::move(field_name), std::move(field_type));
+			SkipSpaces(text, pos);
+			if (pos < text.size() && text[pos] == ',') {
+				pos++;
+				continue;
+			}
+			ExpectCharacter(text, pos, '>');
+			break;
+		}
+		return BQColumnRequest::TypeToLogicalType("RECORD", std::move(subfields));
+	}
+	if (pos < text.size() && (text[pos] == '(' || text[pos] == '<')) {
+		// parameters such as STRING(10) or NUMERIC(10, 2), and the element type of RANGE<DATE>, do not change the type
+		auto close = text[pos] == '(' ? ')' : '>';
+		auto end = text.find(close, pos);
+		if (end == string::npos) {
+			throw IOException("Failed to parse BigQuery type \"%s\"", text);
+		}
+		pos = end + 1;
+	}
+	// the REST API uses the legacy names of these types
+	if (name == "INT64") {
+		name = "INTEGER";
+	} else if (name == "FLOAT64") {
+		name = "FLOAT";
+	} else if (name == "BOOL") {
+		name = "BOOLEAN";
+	}
+	return BQColumnRequest::TypeToLogicalType(name, {});
+}
+
+string BigQueryUtils::LogicalTypeToSQLType(const LogicalType &type) {
+	if (BigQueryGeography::IsGeographyType(type)) {
+		return "GEOGRAPHY";
+	}
+	if (type.IsJSONType()) {
+		return "JSON";
+	}
+	switch (type.id()) {
+	case LogicalTypeId::BIGINT:
+		return "INT64";
+	case LogicalTypeId::DOUBLE:
+		return "FLOAT64";
+	case LogicalTypeId::BOOLEAN:
+		return "BOOL";
+	case LogicalTypeId::DATE:
+		return "DATE";
+	case LogicalTypeId::TIMESTAMP:
+		return "DATETIME";
+	case LogicalTypeId::TIMESTAMP_TZ:
+		return "TIMESTAMP";
+	case LogicalTypeId::DECIMAL:
+		return "NUMERIC";
+	case LogicalTypeId::BLOB:
+		return "BYTES";
+	case LogicalTypeId::LIST:
+		return "ARRAY<" + LogicalTypeToSQLType(ListType::GetChildType(type)) + ">";
+	case LogicalTypeId::STRUCT: {
+		vector<string> fields;
+		for (auto &child : StructType::GetChildTypes(type)) {
+			fields.push_back(WriteIdentifier(child.first) + " " + LogicalTypeToSQLType(child.second));
+		}
+		return "STRUCT<" + StringUtil::Join(fields, ", ") + ">";
+	}
+	default:
+		// TIME and the types BigQuery has no counterpart of are read as strings
+		return "STRING";
+	}
+}
+
+LogicalType BigQueryUtils::SQLTypeToLogicalType(const string &sql_type) {
+	idx_t pos = 0;
+	auto result = ParseSQLType(sql_type, pos);
+	SkipSpaces(sql_type, pos);
+	if (pos != sql_type.size()) {
+		throw IOException("Failed to parse BigQuery type \"%s\": unexpected text at position %llu", sql_type, pos);
+	}
+	return result;
+}
+
 std::string GetAccessToken(const string &service_account_json) {
-	google::cloud::StatusOr<std::__1::shared_ptr<google::cloud::storage::oauth2::Credentials>>  credentials;
-	if(service_account_json.empty()) {
-		credentials = gcpoauth2::GoogleDefaultCredentials();
-	} else {
-		//Printer::Print("GetAccessToken service_account_json: " + service_account_json);
-		credentials = gcpoauth2::CreateServiceAccountCredentialsFromJsonContents(service_account_json);
-	}
-	if (!credentials) {
-		throw std::runtime_error("Failed to create credentials: " + credentials.status().message());
-	}
-	auto token = credentials.value()->AuthorizationHeader();
-	if (!token) {
-		throw std::runtime_error("Failed to obtain access token: " + token.status().message());
-	}
-	// Remove the "Authorization: Bearer " prefix
-	return token->substr(21);
+	// minting a token takes a round trip (and signing it for service accounts), the cache reuses it until it expires
+	return BigQueryCredentialCache::Get().GetAccessToken(service_account_json);
+}
+
+static json BigQueryRequestJSON(http_client &client, http_request &request) {
+	auto response = client.request(request).get();
+	auto body = response.extract_utf8string(true).get();
+	if (response.status_code() != status_codes::OK) {
+		throw IOException("BigQuery request failed with status %d: %s", static_cast<int>(response.status_code()), body);
+	}
+	return json::parse(body);
+}
+
+unique_ptr<BigQueryTableEntry> BigQueryUtils::CreateTableEntryFromMetadata(Catalog &catalog,
+                                                                           BigQuerySchemaEntry &schema_entry,
+                                                                           const string &dataset, const string &table,
+                                                                           BQTableMetadata &table_metadata) {
+	auto table_info = make_uniq<BigQueryTableInfo>(dataset, table);
+	auto &create_info = table_info->create_info;
+	auto &columns = create_info->columns;
+	for (auto &col : table_metadata.columns) {
+		ColumnDefinition column(std::move(col.name), std::move(col.type));
+		columns.AddColumn(std::move(column));
+	}
+	auto table_entry = make_uniq<BigQueryTableEntry>(catalog, schema_entry, *table_info);
+	table_entry->table_type = std::move(table_metadata.table_type);
+	table_entry->num_rows = table_metadata.num_rows;
+	table_entry->num_bytes = table_metadata.num_bytes;
+	table_entry->primary_key = std::move(table_metadata.primary_key);
+	table_entry->clustering_fields = std::move(table_metadata.clustering_fields);
+	table_entry->last_modified_time = std::move(table_metadata.last_modified_time);
+	table_entry->etag = std::move(table_metadata.etag);
+	table_entry->validated_at = Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp());
+	table_entry->partition_type = std::move(table_metadata.partition_type);
+	table_entry->partition_column = std::move(table_metadata.partition_column);
+	table_entry->partition_range_interval = table_metadata.partition_range_interval;
+	table_entry->external_format = std::move(table_metadata.external_format);
+	table_entry->external_uris = std::move(table_metadata.external_uris);
+	table_entry->external_hive_partitioning = table_metadata.external_hive_partitioning;
+	return table_entry;
 }
 
 unique_ptr<BigQueryTableEntry> BigQueryUtils::BigQueryCreateBigQueryTableEntry(
@@ -138,37 +311,289 @@ unique_ptr<BigQueryTableEntry> BigQueryUtils::BigQueryCreateBigQueryTableEntry(
 	const string &service_account_json
 	) {
 	//Printer::Print("BigQueryReadTableEntry for execution_project: " + execution_project + " storage_project: " + storage_project + " dataset: " + dataset + " table: " + table);
-	auto column_list = BigQueryUtils::BigQueryReadColumnListForTable(
+	auto table_metadata = BigQueryUtils::BigQueryReadTableMetadata(
 		execution_project, storage_project, dataset, table, service_account_json);
-	if (column_list.size() == 0) {
+	if (table_metadata.columns.size() == 0) {
 		return nullptr;
 	}
-	// print size of columns
-	//auto column_list_size = column_list.size();
-	//Printer::Print("column_list_size size: " + to_string(column_list_size));
+	return CreateTableEntryFromMetadata(catalog, *schema_entry, dataset, table, table_metadata);
+}
 
-	//Printer::Print("column_list done");
-	auto table_info = make_uniq<BigQueryTableInfo>(dataset, table);
-	auto &create_info = table_info->create_info;
-	auto &columns = create_info->columns;
-	for (auto &col : column_list) {
-		ColumnDefinition column(std::move(col.name), std::move(col.type));
-		columns.AddColumn(std::move(column));
+unique_ptr<BigQueryTableEntry> BigQueryUtils::BigQueryCreateWildcardTableEntry(Catalog &catalog,
+                                                                              BigQuerySchemaEntry &schema_entry,
+                                                                              const string &execution_project,
+                                                                              const string &storage_project,
+                                                                              const string &dataset,
+                                                                              const string &pattern,
+                                                                              const string &service_account_json) {
+	auto prefix = pattern.substr(0, pattern.size() - 1);
+	auto suffixes = BigQueryListShardSuffixes(storage_project, dataset, prefix, service_account_json);
+	if (suffixes.empty()) {
+		return nullptr;
 	}
-	// print size of columns
-	//auto column_size = columns.GetColumnNames().size();
-	//Printer::Print("columns size: " + to_string(column_size));
-	auto table_entry = make_uniq<BigQueryTableEntry>(catalog, *schema_entry, *table_info);
+	// like BigQuery, the schema of the newest shard is used, which for date-sharded tables sorts last
+	auto table_metadata = BigQueryReadTableMetadata(execution_project, storage_project, dataset,
+	                                                prefix + suffixes.back(), service_account_json);
+	if (table_metadata.columns.empty()) {
+		return nullptr;
+	}
+	table_metadata.columns.emplace_back(WILDCARD_SUFFIX_COLUMN, LogicalType::VARCHAR);
+	// the shards differ in their versions, keys and partitioning, only the size is estimated
+	table_metadata.num_rows *= suffixes.size();
+	table_metadata.num_bytes *= suffixes.size();
+	table_metadata.last_modified_time.clear();
+	table_metadata.primary_key.clear();
+	table_metadata.clustering_fields.clear();
+	table_metadata.partition_type.clear();
+	table_metadata.partition_column.clear();
+	table_metadata.external_uris.clear();
+	table_metadata.table_type = "TABLE";
+	auto table_entry = CreateTableEntryFromMetadata(catalog, schema_entry, dataset, pattern, table_metadata);
+	table_entry->wildcard = true;
+	table_entry->shard_prefix = std::move(prefix);
+	table_entry->shard_suffixes = std::move(suffixes);
 	return table_entry;
 }
 
-	vector<BQField> BigQueryUtils::BigQueryReadColumnListForTable(
+//! The number of tables.get requests that BigQueryCreateDatasetTableEntries runs concurrently
+static constexpr idx_t TABLE_DETAILS_PARALLELISM = 16;
+
+vector<unique_ptr<BigQueryTableEntry>> BigQueryUtils::BigQueryCreateDatasetTableEntries(
+    Catalog &catalog, BigQuerySchemaEntry &schema_entry, const string &execution_project,
+    const string &storage_project, const string &dataset, const string &service_account_json) {
+	// one row per column, with the table's type, size and version (from the __TABLES__ meta-table) repeated on
+	// every row, and the column's position in the primary key and in the clustering
+	auto prefix = WriteIdentifier(storage_project) + "." + WriteIdentifier(dataset) + ".";
+	auto query = "SELECT c.table_name, t.table_type, c.column_name, c.data_type, c.is_partitioning_column, "
+	             "s.row_count, s.size_bytes, s.last_modified_time, k.ordinal_position, "
+	             "c.clustering_ordinal_position "
+	             "FROM " + prefix + "INFORMATION_SCHEMA.COLUMNS c "
+	             "JOIN " + prefix + "INFORMATION_SCHEMA.TABLES t ON t.table_name = c.table_name "
+	             "LEFT JOIN " + prefix + "__TABLES__ s ON s.table_id = c.table_name "
+	             "LEFT JOIN (SELECT u.table_name, u.column_name, u.ordinal_position FROM " + prefix +
+	             "INFORMATION_SCHEMA.KEY_COLUMN_USAGE u JOIN " + prefix +
+	             "INFORMATION_SCHEMA.TABLE_CONSTRAINTS tc ON tc.constraint_name = u.constraint_name "
+	             "WHERE tc.constraint_type = 'PRIMARY KEY') k "
+	             "ON k.table_name = c.table_name AND k.column_name = c.column_name "
+	             "ORDER BY c.table_name, c.ordinal_position";
+	auto response = BigQueryRunQuery(execution_project, query, service_account_json);
+
+	vector<pair<string, BQTableMetadata>> tables;
+	vector<pair<int64_t, string>> key_columns;
+	vector<pair<int64_t, string>> clustering_columns;
+	bool needs_details = false;
+	// the tables whose metadata is read with tables.get after the query
+	vector<idx_t> detail_tables;
+	auto finish_table = [&]() {
+		if (tables.empty()) {
+			return;
+		}
+		auto &table = tables.back();
+		std::sort(key_columns.begin(), key_columns.end());
+		for (auto &key_column : key_columns) {
+			table.second.primary_key.push_back(std::move(key_column.second));
+		}
+		key_columns.clear();
+		std::sort(clustering_columns.begin(), clustering_columns.end());
+		for (auto &clustering_column : clustering_columns) {
+			table.second.clustering_fields.push_back(std::move(clustering_column.second));
+		}
+		clustering_columns.clear();
+		if (needs_details) {
+			// partitioning and the source files of external tables are only described by tables.get
+			detail_tables.push_back(tables.size() - 1);
+		}
+		needs_details = false;
+	};
+	for (auto &row : response["rows"]) {
+		auto &fields = row["f"];
+		auto table_name = fields[0]["v"].get<std::string>();
+		if (tables.empty() || tables.back().first != table_name) {
+			finish_table();
+			BQTableMetadata table_metadata;
+			auto table_type = fields[1]["v"].get<std::string>();
+			// INFORMATION_SCHEMA spells the types differently than tables.get
+			if (table_type == "BASE TABLE") {
+				table_metadata.table_type = "TABLE";
+			} else if (table_type == "MATERIALIZED VIEW") {
+				table_metadata.table_type = "MATERIALIZED_VIEW";
+			} else {
+				table_metadata.table_type = table_type;
+			}
+			if (!fields[5]["v"].is_null()) {
+				table_metadata.num_rows = std::stoull(fields[5]["v"].get<std::string>());
+			}
+			if (!fields[6]["v"].is_null()) {
+				table_metadata.num_bytes = std::stoull(fields[6]["v"].get<std::string>());
+			}
+			if (!fields[7]["v"].is_null()) {
+				table_metadata.last_modified_time = fields[7]["v"].get<std::string>();
+			}
+			needs_details = table_metadata.table_type == "EXTERNAL";
+			tables.emplace_back(std::move(table_name), std::move(table_metadata));
+		}
+		auto column_name = fields[2]["v"].get<std::string>();
+		auto column_type = SQLTypeToLogicalType(fields[3]["v"].get<std::string>());
+		if (fields[4]["v"].get<std::string>() == "YES") {
+			needs_details = true;
+		}
+		if (!fields[8]["v"].is_null()) {
+			key_columns.emplace_back(std::stoll(fields[8]["v"].get<std::string>()), column_name);
+		}
+		if (!fields[9]["v"].is_null()) {
+			clustering_columns.emplace_back(std::stoll(fields[9]["v"].get<std::string>()), column_name);
+		}
+		tables.back().second.columns.emplace_back(std::move(column_name), std::move(column_type));
+	}
+	finish_table();
+
+	// a dataset with many partitioned tables would otherwise take a round trip per table
+	std::atomic<idx_t> next_table {0};
+	std::mutex error_lock;
+	std::exception_ptr error;
+	auto read_details = [&]() {
+		try {
+			for (auto i = next_table++; i < detail_tables.size(); i = next_table++) {
+				auto &table = tables[detail_tables[i]];
+				table.second = BigQueryReadTableMetadata(execution_project, storage_project, dataset, table.first,
+				                                         service_account_json);
+			}
+		} catch (...) {
+			std::lock_guard<std::mutex> guard(error_lock);
+			if (!error) {
+				error = std::current_exception();
+			}
+			next_table = detail_tables.size();
+		}
+	};
+	vector<std::thread> workers;
+	auto worker_count = MinValue<idx_t>(detail_tables.size(), TABLE_DETAILS_PARALLELISM);
+	for (idx_t i = 1; i < worker_count; i++) {
+		workers.emplace_back(read_details);
+	}
+	read_details();
+	for (auto &worker : workers) {
+		worker.join();
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+
+	vector<unique_ptr<BigQueryTableEntry>> result;
+	for (auto &table : tables) {
+		if (table.second.columns.empty()) {
+			// the tables.get request of a partitioned or external table failed. The table is still listed, and is
+			// resolved on its own when it is bound.
+			BigQueryTableInfo table_info(dataset, table.first);
+			auto table_entry = make_uniq<BigQueryTableEntry>(catalog, schema_entry, table_info);
+			table_entry->resolved = false;
+			result.push_back(std::move(table_entry));
+			continue;
+		}
+		result.push_back(CreateTableEntryFromMetadata(catalog, schema_entry, dataset, table.first, table.second));
+	}
+	return result;
+}
+
+vector<string> BigQueryUtils::BigQueryListShardSuffixes(const string &storage_project, const string &dataset,
+                                                       const string &prefix, const string &service_account_json) {
+	vector<string> suffixes;
+	for (auto &table : BigQueryListTables(storage_project, dataset, service_account_json)) {
+		if (table.size() > prefix.size() && StringUtil::StartsWith(table, prefix)) {
+			suffixes.push_back(table.substr(prefix.size()));
+		}
+	}
+	std::sort(suffixes.begin(), suffixes.end());
+	return suffixes;
+}
+
+BQTableMetadata BigQueryUtils::BigQueryReadTableVersion(const string &storage_project, const string &dataset,
+                                                       const string &table, const string &service_account_json) {
+	auto authorization = U("Bearer ") + utility::conversions::to_string_t(GetAccessToken(service_account_json));
+	http_client client(U("https://bigquery.googleapis.com"));
+	uri_builder builder(U("/bigquery/v2/projects/"));
+	builder.append_path(storage_project);
+	builder.append_path(U("datasets"));
+	builder.append_path(dataset);
+	builder.append_path(U("tables"));
+	builder.append_path(table);
+	// a partial response without the schema
+	builder.append_query(U("fields"), U("etag,lastModifiedTime"));
+	http_request request(methods::GET);
+	request.headers().add(U("Authorization"), authorization);
+	request.set_request_uri(builder.to_uri());
+	auto response = BigQueryRequestJSON(client, request);
+	BQTableMetadata result;
+	result.etag = response.value("etag", "");
+	result.last_modified_time = response.value("lastModifiedTime", "");
+	return result;
+}
+
+vector<string> BigQueryUtils::BigQueryListDatasets(const string &storage_project,
+                                                   const string &service_account_json) {
+	auto authorization = U("Bearer ") + utility::conversions::to_string_t(GetAccessToken(service_account_json));
+	http_client client(U("https://bigquery.googleapis.com"));
+	vector<string> result;
+	string page_token;
+	do {
+		uri_builder builder(U("/bigquery/v2/projects/"));
+		builder.append_path(storage_project);
+		builder.append_path(U("datasets"));
+		builder.append_query(U("maxResults"), U("1000"));
+		if (!page_token.empty()) {
+			builder.append_query(U("pageToken"), page_token);
+		}
+		http_request request(methods::GET);
+		request.headers().add(U("Authorization"), authorization);
+		request.set_request_uri(builder.to_uri());
+		auto response = BigQueryRequestJSON(client, request);
+		if (response.contains("datasets")) {
+			for (auto &dataset : response["datasets"]) {
+				result.push_back(dataset["datasetReference"]["datasetId"].get<std::string>());
+			}
+		}
+		page_token = response.value("nextPageToken", "");
+	} while (!page_token.empty());
+	return result;
+}
+
+vector<string> BigQueryUtils::BigQueryListTables(const string &storage_project, const string &dataset,
+                                                 const string &service_account_json) {
+	auto authorization = U("Bearer ") + utility::conversions::to_string_t(GetAccessToken(service_account_json));
+	http_client client(U("https://bigquery.googleapis.com"));
+	vector<string> result;
+	string page_token;
+	do {
+		uri_builder builder(U("/bigquery/v2/projects/"));
+		builder.append_path(storage_project);
+		builder.append_path(U("datasets"));
+		builder.append_path(dataset);
+		builder.append_path(U("tables"));
+		builder.append_query(U("maxResults"), U("1000"));
+		if (!page_token.empty()) {
+			builder.append_query(U("pageToken"), page_token);
+		}
+		http_request request(methods::GET);
+		request.headers().add(U("Authorization"), authorization);
+		request.set_request_uri(builder.to_uri());
+		auto response = BigQueryRequestJSON(client, request);
+		if (response.contains("tables")) {
+			for (auto &table : response["tables"]) {
+				result.push_back(table["tableReference"]["tableId"].get<std::string>());
+			}
+		}
+		page_token = response.value("nextPageToken", "");
+	} while (!page_token.empty());
+	return result;
+}
+
+	BQTableMetadata BigQueryUtils::BigQueryReadTableMetadata(
     const std::string &execution_project,
     const std::string &storage_project,
     const std::string &dataset,
     const std::string &table,
 	const string &service_account_json) {
-    //Printer::Print("BigQueryReadColumnListForTable for execution_project: " + execution_project + " storage_project: " + storage_project + " dataset: " + dataset + " table: " + table);
+    //Printer::Print("BigQueryReadTableMetadata for execution_project: " + execution_project + " storage_project: " + storage_project + " dataset: " + dataset + " table: " + table);
 
     std::string access_token = GetAccessToken(service_account_json);
 
@@ -192,47 +617,219 @@ unique_ptr<BigQueryTableEntry> BigQueryUtils::BigQueryCreateBigQueryTableEntry(
     request.headers().add(U("Authorization"), U("Bearer ") + utility::conversions::to_string_t(access_token));
     request.set_request_uri(builder.to_uri());
 
-    pplx::task<vector<BQField>> requestTask = client.request(request)
-        .then([](http_response response) -> pplx::task<vector<BQField>> {
+    pplx::task<BQTableMetadata> requestTask = client.request(request)
+        .then([](http_response response) -> pplx::task<BQTableMetadata> {
         if (response.status_code() == status_codes::OK) {
             return response.extract_json()
-            .then([](web::json::value const& v) -> vector<BQField> {
-				auto bqFields = BigQueryUtils::ParseColumnJSONResponse(v);
-				// print bq fields
-				for (auto &field : bqFields) {
-					//Printer::Print("Field: " + field.name + " " + field.type.ToString());
-				}
-				return bqFields;
+            .then([](web::json::value const& v) -> BQTableMetadata {
+				return BigQueryUtils::ParseTableJSONResponse(v);
             });
         } else {
 			//Printer::Print("Error: " + response.to_string());
 			throw std::runtime_error("Failed to get column list for provided table, it's likely either an authentication issue or the table does not exist");
 		}
-        return pplx::task_from_result(vector<BQField>());
+        return pplx::task_from_result(BQTableMetadata());
     });
 
     // Wait for all the outstanding I/O to complete and handle any exceptions
     try {
-        auto column_list = requestTask.get();
-        return column_list;
+        return requestTask.get();
     }
     catch (const std::exception &e) {
         Printer::Print("Error: " + std::string(e.what()));
-        return vector<BQField>();
+        return BQTableMetadata();
     }
-    return vector<BQField>();
+    return BQTableMetadata();
 }
 
-vector<BQField> BigQueryUtils::ParseColumnJSONResponse(web::json::value const& v){
+BQTableMetadata BigQueryUtils::ParseTableJSONResponse(web::json::value const& v){
 
 	std::string str = v.serialize();
 	//Printer::Print("received JSON: " + str);
 	// Parse the JSON string
 	json j = json::parse(str);
-	auto schema = j["schema"];
-	//return vector<BQField>();
-	auto bcr = new BQColumnRequest(schema);
-	return bcr->ParseColumnFields();
+	BQTableMetadata result;
+	BQColumnRequest bcr(j["schema"]);
+	result.columns = bcr.ParseColumnFields();
+	result.table_type = j.value("type", "TABLE");
+	// int64 values are serialized as strings in the REST API
+	if (j.contains("numRows")) {
+		result.num_rows = std::stoull(j["numRows"].get<std::string>());
+	}
+	if (j.contains("numBytes")) {
+		result.num_bytes = std::stoull(j["numBytes"].get<std::string>());
+	}
+	if (j.contains("lastModifiedTime")) {
+		result.last_modified_time = j["lastModifiedTime"].get<std::string>();
+	}
+	result.etag = j.value("etag", "");
+	if (j.contains("tableConstraints") && j["tableConstraints"].contains("primaryKey")) {
+		for (const auto &column : j["tableConstraints"]["primaryKey"]["columns"]) {
+			result.primary_key.push_back(column.get<std::string>());
+		}
+	}
+	if (j.contains("clustering")) {
+		for (const auto &field : j["clustering"]["fields"]) {
+			result.clustering_fields.push_back(field.get<std::string>());
+		}
+	}
+	if (j.contains("timePartitioning")) {
+		auto &partitioning = j["timePartitioning"];
+		result.partition_type = partitioning.value("type", "DAY");
+		result.partition_column = partitioning.value("field", "");
+	} else if (j.contains("rangePartitioning")) {
+		auto &partitioning = j["rangePartitioning"];
+		result.partition_type = "RANGE";
+		result.partition_column = partitioning.value("field", "");
+		result.partition_range_interval = std::stoll(partitioning["range"].value("interval", "1"));
+	}
+	if (j.contains("externalDataConfiguration")) {
+		auto &external = j["externalDataConfiguration"];
+		result.external_format = external.value("sourceFormat", "");
+		if (external.contains("sourceUris")) {
+			for (const auto &uri : external["sourceUris"]) {
+				result.external_uris.push_back(uri.get<std::string>());
+			}
+		}
+		result.external_hive_partitioning = external.contains("hivePartitioningOptions");
+	}
+	return result;
+}
+
+json BigQueryUtils::BigQueryRunQuery(const string &execution_project, const string &query,
+                                     const string &service_account_json) {
+	auto authorization = U("Bearer ") + utility::conversions::to_string_t(GetAccessToken(service_account_json));
+	http_client client(U("https://bigquery.googleapis.com"));
+
+	// jobs.query returns the first page of the results, unless the job is not done before the timeout
+	json body = {{"query", query}, {"useLegacySql", false}, {"timeoutMs", 60000}};
+	uri_builder builder(U("/bigquery/v2/projects/"));
+	builder.append_path(execution_project);
+	builder.append_path(U("queries"));
+	http_request request(methods::POST);
+	request.headers().add(U("Authorization"), authorization);
+	request.set_request_uri(builder.to_uri());
+	request.set_body(body.dump(), "application/json");
+	auto response = BigQueryRequestJSON(client, request);
+
+	json result;
+	result["rows"] = json::array();
+	auto job_id = response["jobReference"]["jobId"].get<std::string>();
+	auto location = response["jobReference"].value("location", "");
+	while (true) {
+		if (response.value("jobComplete", false)) {
+			if (response.contains("schema")) {
+				result["schema"] = response["schema"];
+			}
+			if (response.contains("rows")) {
+				for (auto &row : response["rows"]) {
+					result["rows"].push_back(std::move(row));
+				}
+			}
+			if (!response.contains("pageToken")) {
+				break;
+			}
+		}
+		// jobs.getQueryResults waits for the job to complete and returns the following pages
+		uri_builder results_builder(U("/bigquery/v2/projects/"));
+		results_builder.append_path(execution_project);
+		results_builder.append_path(U("queries"));
+		results_builder.append_path(job_id);
+		results_builder.append_query(U("timeoutMs"), U("60000"));
+		if (!location.empty()) {
+			results_builder.append_query(U("location"), location);
+		}
+		if (response.contains("pageToken")) {
+			results_builder.append_query(U("pageToken"), response["pageToken"].get<std::string>());
+		}
+		http_request results_request(methods::GET);
+		results_request.headers().add(U("Authorization"), authorization);
+		results_request.set_request_uri(results_builder.to_uri());
+		response = BigQueryRequestJSON(client, results_request);
+	}
+	return result;
+}
+
+//! How long a request waits for a query job to complete. Cancellation is checked between the requests.
+static constexpr int64_t QUERY_JOB_POLL_TIMEOUT_MS = 10000;
+
+string BigQueryUtils::BigQueryRunQueryJob(const string &execution_project, const string &query,
+                                         const string &service_account_json,
+                                         optional_ptr<const std::atomic<bool>> cancelled) {
+	auto authorization = U("Bearer ") + utility::conversions::to_string_t(GetAccessToken(service_account_json));
+	http_client client(U("https://bigquery.googleapis.com"));
+
+	// no rows are returned, the result is read from the destination table. Identical queries are answered from
+	// BigQuery's own result cache without running them again.
+	json body = {{"query", query},
+	             {"useLegacySql", false},
+	             {"maxResults", 0},
+	             {"timeoutMs", QUERY_JOB_POLL_TIMEOUT_MS}};
+	uri_builder builder(U("/bigquery/v2/projects/"));
+	builder.append_path(execution_project);
+	builder.append_path(U("queries"));
+	http_request request(methods::POST);
+	request.headers().add(U("Authorization"), authorization);
+	request.set_request_uri(builder.to_uri());
+	request.set_body(body.dump(), "application/json");
+	auto response = BigQueryRequestJSON(client, request);
+
+	auto job_id = response["jobReference"]["jobId"].get<std::string>();
+	auto location = response["jobReference"].value("location", "");
+	while (!response.value("jobComplete", false)) {
+		if (cancelled && *cancelled) {
+			// nobody reads the result, stop the job instead of letting it use slots until it completes
+			uri_builder cancel_builder(U("/bigquery/v2/projects/"));
+			cancel_builder.append_path(execution_project);
+			cancel_builder.append_path(U("jobs"));
+			cancel_builder.append_path(job_id);
+			cancel_builder.append_path(U("cancel"));
+			if (!location.empty()) {
+				cancel_builder.append_query(U("location"), location);
+			}
+			http_request cancel_request(methods::POST);
+			cancel_request.headers().add(U("Authorization"), authorization);
+			cancel_request.set_request_uri(cancel_builder.to_uri());
+			try {
+				BigQueryRequestJSON(client, cancel_request);
+			} catch (std::exception &) {
+				// the job completes on its own
+			}
+			throw InterruptException();
+		}
+		uri_builder results_builder(U("/bigquery/v2/projects/"));
+		results_builder.append_path(execution_project);
+		results_builder.append_path(U("queries"));
+		results_builder.append_path(job_id);
+		results_builder.append_query(U("maxResults"), U("0"));
+		results_builder.append_query(U("timeoutMs"), std::to_string(QUERY_JOB_POLL_TIMEOUT_MS));
+		if (!location.empty()) {
+			results_builder.append_query(U("location"), location);
+		}
+		http_request results_request(methods::GET);
+		results_request.headers().add(U("Authorization"), authorization);
+		results_request.set_request_uri(results_builder.to_uri());
+		response = BigQueryRequestJSON(client, results_request);
+	}
+
+	// only the job itself names its destination table
+	uri_builder job_builder(U("/bigquery/v2/projects/"));
+	job_builder.append_path(execution_project);
+	job_builder.append_path(U("jobs"));
+	job_builder.append_path(job_id);
+	if (!location.empty()) {
+		job_builder.append_query(U("location"), location);
+	}
+	http_request job_request(methods::GET);
+	job_request.headers().add(U("Authorization"), authorization);
+	job_request.set_request_uri(job_builder.to_uri());
+	auto job = BigQueryRequestJSON(client, job_request);
+	if (job.contains("status") && job["status"].contains("errorResult")) {
+		throw IOException("BigQuery query job failed: %s", job["status"]["errorResult"].value("message", ""));
+	}
+	auto &destination = job["configuration"]["query"]["destinationTable"];
+	return "projects/" + destination["projectId"].get<std::string>() + "/datasets/" +
+	       destination["datasetId"].get<std::string>() + "/tables/" + destination["tableId"].get<std::string>();
 }
 
 Value BigQueryUtils::ValueFromArrowScalar(std::shared_ptr<arrow::Scalar> scalar) {
@@ -436,6 +1033,74 @@ Value BigQueryUtils::ValueFromArrowScalar(std::shared_ptr<arrow::Scalar> scalar)
 	}
 }
 
+Value BigQueryUtils::ValueFromArrowScalar(std::shared_ptr<arrow::Scalar> scalar, const LogicalType &type) {
+	if (!scalar->is_valid) {
+		return Value(type);
+	}
+	switch (scalar->type->id()) {
+		case arrow::Type::STRING: {
+			auto v = std::static_pointer_cast<arrow::StringScalar>(scalar)->view();
+			if (BigQueryGeography::IsGeographyType(type)) {
+				return Value::BLOB_RAW(BigQueryGeography::WKTToWKB(string_t(v.data(), static_cast<uint32_t>(v.size()))));
+			}
+			if (type.id() == LogicalTypeId::VARCHAR) {
+				// keep aliases such as JSON, casting to them would re-parse the value
+				Value result(string(v));
+				result.Reinterpret(type);
+				return result;
+			}
+			break;
+			}
+		case arrow::Type::LIST: {
+			if (type.id() != LogicalTypeId::LIST) {
+				break;
+			}
+			auto list_scalar = std::static_pointer_cast<arrow::ListScalar>(scalar);
+			auto &child_type = ListType::GetChildType(type);
+			vector<Value> values;
+			for (int64_t i = 0; i < list_scalar->value->length(); i++) {
+				auto element_scalar_result = list_scalar->value->GetScalar(i);
+				if (!element_scalar_result.ok()) {
+					throw std::runtime_error("Failed to get scalar from array element");
+				}
+				values.push_back(ValueFromArrowScalar(element_scalar_result.ValueOrDie(), child_type));
+			}
+			return Value::LIST(child_type, std::move(values));
+			}
+		case arrow::Type::STRUCT: {
+			if (type.id() != LogicalTypeId::STRUCT) {
+				break;
+			}
+			// match the fields by name: nested GEOGRAPHY/JSON fields get converted to the declared type, and
+			// subfields that were not downloaded are NULL
+			auto struct_scalar = std::static_pointer_cast<arrow::StructScalar>(scalar);
+			auto &struct_type = static_cast<const arrow::StructType &>(*struct_scalar->type);
+			child_list_t<Value> values;
+			for (auto &child : StructType::GetChildTypes(type)) {
+				auto field_idx = struct_type.GetFieldIndex(child.first);
+				if (field_idx < 0) {
+					// subfield was not selected (nested projection pushdown)
+					values.emplace_back(child.first, Value(child.second));
+					continue;
+				}
+				values.emplace_back(child.first, ValueFromArrowScalar(struct_scalar->value[field_idx], child.second));
+			}
+			return Value::STRUCT(std::move(values));
+			}
+		default:
+			break;
+	}
+	return ValueFromArrowScalar(scalar);
+}
+
+std::shared_ptr<google::cloud::bigquery_storage_v1::BigQueryReadConnection>
+BigQueryUtils::CreateReadConnection(const string &service_account_json) {
+	// the calls are authorized with the token of the REST requests, so that a scan does not mint its own
+	auto options = google::cloud::Options {}.set<google::cloud::GrpcCredentialOption>(
+	    BigQueryCredentialCache::Get().GetChannelCredentials(service_account_json));
+	return bigquery_storage::MakeBigQueryReadConnection(options);
+}
+
 std::shared_ptr<arrow::Schema> BigQueryUtils::GetArrowSchema(
     ::google::cloud::bigquery::storage::v1::ArrowSchema const& schema_in) {
   std::shared_ptr<arrow::Buffer> buffer =
@@ -452,6 +1117,87 @@ std::shared_ptr<arrow::Schema> BigQueryUtils::GetArrowSchema(
   return schema;
 }
 
+LogicalType BigQueryUtils::ArrowFieldToLogicalType(const arrow::Field &field) {
+	auto &type = *field.type();
+	switch (type.id()) {
+	case arrow::Type::INT64:
+		return LogicalType::BIGINT;
+	case arrow::Type::DOUBLE:
+		return LogicalType::DOUBLE;
+	case arrow::Type::BOOL:
+		return LogicalType::BOOLEAN;
+	case arrow::Type::DATE32:
+		return LogicalType::DATE;
+	case arrow::Type::TIMESTAMP:
+		// TIMESTAMP columns carry the UTC time zone, DATETIME columns none
+		return static_cast<const arrow::TimestampType &>(type).timezone().empty() ? LogicalType::TIMESTAMP
+		                                                                          : LogicalType::TIMESTAMP_TZ;
+	case arrow::Type::DECIMAL128:
+	case arrow::Type::DECIMAL256:
+		return BQColumnRequest::TypeToLogicalType("NUMERIC", {});
+	case arrow::Type::BINARY:
+		return LogicalType::BLOB;
+	case arrow::Type::STRING: {
+		// GEOGRAPHY and JSON arrive as text, marked with their SQL type
+		auto &metadata = field.metadata();
+		auto index = metadata ? metadata->FindKey("ARROW:extension:name") : -1;
+		if (index >= 0 && metadata->value(index) == "google:sqlType:geography") {
+			return BQColumnRequest::TypeToLogicalType("GEOGRAPHY", {});
+		}
+		if (index >= 0 && metadata->value(index) == "google:sqlType:json") {
+			return BQColumnRequest::TypeToLogicalType("JSON", {});
+		}
+		return LogicalType::VARCHAR;
+	}
+	case arrow::Type::LIST:
+		return LogicalType::LIST(ArrowFieldToLogicalType(*static_cast<const arrow::ListType &>(type).value_field()));
+	case arrow::Type::STRUCT: {
+		child_list_t<LogicalType> child_types;
+		for (auto &child : type.fields()) {
+			child_types.emplace_back(child->name(), ArrowFieldToLogicalType(*child));
+		}
+		return LogicalType::STRUCT(std::move(child_types));
+	}
+	default:
+		// TIME and the types without a DuckDB counterpart are read as strings, as with the table metadata
+		return LogicalType::VARCHAR;
+	}
+}
+
+optional_ptr<BoundColumnRefExpression> BigQueryUtils::GetStructExtractPath(Expression &expr, vector<string> &path) {
+	if (expr.type == ExpressionType::BOUND_COLUMN_REF) {
+		return &expr.Cast<BoundColumnRefExpression>();
+	}
+	if (expr.expression_class != ExpressionClass::BOUND_FUNCTION) {
+		return nullptr;
+	}
+	auto &function = expr.Cast<BoundFunctionExpression>();
+	if (function.function.name != "struct_extract" || function.children.size() != 2) {
+		return nullptr;
+	}
+	auto &struct_child = *function.children[0];
+	auto &key_child = *function.children[1];
+	if (struct_child.return_type.id() != LogicalTypeId::STRUCT || key_child.type != ExpressionType::VALUE_CONSTANT) {
+		return nullptr;
+	}
+	auto &key = key_child.Cast<BoundConstantExpression>().value;
+	if (key.IsNull() || key.type().id() != LogicalTypeId::VARCHAR) {
+		return nullptr;
+	}
+	auto column_ref = GetStructExtractPath(struct_child, path);
+	if (!column_ref) {
+		return nullptr;
+	}
+	// struct_extract is case insensitive, BigQuery wants the name as declared
+	for (auto &child : StructType::GetChildTypes(struct_child.return_type)) {
+		if (StringUtil::CIEquals(child.first, StringValue::Get(key))) {
+			path.push_back(child.first);
+			return column_ref;
+		}
+	}
+	return nullptr;
+}
+
 string BigQueryUtils::EscapeQuotes(const string &text, char quote) {
 	string result;
 	for (auto c : text) {
@@ -481,4 +1227,24 @@ string BigQueryUtils::WriteLiteral(const string &identifier) {
 	return BigQueryUtils::WriteQuoted(identifier, '\'');
 }
 
+//! How long LockFile waits for another process to release the lock
+static constexpr int64_t FILE_LOCK_TIMEOUT_MS = 10000;
+
+unique_ptr<FileHandle> BigQueryUtils::LockFile(FileSystem &fs, const string &path) {
+	auto lock_path = path + ".lock";
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(FILE_LOCK_TIMEOUT_MS);
+	while (true) {
+		try {
+			return fs.OpenFile(lock_path, FileFlags::FILE_FLAGS_WRITE | FileFlags::FILE_FLAGS_FILE_CREATE |
+			                                  FileLockType::WRITE_LOCK);
+		} catch (IOException &) {
+			// the lock is held by another process
+			if (std::chrono::steady_clock::now() >= deadline) {
+				throw;
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+}
+
 } // namespace duckdb
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// bigquery_credentials.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include <google/cloud/storage/oauth2/credentials.h>
+#include <grpcpp/security/credentials.h>
+
+namespace duckdb {
+
+//! Process-wide cache of the OAuth credentials of every service account (and of the application default
+//! credentials), shared by the REST requests and the Storage Read API connections. The credentials keep their access
+//! token until shortly before it expires; a background thread asks for the tokens in use periodically, so that they
+//! are refreshed there instead of in the middle of a query. Credentials that have been idle for an hour are dropped.
+class BigQueryCredentialCache {
+public:
+	BigQueryCredentialCache();
+
+	static BigQueryCredentialCache &Get();
+
+	//! Returns a valid access token of the service account, or of the application default credentials if the
+	//! service account is empty
+	string GetAccessToken(const string &service_account_json);
+	//! Channel credentials that authorize every call with the cached token of the service account
+	std::shared_ptr<grpc::ChannelCredentials> GetChannelCredentials(const string &service_account_json);
+
+private:
+	struct CredentialEntry {
+		std::shared_ptr<google::cloud::storage::oauth2::Credentials> credentials;
+		//! Tokens that have not been used for a while are not refreshed in the background
+		std::atomic<int64_t> last_used {0};
+	};
+
+	shared_ptr<CredentialEntry> GetEntry(const string &service_account_json);
+	static shared_ptr<CredentialEntry> CreateEntry(const string &service_account_json);
+	static string RequestAccessToken(CredentialEntry &entry);
+	void RefreshLoop();
+
+private:
+	mutex lock;
+	//! Keyed by the service account JSON, empty for the application default credentials
+	unordered_map<string, shared_ptr<CredentialEntry>> entries;
+	//! The credentials that are being created, other callers for the same key wait for them
+	unordered_map<string, std::shared_future<shared_ptr<CredentialEntry>>> pending_entries;
+};
+
+} // namespace duckdb
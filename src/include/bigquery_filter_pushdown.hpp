@@ -8,22 +8,32 @@
 
 #pragma once
 
+#include "duckdb/common/optional_idx.hpp"
 #include "duckdb/planner/table_filter.hpp"
 #include "duckdb/planner/filter/conjunction_filter.hpp"
 #include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
 
 namespace duckdb {
 
 class BigQueryFilterPushdown {
 public:
+	//! Translates the table filters into a row restriction. Filters on the local_column, a column that does not
+	//! exist in BigQuery, are skipped.
 	static string TransformFilters(const vector<column_t> &column_ids, optional_ptr<TableFilterSet> filters,
-	                               const vector<string> &names);
+	                               const vector<string> &names, optional_idx local_column = optional_idx());
+	//! Translates a filter expression on nested STRUCT fields of the scanned table (e.g. payload.country = 'FR')
+	//! into a row restriction. Returns an empty string if the expression cannot be pushed.
+	static string TransformNestedFilter(Expression &expr, LogicalGet &get, const vector<string> &names);
+	//! Renders a constant as a BigQuery literal
+	static string TransformConstant(const Value &val);
 
 private:
 	static string TransformFilter(string &column_name, TableFilter &filter);
 	static string TransformComparison(ExpressionType type);
 	static string CreateExpression(string &column_name, vector<unique_ptr<TableFilter>> &filters, string op);
-	static string TransformConstant(const Value &val);
+	static string TransformNestedColumn(Expression &expr, LogicalGet &get, const vector<string> &names);
+	static string TransformNestedConstant(Expression &expr);
 };
 
 } // namespace duckdb
@@ -0,0 +1,31 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// bigquery_geography.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include <arrow/api.h>
+
+namespace duckdb {
+
+class BigQueryGeography {
+public:
+	//! The DuckDB type GEOGRAPHY columns are exposed as: a BLOB holding little-endian WKB, aliased so that the
+	//! spatial extension picks it up as WKB_BLOB (and implicitly casts it to GEOMETRY)
+	static LogicalType GeographyType();
+	static bool IsGeographyType(const LogicalType &type);
+
+	//! Converts a single WKT string, as produced by the BigQuery Storage API, into WKB
+	static string WKTToWKB(const string_t &wkt);
+
+	//! Converts a slice of a WKT string column into WKB blobs written into the result vector
+	static void WKTColumnToWKB(const arrow::StringArray &column, idx_t offset, idx_t count, Vector &result,
+	                           idx_t result_offset);
+};
+
+} // namespace duckdb
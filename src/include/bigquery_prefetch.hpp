@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// bigquery_prefetch.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/storage/object_cache.hpp"
+#include "bigquery_scan_cache.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
+
+namespace duckdb {
+
+//! A single worker thread per database and queue that runs background jobs one after another, so that cache warming
+//! never competes with queries for DuckDB's worker threads. Metadata jobs and data downloads use separate queues, so
+//! that a long download does not hold up the revalidation of the metadata.
+class BigQueryBackgroundScheduler : public ObjectCacheEntry {
+public:
+	//! Jobs are expected to stop early once the flag is set
+	using job_function_t = std::function<void(const std::atomic<bool> &cancelled)>;
+
+	BigQueryBackgroundScheduler();
+	~BigQueryBackgroundScheduler() override;
+
+	//! Metadata jobs run in the "metadata" queue, prefetches of table data in the "download" queue
+	static shared_ptr<BigQueryBackgroundScheduler> Get(DatabaseInstance &db, const string &queue);
+
+	//! Queues a job. Failing jobs are ignored, prefetching is best effort.
+	void Schedule(const void *owner, job_function_t function);
+	//! Drops the queued jobs of the owner, and waits for its running job (if any) after asking it to stop
+	void Cancel(const void *owner);
+
+	static string ObjectType() {
+		return "bigquery_background_scheduler";
+	}
+	string GetObjectType() override {
+		return ObjectType();
+	}
+
+private:
+	struct BackgroundJob {
+		const void *owner;
+		job_function_t function;
+	};
+
+	void WorkerLoop();
+
+private:
+	mutex lock;
+	std::condition_variable job_available;
+	std::condition_variable job_finished;
+	std::deque<BackgroundJob> jobs;
+	const void *running_owner = nullptr;
+	std::atomic<bool> cancel_running;
+	bool shutdown = false;
+	std::thread worker;
+};
+
+struct BigQueryPrefetchRequest {
+	string execution_project;
+	string service_account_json;
+	//! The table, version, fields and row restriction to read
+	BigQueryScanCacheKey key;
+};
+
+class BigQueryPrefetch {
+public:
+	//! Reads the requested data into the scan cache, unless it is cached already. The data is read at a pinned
+	//! snapshot and only cached if the table still has the requested version at that snapshot.
+	static void WarmScanCache(shared_ptr<BigQueryScanCache> cache, const BigQueryPrefetchRequest &request,
+	                          const std::atomic<bool> &cancelled);
+};
+
+class BigQueryPrefetchFunction : public TableFunction {
+public:
+	BigQueryPrefetchFunction();
+};
+
+} // namespace duckdb
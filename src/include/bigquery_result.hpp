@@ -8,7 +8,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
 #include "google/cloud/bigquery/storage/v1/bigquery_read_client.h"
 #include <arrow/api.h>
 
@@ -17,6 +25,149 @@ namespace bigquery_storage_read = ::google::cloud::bigquery::storage::v1;
 
 namespace duckdb {
 
+//! Produces the Arrow record batches of a scan, e.g. from a BigQuery read stream or from the local scan cache
+class BigQueryBatchReader {
+public:
+	virtual ~BigQueryBatchReader() {
+	}
+
+	virtual std::shared_ptr<arrow::Schema> GetSchema() = 0;
+	//! Returns the next batch, or nullptr once all batches have been read
+	virtual std::shared_ptr<arrow::RecordBatch> Next() = 0;
+};
+
+//! Reads the batches of one stream of a read session
+class BigQueryStreamBatchReader : public BigQueryBatchReader {
+public:
+	BigQueryStreamBatchReader(bigquery_storage::BigQueryReadClient client,
+	                          const bigquery_storage_read::ReadSession &session, idx_t stream_idx, idx_t offset);
+
+	std::shared_ptr<arrow::Schema> GetSchema() override {
+		return schema;
+	}
+	std::shared_ptr<arrow::RecordBatch> Next() override;
+
+private:
+	bigquery_storage::BigQueryReadClient client;
+	std::shared_ptr<arrow::Schema> schema;
+	google::cloud::StreamRange<bigquery_storage_read::ReadRowsResponse> read_rows;
+	google::cloud::StreamRange<bigquery_storage_read::ReadRowsResponse>::iterator current;
+};
+
+//! Runs a number of read tasks, e.g. the streams of a session, on worker threads and hands their batches to the scan
+//! in the order in which they arrive
+class BigQueryParallelBatchReader : public BigQueryBatchReader {
+public:
+	std::shared_ptr<arrow::RecordBatch> Next() override;
+
+protected:
+	//! Starts up to parallelism workers that run the tasks first_task .. task_count - 1
+	void StartWorkers(idx_t first_task, idx_t task_count, idx_t parallelism);
+	//! Cancels and joins the workers, must be called by the destructor of the derived class
+	void StopWorkers();
+	virtual void ReadTask(idx_t task_idx) = 0;
+	//! Queues a batch of a task, returns false if the reader is being destroyed
+	bool Emit(std::shared_ptr<arrow::RecordBatch> batch);
+
+private:
+	void WorkerLoop();
+
+private:
+	std::mutex lock;
+	std::condition_variable batch_available;
+	std::condition_variable space_available;
+	std::deque<std::shared_ptr<arrow::RecordBatch>> batches;
+	idx_t next_task = 0;
+	idx_t task_count = 0;
+	idx_t running_workers = 0;
+	bool cancelled = false;
+	std::exception_ptr error;
+	vector<std::thread> workers;
+};
+
+//! Reads the shards of a wildcard table with one read session per shard, several shards at a time. Like the columns
+//! of the wildcard table, the schema is taken from the newest shard (with rows): the batches of older shards are
+//! conformed to it, with NULLs for the columns they lack, and get the shard's _TABLE_SUFFIX column added.
+class BigQueryShardedBatchReader : public BigQueryParallelBatchReader {
+public:
+	//! session_template holds the read options, its table is replaced by table_prefix + suffix for every shard. The
+	//! shards are read from the newest (sorting last) to the oldest.
+	BigQueryShardedBatchReader(bigquery_storage::BigQueryReadClient client, string parent,
+	                           const bigquery_storage_read::ReadSession &session_template, string table_prefix,
+	                           vector<string> suffixes, idx_t parallelism);
+	~BigQueryShardedBatchReader() override;
+
+	//! Returns nullptr if none of the shards has rows to read
+	std::shared_ptr<arrow::Schema> GetSchema() override {
+		return schema;
+	}
+
+protected:
+	void ReadTask(idx_t task_idx) override;
+
+private:
+	std::shared_ptr<bigquery_storage_read::ReadSession> CreateSession(idx_t shard_idx);
+	//! Restricts the selected fields of the session to the columns that the shard has
+	void SelectShardFields(bigquery_storage_read::ReadSession &shard_session);
+	std::shared_ptr<arrow::RecordBatch> ConformBatch(const arrow::RecordBatch &batch, const string &suffix);
+
+private:
+	bigquery_storage::BigQueryReadClient client;
+	string parent;
+	bigquery_storage_read::ReadSession session_template;
+	string table_prefix;
+	vector<string> suffixes;
+	std::shared_ptr<arrow::Schema> schema;
+	//! The session of the newest shard with rows, opened up front to determine the schema
+	idx_t first_shard = 0;
+	std::shared_ptr<bigquery_storage_read::ReadSession> first_session;
+};
+
+//! Reads all streams of a read session, several streams at a time
+class BigQueryMultiStreamBatchReader : public BigQueryParallelBatchReader {
+public:
+	BigQueryMultiStreamBatchReader(bigquery_storage::BigQueryReadClient client,
+	                               shared_ptr<const bigquery_storage_read::ReadSession> session,
+	                               idx_t parallelism);
+	~BigQueryMultiStreamBatchReader() override;
+
+	std::shared_ptr<arrow::Schema> GetSchema() override {
+		return schema;
+	}
+
+protected:
+	void ReadTask(idx_t task_idx) override;
+
+private:
+	bigquery_storage::BigQueryReadClient client;
+	shared_ptr<const bigquery_storage_read::ReadSession> session;
+	std::shared_ptr<arrow::Schema> schema;
+};
+
+//! Opens another reader on a background thread, e.g. one that has to create a read session first, and waits for it
+//! only when the schema or the first batch is needed. The scans of a query thereby open their sessions concurrently.
+class BigQueryAsyncBatchReader : public BigQueryBatchReader {
+public:
+	using open_function_t = std::function<unique_ptr<BigQueryBatchReader>(const std::atomic<bool> &cancelled)>;
+
+	//! open may return nullptr if there is nothing to read, its errors are thrown by GetSchema and Next. It is told
+	//! through cancelled when the reader is destroyed first, e.g. because the query was cancelled.
+	explicit BigQueryAsyncBatchReader(open_function_t open);
+	~BigQueryAsyncBatchReader() override;
+
+	//! Returns nullptr if there is nothing to read
+	std::shared_ptr<arrow::Schema> GetSchema() override;
+	std::shared_ptr<arrow::RecordBatch> Next() override;
+
+private:
+	BigQueryBatchReader *WaitForReader();
+
+private:
+	shared_ptr<std::atomic<bool>> cancelled;
+	std::future<unique_ptr<BigQueryBatchReader>> pending_reader;
+	unique_ptr<BigQueryBatchReader> reader;
+};
+
 class BigQueryResult {
 public:
 	// string execution_project;
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// bigquery_scan_cache.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/storage/object_cache.hpp"
+#include "bigquery_result.hpp"
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/api.h>
+
+namespace duckdb {
+
+struct BigQueryScanCacheKey {
+	//! projects/<project>/datasets/<dataset>/tables/<table>
+	string table;
+	//! Version of the table data (its lastModifiedTime), entries of other versions are stale
+	string version;
+	//! The selected fields of the read session, sorted
+	vector<string> fields;
+	string row_restriction;
+
+	//! Whether a result stored under this key also answers the other key, i.e. reads the same table version with
+	//! the same restriction and at least the same fields
+	bool Covers(const BigQueryScanCacheKey &other) const;
+};
+
+struct BigQueryScanCacheEntry {
+	BigQueryScanCacheKey key;
+	//! Name of the Arrow IPC file within the cache directory
+	string file_name;
+	idx_t size = 0;
+	//! Last time the entry was written or read, in milliseconds since the epoch
+	int64_t last_access = 0;
+};
+
+class BigQueryScanCache;
+
+//! Writes the batches of a scan into a new cache entry, which only becomes visible once the scan has completed
+class BigQueryScanCacheWriter {
+public:
+	BigQueryScanCacheWriter(shared_ptr<BigQueryScanCache> cache, BigQueryScanCacheKey key,
+	                        const std::shared_ptr<arrow::Schema> &schema);
+	~BigQueryScanCacheWriter();
+
+	void Append(const arrow::RecordBatch &batch);
+	void Commit();
+
+private:
+	shared_ptr<BigQueryScanCache> cache;
+	BigQueryScanCacheEntry entry;
+	string temp_path;
+	std::shared_ptr<arrow::io::FileOutputStream> file;
+	std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
+	bool committed = false;
+};
+
+//! Local cache of BigQuery scan results, stored as Arrow IPC files in a directory so that it persists across
+//! sessions. Hits are memory-mapped and served without copying.
+class BigQueryScanCache : public ObjectCacheEntry {
+public:
+	explicit BigQueryScanCache(string directory);
+
+	//! Returns the scan cache configured by bigquery_scan_cache_directory, or nullptr if caching is disabled
+	static shared_ptr<BigQueryScanCache> TryGet(ClientContext &context);
+
+	//! Opens a cached entry that contains (at least) the requested fields, or returns nullptr on a miss
+	unique_ptr<BigQueryBatchReader> TryOpen(const BigQueryScanCacheKey &key);
+
+	vector<BigQueryScanCacheEntry> GetEntries();
+	//! Removes all entries, returns the number of removed entries
+	idx_t Purge();
+
+	const string &GetDirectory() const {
+		return directory;
+	}
+	string GetPath(const string &file_name) const;
+
+	static string ObjectType() {
+		return "bigquery_scan_cache";
+	}
+	string GetObjectType() override {
+		return ObjectType();
+	}
+
+private:
+	friend class BigQueryScanCacheWriter;
+
+	void Register(BigQueryScanCacheEntry entry);
+	void LoadIndex();
+	vector<BigQueryScanCacheEntry> ReadIndex();
+	//! Merges the index on disk into the entries, must hold the index lock
+	void MergeIndex();
+	//! Merges the index of other processes sharing the directory, evicts and writes the index under the index lock
+	void SaveIndex();
+	//! Must hold the index lock
+	void WriteIndex();
+	void RemoveEntry(idx_t entry_idx);
+	void EvictEntries();
+
+private:
+	mutex lock;
+	string directory;
+	unique_ptr<FileSystem> fs;
+	vector<BigQueryScanCacheEntry> entries;
+	//! The files of the entries this process removed, which the index of other processes may still list
+	unordered_set<string> removed_files;
+	//! The total size of the cached files after which the least recently used entries are evicted
+	idx_t max_bytes = 0;
+};
+
+} // namespace duckdb
@@ -9,24 +9,58 @@
 #pragma once
 
 #include "duckdb.hpp"
+#include "duckdb/common/optional_idx.hpp"
+#include "duckdb/function/replacement_scan.hpp"
 #include "bigquery_utils.hpp"
 #include "bigquery_connection.hpp"
 
 namespace duckdb {
 class BigQueryTableEntry;
 class BigQueryTransaction;
+class Expression;
+class TableFilter;
 
 struct BigQueryScanBindData : public FunctionData {
-	explicit BigQueryScanBindData(BigQueryTableEntry &table) : table(table) {
-	}
+	//! Pins the table entry, so that it is not evicted from the catalog while the bind data references it
+	explicit BigQueryScanBindData(BigQueryTableEntry &table);
+	//! For bigquery_scan of a table that is not attached
+	BigQueryScanBindData(string execution_project, string storage_project, string dataset, string table_name,
+	                     string service_account_json);
+	~BigQueryScanBindData() override;
 
-	BigQueryTableEntry &table;
+	//! The catalog entry of the table, nullptr for bigquery_scan, which reads without a catalog and its caches
+	optional_ptr<BigQueryTableEntry> table;
+	string execution_project;
+	string storage_project;
+	string dataset;
+	string table_name;
 	vector<string> column_names;
 	vector<LogicalType> column_types;
-	idx_t limit;
-	idx_t offset;
+	idx_t limit = 0;
+	idx_t offset = 0;
 	bool has_limit = false;
 	string service_account_json = "";
+	//! Dotted paths of the STRUCT subfields that are actually used, per column id. Columns that are not in the map
+	//! are read whole.
+	unordered_map<column_t, vector<string>> selected_subfields;
+	//! Filters on nested STRUCT fields that were pushed into the scan, as BigQuery row restrictions
+	vector<string> nested_filters;
+	//! Bind-time estimates from the table metadata, used to pick the scan strategy
+	idx_t estimated_rows = 0;
+	idx_t estimated_bytes = 0;
+	//! Primary key columns of the table for late materialization, empty if it has none or the table is not
+	//! clustered on them
+	vector<string> key_columns;
+	//! For wildcard tables: the column id of _TABLE_SUFFIX, and the suffixes of the shards that are read, which are
+	//! pruned by the filters on it
+	optional_idx suffix_column;
+	vector<string> shard_suffixes;
+	//! For bigquery_scan: the read session over all columns that the bind created to learn the schema, which the
+	//! scan reuses if it reads all columns unfiltered, and the snapshot it reads. Both only apply to the query that
+	//! bound the scan, a prepared statement that is executed later creates a new session at the current snapshot.
+	shared_ptr<const google::cloud::bigquery::storage::v1::ReadSession> bind_session;
+	timestamp_t snapshot_time;
+	idx_t bind_query = 0;
 
 public:
 	unique_ptr<FunctionData> Copy() const override {
@@ -40,6 +74,20 @@ public:
 class BigQueryScanFunction : public TableFunction {
 public:
 	BigQueryScanFunction();
+
+	//! Whether the table cache and the scan cache can store the result of the scan, i.e. it reads all matching rows
+	static bool CanCacheResult(const BigQueryScanBindData &bind_data);
+	//! Whether a shard with the given _TABLE_SUFFIX passes a table filter on the suffix column
+	static bool SuffixMatchesFilter(const TableFilter &filter, const Value &suffix);
+	//! Removes the shards of a wildcard table whose _TABLE_SUFFIX does not pass the filter, which references the
+	//! suffix as column 0
+	static void PruneShards(ClientContext &context, Expression &filter, BigQueryScanBindData &bind_data);
+	//! Splits 'bq://project.dataset.table' into its parts. Returns false if the name is not a bq:// URL, and throws if
+	//! it is not a valid one.
+	static bool ParseTableURL(const string &url, string &project, string &dataset, string &table);
+	//! Reads 'bq://project.dataset.table' with bigquery_scan
+	static unique_ptr<TableRef> ReplacementScan(ClientContext &context, ReplacementScanInput &input,
+	                                            optional_ptr<ReplacementScanData> data);
 };
 
 class BigQueryClearCacheFunction : public TableFunction {
@@ -49,6 +97,18 @@ public:
 	static void ClearCacheOnSetting(ClientContext &context, SetScope scope, Value &parameter);
 };
 
+//! Lists the entries of the local scan cache
+class BigQueryScanCacheFunction : public TableFunction {
+public:
+	BigQueryScanCacheFunction();
+};
+
+//! Reports the number of cached table entries and their estimated memory use per BigQuery database
+class BigQueryCatalogMemoryFunction : public TableFunction {
+public:
+	BigQueryCatalogMemoryFunction();
+};
+
 class BigQueryExecuteFunction : public TableFunction {
 public:
 	BigQueryExecuteFunction();
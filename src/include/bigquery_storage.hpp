@@ -17,4 +17,8 @@ public:
 	BigQueryStorageExtension();
 };
 
+//! Returns the service account of the named BigQuery secret, or of the unnamed default secret if no name is given.
+//! Empty if there is no default secret, in which case the application default credentials are used.
+string GetServiceAccountJSON(ClientContext &context, const string &secret_name);
+
 } // namespace duckdb
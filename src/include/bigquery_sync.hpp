@@ -0,0 +1,37 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// bigquery_sync.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+//! The partitioning of a synced table
+struct BigQueryPartitioning {
+	//! DAY, HOUR, MONTH, YEAR or RANGE
+	string type;
+	//! Empty for ingestion time partitioning
+	string column;
+	LogicalType column_type;
+	int64_t range_interval = 0;
+};
+
+//! bigquery_sync(source_table, local_table) incrementally mirrors a BigQuery table into a local table, re-reading
+//! only the partitions that changed since the previous sync
+class BigQuerySyncFunction : public TableFunction {
+public:
+	BigQuerySyncFunction();
+
+	//! Renders a DuckDB predicate that selects the rows of one BigQuery partition, given the ids of all partitions of
+	//! the table. Returns false if the partition cannot be expressed as a filter on the partitioning column.
+	static bool PartitionPredicate(const BigQueryPartitioning &partitioning, const string &partition_id,
+	                               const vector<string> &partition_ids, string &predicate);
+};
+
+} // namespace duckdb
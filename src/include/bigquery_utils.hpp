@@ -13,6 +13,7 @@
 #include <arrow/api.h>
 #include <nlohmann/json.hpp>
 #include <cpprest/http_client.h>
+#include <atomic>
 
 using json = nlohmann::json;
 using namespace web::http;
@@ -24,6 +25,8 @@ class BigQuerySchemaEntry;
 class BigQueryTableEntry;
 class BigQueryTransaction;
 class BigQueryResult;
+class Expression;
+class BoundColumnRefExpression;
 
 class BQField {
 public:
@@ -34,6 +37,37 @@ public:
 	LogicalType type;
 };
 
+struct BQTableMetadata {
+	vector<BQField> columns;
+	//! TABLE, VIEW, MATERIALIZED_VIEW, EXTERNAL or SNAPSHOT
+	string table_type;
+	idx_t num_rows = 0;
+	idx_t num_bytes = 0;
+	//! Milliseconds since the epoch, as a string
+	string last_modified_time;
+	//! Changes with every change of the table's data or metadata, empty if the metadata was not read by tables.get
+	string etag;
+	//! Columns of the table's primary key constraint, which BigQuery does not enforce
+	vector<string> primary_key;
+	//! Columns the table is clustered on, in clustering order
+	vector<string> clustering_fields;
+	//! Partitioning of the table: DAY, HOUR, MONTH or YEAR for time partitioning, RANGE for integer range
+	//! partitioning and empty if the table is not partitioned
+	string partition_type;
+	//! The partitioning column, empty for ingestion time partitioning
+	string partition_column;
+	//! The width of the partitions of integer range partitioning
+	int64_t partition_range_interval = 0;
+	//! For external tables: the format (PARQUET, ORC, CSV, ...) and the URIs of the source files, and whether the
+	//! files are laid out with hive partitioning
+	string external_format;
+	vector<string> external_uris;
+	bool external_hive_partitioning = false;
+};
+
+//! The virtual column of wildcard tables that holds the part of the table name matched by the wildcard
+static constexpr const char *WILDCARD_SUFFIX_COLUMN = "_TABLE_SUFFIX";
+
 class BigQueryUtils {
 public:
 
@@ -47,7 +81,46 @@ public:
 	const string &service_account_json
 	);
 
-	static vector<BQField> BigQueryReadColumnListForTable(
+	//! Creates a table entry from metadata that was already fetched, the columns are moved out of the metadata
+	static unique_ptr<BigQueryTableEntry> CreateTableEntryFromMetadata(Catalog &catalog,
+	                                                                   BigQuerySchemaEntry &schema_entry,
+	                                                                   const string &dataset, const string &table,
+	                                                                   BQTableMetadata &table_metadata);
+
+	//! Creates the entry of a wildcard table such as "events_*", which unions all tables of the dataset with the
+	//! given prefix. Returns nullptr if no table matches.
+	static unique_ptr<BigQueryTableEntry> BigQueryCreateWildcardTableEntry(Catalog &catalog,
+	                                                                       BigQuerySchemaEntry &schema_entry,
+	                                                                       const string &execution_project,
+	                                                                       const string &storage_project,
+	                                                                       const string &dataset,
+	                                                                       const string &pattern,
+	                                                                       const string &service_account_json);
+
+	//! Creates the entries of all tables and views of a dataset from a single INFORMATION_SCHEMA query. Tables whose
+	//! details could not be read get an unresolved entry.
+	static vector<unique_ptr<BigQueryTableEntry>> BigQueryCreateDatasetTableEntries(Catalog &catalog,
+	                                                                                BigQuerySchemaEntry &schema_entry,
+	                                                                                const string &execution_project,
+	                                                                                const string &storage_project,
+	                                                                                const string &dataset,
+	                                                                                const string &service_account_json);
+
+	//! Returns the names of all datasets in the project
+	static vector<string> BigQueryListDatasets(const string &storage_project, const string &service_account_json);
+	//! Returns the names of all tables and views in the dataset
+	static vector<string> BigQueryListTables(const string &storage_project, const string &dataset,
+	                                         const string &service_account_json);
+	//! Returns the sorted suffixes of the tables of the dataset that start with the prefix, i.e. the shards of the
+	//! wildcard table "<prefix>*"
+	static vector<string> BigQueryListShardSuffixes(const string &storage_project, const string &dataset,
+	                                                const string &prefix, const string &service_account_json);
+
+	//! Reads just the etag and the last modification time of a table, which is much cheaper than its metadata
+	static BQTableMetadata BigQueryReadTableVersion(const string &storage_project, const string &dataset,
+	                                                const string &table, const string &service_account_json);
+
+	static BQTableMetadata BigQueryReadTableMetadata(
 	const string &execution_project,
 	const string &storage_project,
 	const string &dataset,
@@ -55,9 +128,18 @@ public:
 	const string &service_account_json);
 
   	static Value ValueFromArrowScalar(std::shared_ptr<arrow::Scalar> scalar);
+	//! Converts the scalar into a value of the given DuckDB type, recursing into STRUCT/LIST children
+	static Value ValueFromArrowScalar(std::shared_ptr<arrow::Scalar> scalar, const LogicalType &type);
 
   	static std::shared_ptr<arrow::Schema> GetArrowSchema(
     ::google::cloud::bigquery::storage::v1::ArrowSchema const& schema_in);
+	//! The DuckDB type of a column of a read session, the same type the table metadata gives the column
+	static LogicalType ArrowFieldToLogicalType(const arrow::Field &field);
+
+	//! Creates a Storage Read API connection, using the service account if one is given and the application default
+	//! credentials otherwise. The access token is shared with the REST requests through BigQueryCredentialCache.
+	static std::shared_ptr<google::cloud::bigquery_storage_v1::BigQueryReadConnection> CreateReadConnection(
+	    const string &service_account_json);
 
 	//static BigQueryConnectionParameters ParseConnectionParameters(const string &dsn);
 	//static BIGQUERY *Connect(const string &dsn);
@@ -65,14 +147,37 @@ public:
 	//static LogicalType ToBigQueryType(const LogicalType &input);
 	//static LogicalType FieldToLogicalType(ClientContext &context, BIGQUERY_FIELD *field);
 	//static string TypeToString(const LogicalType &input);
-	static vector<BQField> ParseColumnJSONResponse(web::json::value const& v);
+	static BQTableMetadata ParseTableJSONResponse(web::json::value const& v);
+	//! Converts a type as written in SQL, e.g. "ARRAY<STRUCT<a INT64, b STRING>>", into a DuckDB type
+	static LogicalType SQLTypeToLogicalType(const string &sql_type);
+	//! The inverse of SQLTypeToLogicalType for the types it produces
+	static string LogicalTypeToSQLType(const LogicalType &type);
+
+	//! Runs a (standard SQL) query job and waits for it, returns the result schema and all rows in the format of
+	//! the REST API
+	static json BigQueryRunQuery(const string &execution_project, const string &query,
+	                             const string &service_account_json);
+	//! Runs a query job without fetching its result, returns the (temporary) destination table that holds the result
+	//! as "projects/<p>/datasets/<d>/tables/<t>", which can be read with the Storage Read API. If cancelled is set
+	//! while the job runs, the job is cancelled and an InterruptException is thrown.
+	static string BigQueryRunQueryJob(const string &execution_project, const string &query,
+	                                  const string &service_account_json,
+	                                  optional_ptr<const std::atomic<bool>> cancelled = nullptr);
 	//static LogicalType TypeToLogicalType(const std::string &bq_type, std::vector<BQField> subfields);
 	//static vector<BQField> ParseColumnFields(const json& schema);
 
+	//! Unwinds a chain of struct_extract calls with constant keys, e.g. struct_extract(struct_extract(col, 'a'), 'b'),
+	//! returning the column at the bottom of the chain and filling in the path (a, b)
+	static optional_ptr<BoundColumnRefExpression> GetStructExtractPath(Expression &expr, vector<string> &path);
+
 	static string WriteIdentifier(const string &identifier);
 	static string WriteLiteral(const string &identifier);
 	static string EscapeQuotes(const string &text, char quote);
 	static string WriteQuoted(const string &text, char quote);
+
+	//! Takes an exclusive lock on "<path>.lock", which guards the read-modify-write cycles of a file that several
+	//! processes share. Waits for other processes holding the lock, the lock is released when the handle is closed.
+	static unique_ptr<FileHandle> LockFile(FileSystem &fs, const string &path);
 };
 
 } // namespace duckdb
@@ -12,9 +12,17 @@
 #include "duckdb/common/enums/access_mode.hpp"
 #include "bigquery_connection.hpp"
 #include "storage/bigquery_schema_set.hpp"
+#include "storage/bigquery_metadata_cache.hpp"
+#include "storage/bigquery_read_session_cache.hpp"
+#include "storage/bigquery_shared_scan.hpp"
+#include "storage/bigquery_table_cache.hpp"
+#include "storage/bigquery_view_cache.hpp"
 
 namespace duckdb {
 class BigQuerySchemaEntry;
+class BigQueryTableEntry;
+class BigQueryTableSet;
+class BigQueryBackgroundScheduler;
 
 class BigQueryCatalog : public Catalog {
 public:
@@ -28,6 +36,8 @@ public:
 	string execution_project;
 	string storage_project;
 	string service_account_json;
+	//! The estimated memory used by the cached catalog entries, maintained by the catalog sets
+	std::atomic<idx_t> memory_usage {0};
 
 public:
 	void Initialize(bool load_builtin) override;
@@ -62,11 +72,77 @@ public:
 
 	void ClearCache();
 
+	BigQueryTableCache &GetTableCache() {
+		return table_cache;
+	}
+	BigQueryReadSessionCache &GetReadSessionCache() {
+		return read_session_cache;
+	}
+	BigQuerySharedScans &GetSharedScans() {
+		return shared_scans;
+	}
+	BigQueryViewCache &GetViewCache() {
+		return view_cache;
+	}
+	//! Returns nullptr if the metadata cache file is disabled
+	optional_ptr<BigQueryMetadataCache> GetMetadataCache() {
+		return metadata_cache.get();
+	}
+
+	//! Restores the table entries kept in the metadata cache file and revalidates them in the background
+	void LoadMetadataCache(ClientContext &context);
+
+	//! Lists the tables of every dataset whose tables are not known yet, without fetching their columns
+	void ListTables(ClientContext &context);
+	//! Returns the entry of a dataset, creating it without listing the datasets
+	BigQuerySchemaEntry &GetLoadedSchema(const string &dataset);
+	//! Loads the metadata of all tables of the dataset in the background, so that binding a single table does not
+	//! wait for it. Returns false if bigquery_load_dataset_metadata is disabled.
+	bool LoadDatasetInBackground(ClientContext &context, const string &dataset);
+	//! Fetches the metadata of a table if it is not cached yet, without requiring a client context
+	optional_ptr<BigQueryTableEntry> PreloadTable(const string &dataset, const string &table);
+	//! Checks in the background whether the table changed if its entry is older than bigquery_metadata_ttl, and
+	//! replaces the entry if it did. The entry keeps being used until then.
+	void RevalidateTable(ClientContext &context, BigQueryTableEntry &table_entry);
+	//! Drops the cached metadata of a table, e.g. after writing to it, so that the next query reads it again
+	void InvalidateTable(const string &dataset, const string &table);
+	//! Evicts the least recently used table entries that no query references, until the entries of all attached
+	//! BigQuery databases fit into bigquery_catalog_max_bytes. Evicted tables are looked up again when they are bound.
+	static void EnforceMemoryLimit(ClientContext &context);
+	//! Calls the callback for every cached table entry
+	void ScanTables(const std::function<void(BigQueryTableEntry &)> &callback);
+	//! Warms the metadata and the scan cache of the given "dataset.table" names in the background
+	void PrefetchHotTables(ClientContext &context, const vector<string> &hot_tables);
+	//! The queue of the background downloads of table data of this catalog, whose jobs are cancelled when it is
+	//! detached
+	BigQueryBackgroundScheduler &GetDownloadScheduler(ClientContext &context);
+
 private:
 	void DropSchema(ClientContext &context, DropInfo &info) override;
+	BigQueryBackgroundScheduler &GetBackgroundScheduler(ClientContext &context);
+	//! Returns the table set of a dataset whose entry exists, without creating it
+	optional_ptr<BigQueryTableSet> GetLoadedTableSet(const string &dataset);
+	//! Lets the next bind revalidate the table again, after its revalidation failed
+	void ResetRevalidation(const string &dataset, const string &table);
 
 private:
 	BigQuerySchemaSet schemas;
+	//! Decoded scan results of hot tables
+	BigQueryTableCache table_cache;
+	//! Read sessions that can be reused by later scans while they have not expired
+	BigQueryReadSessionCache read_session_cache;
+	//! Scans that are in flight and can be joined by concurrent scans of the same data
+	BigQuerySharedScans shared_scans;
+	//! Results of the query jobs that read views
+	BigQueryViewCache view_cache;
+	mutex list_lock;
+	//! Keeps the table metadata across processes, if enabled
+	unique_ptr<BigQueryMetadataCache> metadata_cache;
+	mutex scheduler_lock;
+	//! Run the background metadata jobs and the background downloads of this catalog, which are cancelled when it
+	//! is detached
+	shared_ptr<BigQueryBackgroundScheduler> background_scheduler;
+	shared_ptr<BigQueryBackgroundScheduler> download_scheduler;
 };
 
 } // namespace duckdb
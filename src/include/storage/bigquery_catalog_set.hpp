@@ -12,6 +12,9 @@
 #include "duckdb/common/case_insensitive_map.hpp"
 #include "duckdb/common/mutex.hpp"
 
+#include <atomic>
+#include <future>
+
 namespace duckdb {
 struct DropInfo;
 class BigQuerySchemaEntry;
@@ -20,25 +23,78 @@ class BigQueryTransaction;
 class BigQueryCatalogSet {
 public:
 	BigQueryCatalogSet(Catalog &catalog);
+	virtual ~BigQueryCatalogSet();
 
 	optional_ptr<CatalogEntry> GetEntry(ClientContext &context, const string &name);
+	//! Looks up an entry without loading the set, for use outside of a client context
+	optional_ptr<CatalogEntry> GetLoadedEntry(const string &name);
 	virtual void DropEntry(ClientContext &context, DropInfo &info);
 	void Scan(ClientContext &context, const std::function<void(CatalogEntry &)> &callback);
+	//! Adds the entry to the set. If an entry with the same name was added concurrently, that entry is returned.
 	virtual optional_ptr<CatalogEntry> CreateEntry(unique_ptr<CatalogEntry> entry);
-	void ClearEntries();
+	//! Adds the entry to the set, replacing an entry with the same name. The replaced entry stays alive, as it may
+	//! still be referenced by queries that are being bound.
+	virtual optional_ptr<CatalogEntry> ReplaceEntry(unique_ptr<CatalogEntry> entry);
+	//! Returns the entry with the given name if is_complete accepts it, and otherwise adds (or replaces it with) the
+	//! entry created by load. Concurrent calls for the same name wait for the load that is in flight instead of
+	//! loading the entry again. load may return nullptr if there is no such entry.
+	optional_ptr<CatalogEntry> LoadEntry(const string &name, const std::function<unique_ptr<CatalogEntry>()> &load,
+	                                     const std::function<bool(CatalogEntry &)> &is_complete);
+	//! Removes an entry from the lookup, so that it is loaded again when it is bound next. The entry stays alive, as
+	//! it may still be referenced by queries that are being bound.
+	void RetireEntry(const string &name);
+	//! Scans the entries without loading the set
+	void ScanLoaded(const std::function<void(CatalogEntry &)> &callback);
+	//! Removes all entries, so that they are loaded again. The entries for which is_pinned returns true, e.g. because
+	//! queries still reference them, stay alive as replaced entries until they are cleared again. is_pinned is called
+	//! with the set locked.
+	void ClearEntries(const std::function<bool(CatalogEntry &)> &is_pinned);
+	//! Whether the set holds no entries, including replaced entries
+	bool IsEmpty();
+	//! Skips loading the entries, e.g. because they were restored from the metadata cache file
+	void MarkLoaded() {
+		is_loaded = true;
+	}
+	bool IsLoaded() const {
+		return is_loaded;
+	}
+	//! Frees the entries for which evict returns true, including replaced entries that are no longer looked up.
+	//! evict is called with the set locked. Returns the names of the freed entries that were not replaced.
+	vector<string> EvictEntries(const std::function<bool(CatalogEntry &entry, bool replaced)> &evict);
 
 protected:
 	virtual void LoadEntries(ClientContext &context) = 0;
+	//! The estimated memory used by an entry, which is accounted to the catalog
+	virtual idx_t GetEntrySize(CatalogEntry &entry) {
+		return 0;
+	}
+	//! Called with the set locked whenever an entry is looked up or added
+	virtual void TouchEntry(CatalogEntry &entry) {
+	}
+	//! Loads the entries once, concurrent callers wait until they are loaded
+	void TryLoadEntries(ClientContext &context);
+	//! Loads the entries once with the given function, e.g. from a background job that has no client context
+	void TryLoadEntries(const std::function<void()> &load);
 
 	void EraseEntryInternal(const string &name);
 
 protected:
 	Catalog &catalog;
 
+private:
+	void AddMemoryUsage(CatalogEntry &entry);
+	void RemoveMemoryUsage(CatalogEntry &entry);
+
 private:
 	mutex entry_lock;
 	case_insensitive_map_t<unique_ptr<CatalogEntry>> entries;
-	bool is_loaded;
+	vector<unique_ptr<CatalogEntry>> replaced_entries;
+	//! The entries that are being loaded by LoadEntry
+	case_insensitive_map_t<std::shared_future<optional_ptr<CatalogEntry>>> pending_entries;
+	mutex load_lock;
+	std::atomic<bool> is_loaded;
+	//! The estimated memory used by the entries of this set, including the replaced entries
+	idx_t memory_usage = 0;
 };
 
 class BigQueryInSchemaSet : public BigQueryCatalogSet {
@@ -46,6 +102,7 @@ public:
 	BigQueryInSchemaSet(BigQuerySchemaEntry &schema);
 
 	optional_ptr<CatalogEntry> CreateEntry(unique_ptr<CatalogEntry> entry) override;
+	optional_ptr<CatalogEntry> ReplaceEntry(unique_ptr<CatalogEntry> entry) override;
 
 protected:
 	BigQuerySchemaEntry &schema;
@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// storage/bigquery_metadata_cache.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "bigquery_utils.hpp"
+
+namespace duckdb {
+class BigQueryTableEntry;
+
+struct BigQueryCachedTable {
+	string dataset;
+	string table;
+	BQTableMetadata metadata;
+};
+
+//! Keeps the table metadata of a project in a local JSON file, so that later processes can bind queries without
+//! fetching the metadata first. Several projects can share the file.
+class BigQueryMetadataCache {
+public:
+	BigQueryMetadataCache(string path, string project);
+
+	//! Reads the tables of the project from the file
+	vector<BigQueryCachedTable> Load();
+	void Put(const string &dataset, const BigQueryTableEntry &table_entry);
+	void Clear();
+	//! Writes the tables that were put since the last write to the file, keeping the other tables of the project
+	void Flush();
+
+	//! The bigquery_metadata_cache_path setting, empty if the cache is disabled
+	static string GetPath(ClientContext &context);
+
+private:
+	mutex lock;
+	string path;
+	string project;
+	//! The serialized tables that were put since the last write, keyed by "dataset.table"
+	nlohmann::json put_tables;
+	//! Whether the tables of the project are dropped from the file on the next write
+	bool cleared = false;
+	bool dirty = false;
+};
+
+} // namespace duckdb
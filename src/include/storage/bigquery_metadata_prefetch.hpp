@@ -0,0 +1,38 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// storage/bigquery_metadata_prefetch.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb/main/client_context_state.hpp"
+
+namespace duckdb {
+class BigQueryCatalog;
+
+//! A BigQuery table referenced by a statement, whose metadata is resolved before the statement is bound
+struct BigQueryTableReference {
+	BigQueryCatalog &catalog;
+	string dataset;
+	string table;
+};
+
+//! Resolves the metadata of all BigQuery tables referenced by a query concurrently when the query begins, so that the
+//! binder, which looks up the tables one at a time, finds them cached
+class BigQueryMetadataPrefetch : public ClientContextState {
+public:
+	void QueryBegin(ClientContext &context) override;
+
+	//! Registers the prefetch with the client context, if it is not registered yet
+	static void Register(ClientContext &context);
+	//! Returns the BigQuery tables referenced by the given query, or nothing if it cannot be parsed
+	static vector<BigQueryTableReference> GetTableReferences(ClientContext &context, const string &query);
+	//! Fetches the metadata of the tables that are not cached yet concurrently, ignoring errors, which the binder
+	//! reports when it looks up the table
+	static void ResolveTables(const vector<BigQueryTableReference> &tables);
+};
+
+} // namespace duckdb
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// storage/bigquery_read_session_cache.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "bigquery_result.hpp"
+#include "bigquery_scan_cache.hpp"
+
+namespace duckdb {
+
+struct BigQueryReadSessionCacheEntry {
+	BigQueryScanCacheKey key;
+	shared_ptr<const bigquery_storage_read::ReadSession> session;
+	//! When BigQuery expires the session, in milliseconds since the epoch
+	int64_t expire_time = 0;
+	int64_t last_access = 0;
+};
+
+//! Keeps the read sessions of a BigQuery catalog alive across queries, so that repeated scans of the same table,
+//! e.g. pages of a result read with OFFSET, skip creating a new session
+class BigQueryReadSessionCache {
+public:
+	//! Whether sessions are reused through bigquery_read_session_cache
+	static bool IsEnabled(ClientContext &context);
+
+	//! Returns a live session that reads the same table version and restriction with at least the key's fields. The
+	//! version of the key may be outdated, the session is only returned if the table has not changed since.
+	shared_ptr<const bigquery_storage_read::ReadSession> TryGet(const BigQueryScanCacheKey &key,
+	                                                            const string &service_account_json);
+	void Put(const BigQueryScanCacheKey &key, shared_ptr<const bigquery_storage_read::ReadSession> session);
+	void Clear();
+
+private:
+	shared_ptr<const bigquery_storage_read::ReadSession> TryGetEntry(const BigQueryScanCacheKey &key);
+
+private:
+	mutex lock;
+	vector<BigQueryReadSessionCacheEntry> entries;
+};
+
+} // namespace duckdb
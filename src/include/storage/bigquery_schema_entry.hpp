@@ -42,6 +42,14 @@ public:
 	void DropEntry(ClientContext &context, DropInfo &info) override;
 	optional_ptr<CatalogEntry> GetEntry(CatalogTransaction transaction, CatalogType type, const string &name) override;
 
+	//! Fetches the metadata of a table if it is not cached yet (or only loaded from the metadata cache file), without
+	//! requiring a client context
+	optional_ptr<BigQueryTableEntry> PreloadTable(const string &name);
+
+	BigQueryTableSet &GetTableSet() {
+		return tables;
+	}
+
 private:
 	void AlterTable(BigQueryTransaction &transaction, RenameTableInfo &info);
 	void AlterTable(BigQueryTransaction &transaction, RenameColumnInfo &info);
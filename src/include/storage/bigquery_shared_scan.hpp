@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// storage/bigquery_shared_scan.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_map.hpp"
+#include "bigquery_result.hpp"
+#include "bigquery_scan_cache.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <deque>
+
+namespace duckdb {
+
+//! A read session whose batches are multicast to every scan that reads the same data at the same time. Consumers
+//! that fall behind the window of buffered batches, or attach late, read from the session's stream at their own
+//! row offset until they have caught up with the window again.
+class BigQuerySharedScan {
+public:
+	//! Opens the scanned stream at a row offset
+	using open_stream_t = std::function<unique_ptr<BigQueryBatchReader>(idx_t offset)>;
+
+	explicit BigQuerySharedScan(BigQueryScanCacheKey key);
+
+	const BigQueryScanCacheKey key;
+
+	//! Called by the scan that registered the shared scan once it has opened the read session
+	void Start(bigquery_storage::BigQueryReadClient client, shared_ptr<const bigquery_storage_read::ReadSession> session);
+	//! Starts the scan with the stream that open_stream opens, which also opens the streams of the consumers that
+	//! fall behind
+	void Start(open_stream_t open_stream);
+	//! Called instead of Start if the session could not be opened or has no streams
+	void Fail();
+	//! Whether new consumers can still attach
+	bool IsJoinable();
+
+	//! Attaches a consumer that receives the batches from the first one on, or returns nullptr if the scan failed
+	static unique_ptr<BigQueryBatchReader> Attach(shared_ptr<BigQuerySharedScan> scan);
+
+private:
+	friend class BigQuerySharedScanReader;
+
+	struct Consumer {
+		//! The index of the next window batch, if the consumer is not behind
+		idx_t next_batch = 0;
+		//! The number of rows the consumer has read
+		idx_t row = 0;
+		bool behind = false;
+		//! The consumer's own stream while it is behind
+		unique_ptr<BigQueryBatchReader> reader;
+	};
+
+	std::shared_ptr<arrow::RecordBatch> Next(idx_t consumer_id);
+	//! Reads the next batch of a consumer that is behind from its own stream. Returns false without reading if the
+	//! consumer could rejoin the window instead.
+	bool CatchUp(Consumer &consumer, unique_lock<mutex> &guard, std::shared_ptr<arrow::RecordBatch> &result);
+	//! Rejoins the window if one of its batches starts in the given row range, returns the row it rejoins at
+	bool TryRejoin(Consumer &consumer, idx_t min_row, idx_t max_row, idx_t &rejoin_row);
+	void Detach(idx_t consumer_id);
+	void TrimWindow();
+
+private:
+	mutex lock;
+	std::condition_variable state_changed;
+	bool started = false;
+	bool failed = false;
+	open_stream_t open_stream;
+	std::shared_ptr<arrow::Schema> schema;
+	unique_ptr<BigQueryBatchReader> producer;
+	//! Set while a consumer reads the next batch from the producer
+	bool fetching = false;
+	bool exhausted = false;
+
+	//! The batches that have been read but not yet been consumed by every consumer
+	std::deque<std::shared_ptr<arrow::RecordBatch>> window;
+	//! The index and the first row of the first batch of the window
+	idx_t window_start = 0;
+	idx_t window_start_row = 0;
+
+	unordered_map<idx_t, Consumer> consumers;
+	idx_t next_consumer_id = 0;
+};
+
+//! The shared scans of a BigQuery catalog that are currently in flight
+class BigQuerySharedScans {
+public:
+	//! Whether scan sharing is enabled through bigquery_shared_scans
+	static bool IsEnabled(ClientContext &context);
+
+	//! Returns an in-flight scan whose results cover the key, or registers a new one that the caller has to start
+	shared_ptr<BigQuerySharedScan> GetOrCreate(const BigQueryScanCacheKey &key, bool &created);
+
+private:
+	mutex lock;
+	vector<weak_ptr<BigQuerySharedScan>> scans;
+};
+
+} // namespace duckdb
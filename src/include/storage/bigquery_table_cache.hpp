@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// storage/bigquery_table_cache.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "bigquery_scan_cache.hpp"
+
+namespace duckdb {
+
+struct BigQueryTableCacheEntry {
+	BigQueryScanCacheKey key;
+	//! The column ids of the cached columns, in the order of the collection
+	vector<column_t> column_ids;
+	//! The decoded rows, allocated through the buffer manager so that they can be spilled or evicted
+	shared_ptr<ColumnDataCollection> collection;
+	//! When the entry was created, in milliseconds since the epoch
+	int64_t created = 0;
+	//! Last time the entry was created or read, in milliseconds since the epoch
+	int64_t last_access = 0;
+};
+
+//! In-memory cache of decoded scan results of a BigQuery catalog
+class BigQueryTableCache {
+public:
+	//! Returns the TTL configured by bigquery_table_cache_ttl in milliseconds, 0 if the cache is disabled
+	static int64_t GetTTL(ClientContext &context);
+	//! Returns the size limit configured by bigquery_table_cache_max_bytes
+	static idx_t GetMaxBytes(ClientContext &context);
+
+	//! Returns an entry that answers the key and contains all of the given columns, or nullptr
+	shared_ptr<BigQueryTableCacheEntry> TryGet(const BigQueryScanCacheKey &key, const vector<column_t> &column_ids,
+	                                           int64_t ttl);
+	//! Adds an entry, evicting the least recently used entries while the cache is larger than max_bytes
+	void Put(shared_ptr<BigQueryTableCacheEntry> entry, int64_t ttl, idx_t max_bytes);
+	void Clear();
+
+private:
+	//! Removes expired entries, must hold the lock
+	void RemoveExpiredEntries(int64_t now, int64_t ttl);
+
+private:
+	mutex lock;
+	vector<shared_ptr<BigQueryTableCacheEntry>> entries;
+};
+
+} // namespace duckdb
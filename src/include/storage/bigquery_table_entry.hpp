@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "duckdb/parser/parsed_data/create_table_info.hpp"
 
@@ -45,6 +47,64 @@ public:
 
 	void BindUpdateConstraints(Binder &binder, LogicalGet &get, LogicalProjection &proj, LogicalUpdate &update,
 	                                   ClientContext &context) override;
+
+	//! Views cannot be read by the Storage Read API, they are run as query jobs whose results are read instead
+	bool IsView() const {
+		return table_type == "VIEW" || table_type == "MATERIALIZED_VIEW";
+	}
+	//! The approximate memory used by the entry, dominated by the column names and (nested) types
+	idx_t EstimateMemoryUsage() const;
+
+	//! Binds DuckDB's Parquet reader to the source files of an external table if bigquery_external_tables_direct is
+	//! set. Returns false if the table cannot be read directly, e.g. because the files cannot be read or do not match
+	//! the columns of the table.
+	static bool TryBindExternalScan(ClientContext &context, const string &external_format,
+	                                const vector<string> &external_uris, bool hive_partitioning,
+	                                const ColumnList &columns, TableFunction &function,
+	                                unique_ptr<FunctionData> &bind_data);
+
+public:
+	//! False for the entries created by listing a dataset, which have no columns yet. They are replaced by a full
+	//! entry when the table is bound.
+	bool resolved = true;
+	//! Set for entries loaded from the metadata cache file until they have been checked against BigQuery. Their
+	//! version is unknown until then, so they are not used with the version-keyed caches.
+	bool revalidate = false;
+	//! TABLE, VIEW, MATERIALIZED_VIEW, ... (see BQTableMetadata)
+	string table_type;
+	//! Table size as reported by the BigQuery metadata
+	idx_t num_rows = 0;
+	idx_t num_bytes = 0;
+	//! When the table data was last modified, in milliseconds since the epoch
+	string last_modified_time;
+	//! The etag of the table metadata, empty if it was not read by tables.get
+	string etag;
+	//! When the metadata was last fetched or found to be current, in milliseconds since the epoch
+	std::atomic<int64_t> validated_at {0};
+	//! Set while a background revalidation of the entry is scheduled
+	std::atomic<bool> revalidating {false};
+	//! When the entry was last looked up, in milliseconds since the epoch. The least recently used entries are
+	//! evicted when the catalog exceeds bigquery_catalog_max_bytes.
+	std::atomic<int64_t> last_access {0};
+	//! The number of transactions and scans that reference the entry, which keep it from being evicted
+	std::atomic<idx_t> pin_count {0};
+	//! Columns of the table's primary key constraint, if any
+	vector<string> primary_key;
+	//! Columns the table is clustered on (see BQTableMetadata)
+	vector<string> clustering_fields;
+	//! Partitioning of the table (see BQTableMetadata)
+	string partition_type;
+	string partition_column;
+	int64_t partition_range_interval = 0;
+	//! Source files of external tables (see BQTableMetadata)
+	string external_format;
+	vector<string> external_uris;
+	bool external_hive_partitioning = false;
+	//! Set for wildcard tables, which read every table named shard_prefix + suffix and expose the suffix in the
+	//! _TABLE_SUFFIX column
+	bool wildcard = false;
+	string shard_prefix;
+	vector<string> shard_suffixes;
 };
 
 } // namespace duckdb
@@ -26,12 +26,37 @@ public:
 
 	static unique_ptr<BigQueryTableInfo> GetTableInfo(ClientContext &context, BigQuerySchemaEntry &schema,
 	                                               const string &table_name);
-	optional_ptr<CatalogEntry> RefreshTable(ClientContext &context, const string &table_name);
+	//! Reads the metadata of a table again and replaces its entry. Concurrent refreshes of the table share one request.
+	optional_ptr<CatalogEntry> RefreshTable(const string &table_name);
 
 	void AlterTable(ClientContext &context, AlterTableInfo &info);
 
+	//! Records the metadata of new tables in the catalog's metadata cache file
+	optional_ptr<CatalogEntry> CreateEntry(unique_ptr<CatalogEntry> entry) override;
+	optional_ptr<CatalogEntry> ReplaceEntry(unique_ptr<CatalogEntry> entry) override;
+
+	//! Whether the names of all tables of the dataset are known
+	bool IsListed() const {
+		return is_listed;
+	}
+	//! Loads the metadata of all tables of the dataset with a single query, replacing outdated entries. Returns false
+	//! if the query failed.
+	bool LoadDatasetMetadata();
+	//! Loads the metadata of the dataset unless the set was loaded already, for use outside of a client context
+	void LoadDatasetMetadataOnce() {
+		TryLoadEntries([&]() { LoadDatasetMetadata(); });
+	}
+	//! Returns true for the first caller only, who schedules the background load of the dataset's metadata
+	bool ClaimBackgroundLoad() {
+		return !load_scheduled.exchange(true);
+	}
+	//! Adds an unresolved entry for each listed table that has no entry yet
+	void AddListedTables(const vector<string> &table_names);
+
 protected:
 	void LoadEntries(ClientContext &context) override;
+	idx_t GetEntrySize(CatalogEntry &entry) override;
+	void TouchEntry(CatalogEntry &entry) override;
 
 	void AlterTable(ClientContext &context, RenameTableInfo &info);
 	void AlterTable(ClientContext &context, RenameColumnInfo &info);
@@ -40,6 +65,10 @@ protected:
 
 	static void AddColumn(ClientContext &context, BigQueryResult &result, BigQueryTableInfo &table_info,
 	                      idx_t column_offset = 0);
+
+private:
+	std::atomic<bool> is_listed {false};
+	std::atomic<bool> load_scheduled {false};
 };
 
 } // namespace duckdb
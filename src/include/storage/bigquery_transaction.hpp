@@ -9,6 +9,8 @@
 #pragma once
 
 #include "duckdb/transaction/transaction.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/common/unordered_set.hpp"
 #include "bigquery_connection.hpp"
 
 namespace duckdb {
@@ -33,11 +35,24 @@ public:
 	AccessMode GetAccessMode() const {
 		return access_mode;
 	}
+	//! The point in time at which every read of this transaction sees the BigQuery tables, pinned on first use
+	timestamp_t GetSnapshotTime(ClientContext &context);
+	//! Whether the snapshot has been set through bigquery_snapshot_time instead of being the transaction start
+	bool IsTimeTravel() const {
+		return time_travel;
+	}
+	//! Keeps a table entry from being evicted from the catalog until the transaction ends
+	void PinTable(BigQueryTableEntry &table_entry);
 
 private:
 	//BigQueryConnection connection;
 	BigQueryTransactionState transaction_state;
 	AccessMode access_mode;
+	bool has_snapshot = false;
+	timestamp_t snapshot_time;
+	bool time_travel = false;
+	//! The table entries bound by this transaction
+	unordered_set<BigQueryTableEntry *> pinned_tables;
 };
 
 } // namespace duckdb
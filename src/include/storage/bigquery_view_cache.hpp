@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//                         DuckDB
+//
+// storage/bigquery_view_cache.hpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+
+namespace duckdb {
+
+struct BigQueryViewCacheEntry {
+	//! The destination table of the query job, as "projects/<p>/datasets/<d>/tables/<t>"
+	string destination_table;
+	//! When the job finished, in milliseconds since the epoch
+	int64_t created = 0;
+};
+
+//! Remembers the destination tables of the query jobs that read views, so that repeated scans of a view with the same
+//! projection and filters read the job result again instead of re-running the view
+class BigQueryViewCache {
+public:
+	//! Returns the destination table of the job that ran the query, or an empty string if there is none younger
+	//! than the TTL
+	string TryGet(const string &query, int64_t ttl_ms);
+	void Put(const string &query, string destination_table);
+	void Clear();
+
+	//! The bigquery_view_cache_ttl setting in milliseconds, 0 if the cache is disabled
+	static int64_t GetTTL(ClientContext &context);
+
+private:
+	mutex lock;
+	unordered_map<string, BigQueryViewCacheEntry> entries;
+};
+
+} // namespace duckdb
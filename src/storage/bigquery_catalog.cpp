@@ -1,11 +1,22 @@
 #include "storage/bigquery_catalog.hpp"
 #include "storage/bigquery_schema_entry.hpp"
 #include "storage/bigquery_transaction.hpp"
+#include "storage/bigquery_table_entry.hpp"
+#include "bigquery_prefetch.hpp"
 #include "bigquery_connection.hpp"
+#include "bigquery_utils.hpp"
 #include "duckdb/storage/database_size.hpp"
 #include "duckdb/parser/parsed_data/drop_info.hpp"
 #include "duckdb/parser/parsed_data/create_schema_info.hpp"
 #include "duckdb/main/attached_database.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/main/database_manager.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace duckdb {
 
@@ -19,7 +30,22 @@ BigQueryCatalog::BigQueryCatalog(AttachedDatabase &db_p, const string &path,
 	//auto connection = BigQueryConnection::Open(path);
 }
 
-BigQueryCatalog::~BigQueryCatalog() = default;
+BigQueryCatalog::~BigQueryCatalog() {
+	// background jobs reference this catalog. Metadata jobs schedule downloads, so they are cancelled first.
+	if (background_scheduler) {
+		background_scheduler->Cancel(this);
+	}
+	if (download_scheduler) {
+		download_scheduler->Cancel(this);
+	}
+	if (metadata_cache) {
+		try {
+			metadata_cache->Flush();
+		} catch (std::exception &) {
+			// the cache is only an optimization, failing to write it must not fail the detach
+		}
+	}
+}
 
 void BigQueryCatalog::Initialize(bool load_builtin) {
 }
@@ -44,11 +70,59 @@ void BigQueryCatalog::DropSchema(ClientContext &context, DropInfo &info) {
 }
 
 void BigQueryCatalog::ScanSchemas(ClientContext &context, std::function<void(SchemaCatalogEntry &)> callback) {
-	Printer::Print("BigQueryCatalog::ScanSchemas");
-	// TODO implement this, we don't have access to the catalog with current BQ C++ API
 	schemas.Scan(context, [&](CatalogEntry &schema) { callback(schema.Cast<BigQuerySchemaEntry>()); });
 }
 
+//! The number of datasets whose tables are listed at the same time
+static constexpr idx_t TABLE_LISTING_PARALLELISM = 16;
+
+void BigQueryCatalog::ListTables(ClientContext &context) {
+	// a concurrent listing is waited for rather than repeated
+	lock_guard<mutex> list_guard(list_lock);
+	vector<reference<BigQuerySchemaEntry>> unlisted;
+	schemas.Scan(context, [&](CatalogEntry &entry) {
+		auto &schema = entry.Cast<BigQuerySchemaEntry>();
+		if (!schema.GetTableSet().IsListed()) {
+			unlisted.push_back(schema);
+		}
+	});
+	if (unlisted.empty()) {
+		return;
+	}
+	// the listing of a project with hundreds of datasets is bound by latency, the datasets are listed concurrently
+	std::atomic<idx_t> next_schema {0};
+	std::mutex error_lock;
+	std::exception_ptr error;
+	auto list_tables = [&]() {
+		try {
+			for (auto i = next_schema++; i < unlisted.size(); i = next_schema++) {
+				auto &schema = unlisted[i].get();
+				auto table_names = BigQueryUtils::BigQueryListTables(storage_project, schema.name,
+				                                                     service_account_json);
+				schema.GetTableSet().AddListedTables(table_names);
+			}
+		} catch (...) {
+			std::lock_guard<std::mutex> guard(error_lock);
+			if (!error) {
+				error = std::current_exception();
+			}
+			next_schema = unlisted.size();
+		}
+	};
+	vector<std::thread> workers;
+	auto worker_count = MinValue<idx_t>(unlisted.size(), TABLE_LISTING_PARALLELISM);
+	for (idx_t i = 1; i < worker_count; i++) {
+		workers.emplace_back(list_tables);
+	}
+	list_tables();
+	for (auto &worker : workers) {
+		worker.join();
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
 optional_ptr<SchemaCatalogEntry> BigQueryCatalog::GetSchema(CatalogTransaction transaction,
 															const string &schema_name,
                                                          	OnEntryNotFound if_not_found,
@@ -80,6 +154,370 @@ optional_ptr<SchemaCatalogEntry> BigQueryCatalog::GetSchema(CatalogTransaction t
 	return nullptr;
 }
 
+BigQuerySchemaEntry &BigQueryCatalog::GetLoadedSchema(const string &dataset) {
+	auto schema = schemas.GetLoadedEntry(dataset);
+	if (!schema) {
+		CreateSchemaInfo schema_info;
+		schema_info.catalog = this->storage_project;
+		schema_info.schema = dataset;
+		schema = schemas.CreateEntry(make_uniq<BigQuerySchemaEntry>(*this, schema_info));
+	}
+	return schema->Cast<BigQuerySchemaEntry>();
+}
+
+optional_ptr<BigQueryTableEntry> BigQueryCatalog::PreloadTable(const string &dataset, const string &table) {
+	return GetLoadedSchema(dataset).PreloadTable(table);
+}
+
+bool BigQueryCatalog::LoadDatasetInBackground(ClientContext &context, const string &dataset) {
+	Value load_dataset_metadata;
+	if (context.TryGetCurrentSetting("bigquery_load_dataset_metadata", load_dataset_metadata) &&
+	    !BooleanValue::Get(load_dataset_metadata)) {
+		return false;
+	}
+	if (!GetLoadedSchema(dataset).GetTableSet().ClaimBackgroundLoad()) {
+		return true;
+	}
+	GetBackgroundScheduler(context).Schedule(this, [this, dataset](const std::atomic<bool> &cancelled) {
+		if (cancelled) {
+			return;
+		}
+		GetLoadedSchema(dataset).GetTableSet().LoadDatasetMetadataOnce();
+	});
+	return true;
+}
+
+void BigQueryCatalog::LoadMetadataCache(ClientContext &context) {
+	auto path = BigQueryMetadataCache::GetPath(context);
+	if (path.empty()) {
+		return;
+	}
+	metadata_cache = make_uniq<BigQueryMetadataCache>(path, storage_project);
+	auto cached_tables = metadata_cache->Load();
+	if (cached_tables.empty()) {
+		return;
+	}
+	vector<string> datasets;
+	for (auto &cached_table : cached_tables) {
+		auto &schema = GetLoadedSchema(cached_table.dataset);
+		auto &table_set = schema.GetTableSet();
+		if (std::find(datasets.begin(), datasets.end(), cached_table.dataset) == datasets.end()) {
+			// binding does not wait for the dataset's metadata, it is revalidated in the background
+			datasets.push_back(cached_table.dataset);
+			table_set.MarkLoaded();
+		}
+		auto table_entry = BigQueryUtils::CreateTableEntryFromMetadata(*this, schema, cached_table.dataset,
+		                                                               cached_table.table, cached_table.metadata);
+		table_entry->revalidate = true;
+		table_set.CreateEntry(std::move(table_entry));
+	}
+
+	Value load_dataset_metadata;
+	bool bulk_load = !context.TryGetCurrentSetting("bigquery_load_dataset_metadata", load_dataset_metadata) ||
+	                 BooleanValue::Get(load_dataset_metadata);
+	GetBackgroundScheduler(context).Schedule(this, [this, datasets, bulk_load](const std::atomic<bool> &cancelled) {
+		for (auto &dataset : datasets) {
+			if (cancelled) {
+				return;
+			}
+			auto &table_set = GetLoadedSchema(dataset).GetTableSet();
+			if (bulk_load) {
+				table_set.LoadDatasetMetadata();
+			}
+			// the tables the dataset query did not cover are fetched one by one
+			vector<string> outdated_tables;
+			table_set.ScanLoaded([&](CatalogEntry &entry) {
+				if (entry.Cast<BigQueryTableEntry>().revalidate) {
+					outdated_tables.push_back(entry.name);
+				}
+			});
+			for (auto &table : outdated_tables) {
+				if (cancelled) {
+					return;
+				}
+				PreloadTable(dataset, table);
+			}
+		}
+		metadata_cache->Flush();
+	});
+}
+
+static int64_t GetMetadataTTL(ClientContext &context) {
+	Value ttl;
+	if (!context.TryGetCurrentSetting("bigquery_metadata_ttl", ttl) || ttl.IsNull()) {
+		return 0;
+	}
+	return UBigIntValue::Get(ttl) * 1000;
+}
+
+void BigQueryCatalog::RevalidateTable(ClientContext &context, BigQueryTableEntry &table_entry) {
+	// entries restored from the metadata cache file are revalidated by LoadMetadataCache
+	if (!table_entry.resolved || table_entry.revalidate) {
+		return;
+	}
+	auto ttl_ms = GetMetadataTTL(context);
+	auto now = Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp());
+	if (ttl_ms == 0 || now - table_entry.validated_at < ttl_ms) {
+		return;
+	}
+	if (table_entry.revalidating.exchange(true)) {
+		return;
+	}
+	auto dataset = table_entry.schema.name;
+	auto table = table_entry.name;
+	if (table_entry.wildcard) {
+		// wildcard entries have no version of their own, they are recreated when shards were added or removed, e.g.
+		// the shard of a new day
+		auto prefix = table_entry.shard_prefix;
+		auto suffixes = table_entry.shard_suffixes;
+		GetBackgroundScheduler(context).Schedule(this, [this, dataset, table, prefix,
+		                                                suffixes](const std::atomic<bool> &cancelled) {
+			vector<string> current_suffixes;
+			try {
+				current_suffixes =
+				    BigQueryUtils::BigQueryListShardSuffixes(storage_project, dataset, prefix, service_account_json);
+			} catch (...) {
+				// the entry is revalidated again when it is bound next
+				ResetRevalidation(dataset, table);
+				throw;
+			}
+			// the set is looked up after the request, the cache may have been cleared in the meantime
+			auto table_set = GetLoadedTableSet(dataset);
+			auto entry = table_set ? table_set->GetLoadedEntry(table) : nullptr;
+			if (!entry || cancelled) {
+				return;
+			}
+			if (current_suffixes == suffixes) {
+				auto &current_entry = entry->Cast<BigQueryTableEntry>();
+				current_entry.validated_at = Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp());
+				current_entry.revalidating = false;
+				return;
+			}
+			// the next query that binds the table creates a new entry
+			table_set->RetireEntry(table);
+		});
+		return;
+	}
+	auto etag = table_entry.etag;
+	auto last_modified_time = table_entry.last_modified_time;
+	GetBackgroundScheduler(context).Schedule(this, [this, dataset, table, etag,
+	                                                last_modified_time](const std::atomic<bool> &cancelled) {
+		BQTableMetadata version;
+		try {
+			// reading the etag is much cheaper than reading the schema
+			version = BigQueryUtils::BigQueryReadTableVersion(storage_project, dataset, table, service_account_json);
+		} catch (...) {
+			// the entry is revalidated again when it is bound next
+			ResetRevalidation(dataset, table);
+			throw;
+		}
+		bool unchanged = !etag.empty() && !version.etag.empty() ? version.etag == etag
+		                                                        : version.last_modified_time == last_modified_time;
+		// the set is looked up after the request, the cache may have been cleared in the meantime
+		auto table_set = GetLoadedTableSet(dataset);
+		auto entry = table_set ? table_set->GetLoadedEntry(table) : nullptr;
+		if (!entry || cancelled) {
+			return;
+		}
+		if (unchanged) {
+			auto &current_entry = entry->Cast<BigQueryTableEntry>();
+			current_entry.validated_at = Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp());
+			current_entry.revalidating = false;
+			return;
+		}
+		try {
+			table_set->RefreshTable(table);
+		} catch (...) {
+			ResetRevalidation(dataset, table);
+			throw;
+		}
+	});
+}
+
+optional_ptr<BigQueryTableSet> BigQueryCatalog::GetLoadedTableSet(const string &dataset) {
+	auto schema = schemas.GetLoadedEntry(dataset);
+	if (!schema) {
+		return nullptr;
+	}
+	return &schema->Cast<BigQuerySchemaEntry>().GetTableSet();
+}
+
+void BigQueryCatalog::ResetRevalidation(const string &dataset, const string &table) {
+	auto table_set = GetLoadedTableSet(dataset);
+	auto entry = table_set ? table_set->GetLoadedEntry(table) : nullptr;
+	if (entry) {
+		entry->Cast<BigQueryTableEntry>().revalidating = false;
+	}
+}
+
+void BigQueryCatalog::InvalidateTable(const string &dataset, const string &table) {
+	auto schema = schemas.GetLoadedEntry(dataset);
+	if (!schema) {
+		return;
+	}
+	auto &table_set = schema->Cast<BigQuerySchemaEntry>().GetTableSet();
+	// wildcard tables whose prefix matches include the table as a shard
+	vector<string> invalidated {table};
+	table_set.ScanLoaded([&](CatalogEntry &entry) {
+		auto &table_entry = entry.Cast<BigQueryTableEntry>();
+		if (table_entry.wildcard &&
+		    StringUtil::StartsWith(table, table_entry.name.substr(0, table_entry.name.size() - 1))) {
+			invalidated.push_back(table_entry.name);
+		}
+	});
+	for (auto &name : invalidated) {
+		table_set.RetireEntry(name);
+	}
+	if (table_set.IsListed()) {
+		// the table keeps showing up when the dataset is enumerated
+		table_set.AddListedTables({table});
+	}
+}
+
+void BigQueryCatalog::ScanTables(const std::function<void(BigQueryTableEntry &)> &callback) {
+	schemas.ScanLoaded([&](CatalogEntry &schema) {
+		schema.Cast<BigQuerySchemaEntry>().GetTableSet().ScanLoaded(
+		    [&](CatalogEntry &entry) { callback(entry.Cast<BigQueryTableEntry>()); });
+	});
+}
+
+static idx_t GetCatalogMaxBytes(ClientContext &context) {
+	Value max_bytes;
+	if (!context.TryGetCurrentSetting("bigquery_catalog_max_bytes", max_bytes) || max_bytes.IsNull()) {
+		return 0;
+	}
+	return UBigIntValue::Get(max_bytes);
+}
+
+//! Entries looked up this recently are not evicted, as their binder may not have pinned them yet
+static constexpr int64_t EVICTION_GRACE_MS = 1000;
+
+void BigQueryCatalog::EnforceMemoryLimit(ClientContext &context) {
+	auto max_bytes = GetCatalogMaxBytes(context);
+	if (max_bytes == 0) {
+		return;
+	}
+	// the limit applies to all attached projects together
+	vector<reference<BigQueryCatalog>> catalogs;
+	idx_t total_usage = 0;
+	for (auto &db_ref : DatabaseManager::Get(context).GetDatabases(context)) {
+		auto &catalog = db_ref.get().GetCatalog();
+		if (catalog.GetCatalogType() != "bigquery") {
+			continue;
+		}
+		auto &bq_catalog = catalog.Cast<BigQueryCatalog>();
+		total_usage += bq_catalog.memory_usage;
+		catalogs.push_back(bq_catalog);
+	}
+	if (total_usage <= max_bytes) {
+		return;
+	}
+	// a concurrent eviction frees the memory for everyone
+	static mutex eviction_lock;
+	unique_lock<mutex> eviction_guard(eviction_lock, std::try_to_lock);
+	if (!eviction_guard.owns_lock()) {
+		return;
+	}
+
+	// find the last access time below which entries are evicted, aiming below the limit so that the next lookups
+	// do not evict again right away
+	vector<pair<int64_t, idx_t>> candidates;
+	for (auto &bq_catalog : catalogs) {
+		bq_catalog.get().ScanTables([&](BigQueryTableEntry &table_entry) {
+			if (table_entry.resolved && table_entry.pin_count == 0) {
+				candidates.emplace_back(table_entry.last_access.load(), table_entry.EstimateMemoryUsage());
+			}
+		});
+	}
+	std::sort(candidates.begin(), candidates.end());
+	auto grace_cutoff = Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp()) - EVICTION_GRACE_MS;
+	auto target_usage = max_bytes / 10 * 9;
+	auto cutoff = NumericLimits<int64_t>::Minimum();
+	for (auto &candidate : candidates) {
+		if (total_usage <= target_usage || candidate.first >= grace_cutoff) {
+			break;
+		}
+		cutoff = candidate.first + 1;
+		total_usage -= MinValue(candidate.second, total_usage);
+	}
+
+	for (auto &bq_catalog : catalogs) {
+		vector<reference<BigQueryTableSet>> table_sets;
+		bq_catalog.get().schemas.ScanLoaded(
+		    [&](CatalogEntry &schema) { table_sets.push_back(schema.Cast<BigQuerySchemaEntry>().GetTableSet()); });
+		for (auto &table_set : table_sets) {
+			// the pin count and the access time are checked again with the set locked, as the entries may have been
+			// looked up in the meantime
+			auto evicted = table_set.get().EvictEntries([&](CatalogEntry &entry, bool replaced) {
+				auto &table_entry = entry.Cast<BigQueryTableEntry>();
+				if (table_entry.pin_count > 0 || table_entry.last_access >= grace_cutoff) {
+					return false;
+				}
+				// replaced entries are no longer looked up, they are freed once nothing references them
+				return replaced || (table_entry.resolved && table_entry.last_access < cutoff);
+			});
+			if (!evicted.empty() && table_set.get().IsListed()) {
+				// the evicted tables keep showing up when the dataset is enumerated
+				table_set.get().AddListedTables(evicted);
+			}
+		}
+	}
+}
+
+void BigQueryCatalog::PrefetchHotTables(ClientContext &context, const vector<string> &hot_tables) {
+	if (hot_tables.empty()) {
+		return;
+	}
+	auto &scheduler = GetBackgroundScheduler(context);
+	auto &downloads = GetDownloadScheduler(context);
+	auto scan_cache = BigQueryScanCache::TryGet(context);
+	for (auto &hot_table : hot_tables) {
+		auto parts = StringUtil::Split(hot_table, '.');
+		if (parts.size() != 2) {
+			throw BinderException("Hot tables must be given as \"dataset.table\", got \"%s\"", hot_table);
+		}
+		auto dataset = parts[0];
+		auto table = parts[1];
+		scheduler.Schedule(this, [this, dataset, table, scan_cache, &downloads](const std::atomic<bool> &cancelled) {
+			// resolve the metadata first, so that binding queries on the table does not wait for it
+			auto table_entry = PreloadTable(dataset, table);
+			// views are not read through the scan cache, only their metadata is warmed
+			if (!table_entry || table_entry->IsView() || !scan_cache || cancelled) {
+				return;
+			}
+			BigQueryPrefetchRequest request;
+			request.execution_project = execution_project;
+			request.service_account_json = service_account_json;
+			request.key.table = "projects/" + storage_project + "/datasets/" + dataset + "/tables/" + table;
+			request.key.version = table_entry->last_modified_time;
+			for (auto &column : table_entry->GetColumns().Logical()) {
+				request.key.fields.push_back(column.GetName());
+			}
+			std::sort(request.key.fields.begin(), request.key.fields.end());
+			// the download runs in its own queue, so that it does not hold up the metadata jobs
+			downloads.Schedule(this, [scan_cache, request](const std::atomic<bool> &cancelled) {
+				BigQueryPrefetch::WarmScanCache(scan_cache, request, cancelled);
+			});
+		});
+	}
+}
+
+BigQueryBackgroundScheduler &BigQueryCatalog::GetBackgroundScheduler(ClientContext &context) {
+	lock_guard<mutex> guard(scheduler_lock);
+	if (!background_scheduler) {
+		background_scheduler = BigQueryBackgroundScheduler::Get(DatabaseInstance::GetDatabase(context), "metadata");
+	}
+	return *background_scheduler;
+}
+
+BigQueryBackgroundScheduler &BigQueryCatalog::GetDownloadScheduler(ClientContext &context) {
+	lock_guard<mutex> guard(scheduler_lock);
+	if (!download_scheduler) {
+		download_scheduler = BigQueryBackgroundScheduler::Get(DatabaseInstance::GetDatabase(context), "download");
+	}
+	return *download_scheduler;
+}
+
 bool BigQueryCatalog::InMemory() {
 	return false;
 }
@@ -116,7 +554,29 @@ DatabaseSize BigQueryCatalog::GetDatabaseSize(ClientContext &context) {
 }
 
 void BigQueryCatalog::ClearCache() {
-	schemas.ClearEntries();
+	// the metadata jobs reference the table sets that are cleared, e.g. the revalidation of the entries restored
+	// from the metadata cache file. The jobs that were not started yet are dropped, the running one is awaited.
+	shared_ptr<BigQueryBackgroundScheduler> scheduler;
+	{
+		lock_guard<mutex> guard(scheduler_lock);
+		scheduler = background_scheduler;
+	}
+	if (scheduler) {
+		scheduler->Cancel(this);
+	}
+	// the tables that queries still reference are kept alive, and with them the entries of their datasets. They are
+	// no longer looked up, and are freed by the next clear once the queries are done.
+	schemas.ClearEntries([](CatalogEntry &schema) {
+		auto &table_set = schema.Cast<BigQuerySchemaEntry>().GetTableSet();
+		table_set.ClearEntries([](CatalogEntry &table) { return table.Cast<BigQueryTableEntry>().pin_count > 0; });
+		return !table_set.IsEmpty();
+	});
+	table_cache.Clear();
+	read_session_cache.Clear();
+	view_cache.Clear();
+	if (metadata_cache) {
+		metadata_cache->Clear();
+	}
 }
 
 } // namespace duckdb
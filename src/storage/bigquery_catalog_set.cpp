@@ -2,17 +2,36 @@
 #include "storage/bigquery_transaction.hpp"
 #include "duckdb/parser/parsed_data/drop_info.hpp"
 #include "storage/bigquery_schema_entry.hpp"
+#include "storage/bigquery_catalog.hpp"
 
 namespace duckdb {
 
 BigQueryCatalogSet::BigQueryCatalogSet(Catalog &catalog) : catalog(catalog), is_loaded(false) {
 }
 
-optional_ptr<CatalogEntry> BigQueryCatalogSet::GetEntry(ClientContext &context, const string &name) {
-	if (!is_loaded) {
-		is_loaded = true;
-		LoadEntries(context);
+BigQueryCatalogSet::~BigQueryCatalogSet() {
+	// e.g. the table set of a schema entry that is cleared
+	catalog.Cast<BigQueryCatalog>().memory_usage -= memory_usage;
+}
+
+void BigQueryCatalogSet::TryLoadEntries(ClientContext &context) {
+	TryLoadEntries([&]() { LoadEntries(context); });
+}
+
+void BigQueryCatalogSet::TryLoadEntries(const std::function<void()> &load) {
+	if (is_loaded) {
+		return;
 	}
+	lock_guard<mutex> l(load_lock);
+	if (is_loaded) {
+		return;
+	}
+	load();
+	is_loaded = true;
+}
+
+optional_ptr<CatalogEntry> BigQueryCatalogSet::GetEntry(ClientContext &context, const string &name) {
+	TryLoadEntries(context);
 	lock_guard<mutex> l(entry_lock);
 	//Printer::Print("BigQueryCatalogSet::GetEntry find " + name);
 
@@ -28,6 +47,17 @@ optional_ptr<CatalogEntry> BigQueryCatalogSet::GetEntry(ClientContext &context,
 	// else {
 	// 	Printer::Print("BigQueryCatalogSet::GetEntry found!!!");
 	// }
+	TouchEntry(*entry->second);
+	return entry->second.get();
+}
+
+optional_ptr<CatalogEntry> BigQueryCatalogSet::GetLoadedEntry(const string &name) {
+	lock_guard<mutex> l(entry_lock);
+	auto entry = entries.find(name);
+	if (entry == entries.end()) {
+		return nullptr;
+	}
+	TouchEntry(*entry->second);
 	return entry->second.get();
 }
 
@@ -53,14 +83,16 @@ void BigQueryCatalogSet::DropEntry(ClientContext &context, DropInfo &info) {
 
 void BigQueryCatalogSet::EraseEntryInternal(const string &name) {
 	lock_guard<mutex> l(entry_lock);
-	entries.erase(name);
+	auto entry = entries.find(name);
+	if (entry == entries.end()) {
+		return;
+	}
+	RemoveMemoryUsage(*entry->second);
+	entries.erase(entry);
 }
 
 void BigQueryCatalogSet::Scan(ClientContext &context, const std::function<void(CatalogEntry &)> &callback) {
-	if (!is_loaded) {
-		is_loaded = true;
-		LoadEntries(context);
-	}
+	TryLoadEntries(context);
 	lock_guard<mutex> l(entry_lock);
 	for (auto &entry : entries) {
 		callback(*entry.second);
@@ -74,7 +106,13 @@ optional_ptr<CatalogEntry> BigQueryCatalogSet::CreateEntry(unique_ptr<CatalogEnt
 	if (result->name.empty()) {
 		throw InternalException("BigQueryCatalogSet::CreateEntry called with empty name");
 	}
-	entries.insert(make_pair(result->name, std::move(entry)));
+	auto inserted = entries.insert(make_pair(result->name, std::move(entry)));
+	if (!inserted.second) {
+		TouchEntry(*inserted.first->second);
+		return inserted.first->second.get();
+	}
+	AddMemoryUsage(*result);
+	TouchEntry(*result);
 	// print all values in entries
 	// for (auto &entry : entries) {
 	// 	Printer::Print("BigQueryCatalogSet::CreateEntry HAS " + entry.first);
@@ -82,11 +120,148 @@ optional_ptr<CatalogEntry> BigQueryCatalogSet::CreateEntry(unique_ptr<CatalogEnt
 	return result;
 }
 
-void BigQueryCatalogSet::ClearEntries() {
+optional_ptr<CatalogEntry> BigQueryCatalogSet::ReplaceEntry(unique_ptr<CatalogEntry> entry) {
+	lock_guard<mutex> l(entry_lock);
+	auto result = entry.get();
+	auto &slot = entries[result->name];
+	if (slot) {
+		replaced_entries.push_back(std::move(slot));
+	}
+	slot = std::move(entry);
+	AddMemoryUsage(*result);
+	TouchEntry(*result);
+	return result;
+}
+
+optional_ptr<CatalogEntry> BigQueryCatalogSet::LoadEntry(const string &name,
+                                                       const std::function<unique_ptr<CatalogEntry>()> &load,
+                                                       const std::function<bool(CatalogEntry &)> &is_complete) {
+	std::promise<optional_ptr<CatalogEntry>> promise;
+	std::shared_future<optional_ptr<CatalogEntry>> in_flight;
+	bool replace = false;
+	{
+		lock_guard<mutex> l(entry_lock);
+		auto entry = entries.find(name);
+		if (entry != entries.end() && is_complete(*entry->second)) {
+			TouchEntry(*entry->second);
+			return entry->second.get();
+		}
+		auto pending = pending_entries.find(name);
+		if (pending != pending_entries.end()) {
+			in_flight = pending->second;
+		} else {
+			replace = entry != entries.end();
+			pending_entries[name] = promise.get_future().share();
+		}
+	}
+	if (in_flight.valid()) {
+		// rethrows the error of the load
+		return in_flight.get();
+	}
+	optional_ptr<CatalogEntry> result;
+	try {
+		auto new_entry = load();
+		if (new_entry) {
+			if (!replace) {
+				// an incomplete entry may have been added while loading, e.g. by listing the tables of the dataset
+				lock_guard<mutex> l(entry_lock);
+				auto entry = entries.find(name);
+				replace = entry != entries.end() && !is_complete(*entry->second);
+			}
+			result = replace ? ReplaceEntry(std::move(new_entry)) : CreateEntry(std::move(new_entry));
+		}
+	} catch (...) {
+		promise.set_exception(std::current_exception());
+		lock_guard<mutex> l(entry_lock);
+		pending_entries.erase(name);
+		throw;
+	}
+	promise.set_value(result);
+	lock_guard<mutex> l(entry_lock);
+	pending_entries.erase(name);
+	return result;
+}
+
+void BigQueryCatalogSet::RetireEntry(const string &name) {
+	lock_guard<mutex> l(entry_lock);
+	auto entry = entries.find(name);
+	if (entry == entries.end()) {
+		return;
+	}
+	replaced_entries.push_back(std::move(entry->second));
+	entries.erase(entry);
+}
+
+void BigQueryCatalogSet::ScanLoaded(const std::function<void(CatalogEntry &)> &callback) {
+	lock_guard<mutex> l(entry_lock);
+	for (auto &entry : entries) {
+		callback(*entry.second);
+	}
+}
+
+vector<string> BigQueryCatalogSet::EvictEntries(const std::function<bool(CatalogEntry &, bool)> &evict) {
+	lock_guard<mutex> l(entry_lock);
+	vector<string> evicted;
+	for (auto entry = entries.begin(); entry != entries.end();) {
+		if (!evict(*entry->second, false)) {
+			entry++;
+			continue;
+		}
+		evicted.push_back(entry->first);
+		RemoveMemoryUsage(*entry->second);
+		entry = entries.erase(entry);
+	}
+	for (idx_t i = replaced_entries.size(); i > 0; i--) {
+		auto &replaced_entry = replaced_entries[i - 1];
+		if (!evict(*replaced_entry, true)) {
+			continue;
+		}
+		RemoveMemoryUsage(*replaced_entry);
+		replaced_entries.erase_at(i - 1);
+	}
+	return evicted;
+}
+
+void BigQueryCatalogSet::AddMemoryUsage(CatalogEntry &entry) {
+	auto entry_size = GetEntrySize(entry);
+	memory_usage += entry_size;
+	catalog.Cast<BigQueryCatalog>().memory_usage += entry_size;
+}
+
+void BigQueryCatalogSet::RemoveMemoryUsage(CatalogEntry &entry) {
+	auto entry_size = GetEntrySize(entry);
+	memory_usage -= entry_size;
+	catalog.Cast<BigQueryCatalog>().memory_usage -= entry_size;
+}
+
+void BigQueryCatalogSet::ClearEntries(const std::function<bool(CatalogEntry &)> &is_pinned) {
+	lock_guard<mutex> l(entry_lock);
+	vector<unique_ptr<CatalogEntry>> pinned_entries;
+	for (auto &entry : entries) {
+		if (is_pinned(*entry.second)) {
+			pinned_entries.push_back(std::move(entry.second));
+			continue;
+		}
+		RemoveMemoryUsage(*entry.second);
+	}
+	for (auto &replaced_entry : replaced_entries) {
+		if (is_pinned(*replaced_entry)) {
+			pinned_entries.push_back(std::move(replaced_entry));
+			continue;
+		}
+		RemoveMemoryUsage(*replaced_entry);
+	}
 	entries.clear();
+	// freed only after the pinned entries were moved out
+	replaced_entries = std::move(pinned_entries);
 	is_loaded = false;
 }
 
+bool BigQueryCatalogSet::IsEmpty() {
+	lock_guard<mutex> l(entry_lock);
+	return entries.empty() && replaced_entries.empty();
+}
+
 BigQueryInSchemaSet::BigQueryInSchemaSet(BigQuerySchemaEntry &schema) : BigQueryCatalogSet(schema.ParentCatalog()), schema(schema) {
 }
 
@@ -97,4 +272,11 @@ optional_ptr<CatalogEntry> BigQueryInSchemaSet::CreateEntry(unique_ptr<CatalogEn
 	return BigQueryCatalogSet::CreateEntry(std::move(entry));
 }
 
+optional_ptr<CatalogEntry> BigQueryInSchemaSet::ReplaceEntry(unique_ptr<CatalogEntry> entry) {
+	if (!entry->internal) {
+		entry->internal = schema.internal;
+	}
+	return BigQueryCatalogSet::ReplaceEntry(std::move(entry));
+}
+
 } // namespace duckdb
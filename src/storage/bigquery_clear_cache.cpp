@@ -1,21 +1,39 @@
 #include "duckdb.hpp"
 
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
+#include "duckdb/common/types/timestamp.hpp"
 #include "bigquery_scanner.hpp"
 #include "duckdb/main/database_manager.hpp"
 #include "duckdb/main/attached_database.hpp"
+#include "duckdb/parser/qualified_name.hpp"
 #include "storage/bigquery_catalog.hpp"
+#include "storage/bigquery_table_entry.hpp"
+#include "bigquery_scan_cache.hpp"
 
 namespace duckdb {
 
 struct ClearCacheFunctionData : public TableFunctionData {
 	bool finished = false;
+	//! Whether the local scan cache is purged as well
+	bool scan_cache = false;
+	//! If set, only the metadata of this table is cleared
+	QualifiedName table;
 };
 
 static unique_ptr<FunctionData> ClearCacheBind(ClientContext &context, TableFunctionBindInput &input,
                                                vector<LogicalType> &return_types, vector<string> &names) {
 
 	auto result = make_uniq<ClearCacheFunctionData>();
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "scan_cache") {
+			result->scan_cache = BooleanValue::Get(kv.second);
+		} else if (kv.first == "table") {
+			result->table = QualifiedName::Parse(StringValue::Get(kv.second));
+			if (result->table.schema.empty()) {
+				throw BinderException("bigquery_clear_cache expects the table as \"[catalog.]dataset.table\"");
+			}
+		}
+	}
 	return_types.push_back(LogicalType::BOOLEAN);
 	names.emplace_back("Success");
 	return std::move(result);
@@ -33,12 +51,38 @@ static void ClearBigQueryCaches(ClientContext &context) {
 	}
 }
 
+static void InvalidateBigQueryTable(ClientContext &context, const QualifiedName &table) {
+	auto databases = DatabaseManager::Get(context).GetDatabases(context);
+	for (auto &db_ref : databases) {
+		auto &db = db_ref.get();
+		auto &catalog = db.GetCatalog();
+		if (catalog.GetCatalogType() != "bigquery") {
+			continue;
+		}
+		if (!table.catalog.empty() && !StringUtil::CIEquals(db.GetName(), table.catalog)) {
+			continue;
+		}
+		catalog.Cast<BigQueryCatalog>().InvalidateTable(table.schema, table.name);
+	}
+}
+
 static void ClearCacheFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
 	auto &data = data_p.bind_data->CastNoConst<ClearCacheFunctionData>();
 	if (data.finished) {
 		return;
 	}
-	ClearBigQueryCaches(context);
+	if (data.table.name.empty()) {
+		ClearBigQueryCaches(context);
+	} else {
+		// the other caches are keyed by the table version, they miss once the new metadata is read
+		InvalidateBigQueryTable(context, data.table);
+	}
+	if (data.scan_cache) {
+		auto scan_cache = BigQueryScanCache::TryGet(context);
+		if (scan_cache) {
+			scan_cache->Purge();
+		}
+	}
 	data.finished = true;
 }
 
@@ -48,5 +92,128 @@ void BigQueryClearCacheFunction::ClearCacheOnSetting(ClientContext &context, Set
 
 BigQueryClearCacheFunction::BigQueryClearCacheFunction()
     : TableFunction("bigquery_clear_cache", {}, ClearCacheFunction, ClearCacheBind) {
+	named_parameters["scan_cache"] = LogicalType::BOOLEAN;
+	named_parameters["table"] = LogicalType::VARCHAR;
+}
+
+struct ScanCacheFunctionData : public TableFunctionData {
+	vector<BigQueryScanCacheEntry> entries;
+	idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> ScanCacheBind(ClientContext &context, TableFunctionBindInput &input,
+                                              vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<ScanCacheFunctionData>();
+	auto scan_cache = BigQueryScanCache::TryGet(context);
+	if (scan_cache) {
+		result->entries = scan_cache->GetEntries();
+	}
+	names.emplace_back("table");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("version");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("fields");
+	return_types.push_back(LogicalType::LIST(LogicalType::VARCHAR));
+	names.emplace_back("row_restriction");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("file");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("size");
+	return_types.push_back(LogicalType::UBIGINT);
+	names.emplace_back("last_access");
+	return_types.push_back(LogicalType::TIMESTAMP);
+	return std::move(result);
+}
+
+static void ScanCacheFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &data = data_p.bind_data->CastNoConst<ScanCacheFunctionData>();
+	idx_t count = 0;
+	while (data.offset < data.entries.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &entry = data.entries[data.offset++];
+		vector<Value> fields;
+		for (auto &field : entry.key.fields) {
+			fields.emplace_back(field);
+		}
+		output.SetValue(0, count, Value(entry.key.table));
+		output.SetValue(1, count, Value(entry.key.version));
+		output.SetValue(2, count, Value::LIST(LogicalType::VARCHAR, std::move(fields)));
+		output.SetValue(3, count, Value(entry.key.row_restriction));
+		output.SetValue(4, count, Value(entry.file_name));
+		output.SetValue(5, count, Value::UBIGINT(entry.size));
+		output.SetValue(6, count, Value::TIMESTAMP(Timestamp::FromEpochMs(entry.last_access)));
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+BigQueryScanCacheFunction::BigQueryScanCacheFunction()
+    : TableFunction("bigquery_scan_cache", {}, ScanCacheFunction, ScanCacheBind) {
+}
+
+struct CatalogMemoryRow {
+	string database_name;
+	idx_t tables = 0;
+	idx_t resolved_tables = 0;
+	idx_t pinned_tables = 0;
+	idx_t memory_usage = 0;
+};
+
+struct CatalogMemoryFunctionData : public TableFunctionData {
+	vector<CatalogMemoryRow> rows;
+	idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> CatalogMemoryBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<CatalogMemoryFunctionData>();
+	auto databases = DatabaseManager::Get(context).GetDatabases(context);
+	for (auto &db_ref : databases) {
+		auto &db = db_ref.get();
+		auto &catalog = db.GetCatalog();
+		if (catalog.GetCatalogType() != "bigquery") {
+			continue;
+		}
+		auto &bq_catalog = catalog.Cast<BigQueryCatalog>();
+		CatalogMemoryRow row;
+		row.database_name = db.GetName();
+		bq_catalog.ScanTables([&](BigQueryTableEntry &table_entry) {
+			row.tables++;
+			row.resolved_tables += table_entry.resolved;
+			row.pinned_tables += table_entry.pin_count > 0;
+		});
+		// includes replaced entries that are still referenced
+		row.memory_usage = bq_catalog.memory_usage;
+		result->rows.push_back(std::move(row));
+	}
+	names.emplace_back("database_name");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("tables");
+	return_types.push_back(LogicalType::UBIGINT);
+	names.emplace_back("resolved_tables");
+	return_types.push_back(LogicalType::UBIGINT);
+	names.emplace_back("pinned_tables");
+	return_types.push_back(LogicalType::UBIGINT);
+	names.emplace_back("memory_usage");
+	return_types.push_back(LogicalType::UBIGINT);
+	return std::move(result);
+}
+
+static void CatalogMemoryFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &data = data_p.bind_data->CastNoConst<CatalogMemoryFunctionData>();
+	idx_t count = 0;
+	while (data.offset < data.rows.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &row = data.rows[data.offset++];
+		output.SetValue(0, count, Value(row.database_name));
+		output.SetValue(1, count, Value::UBIGINT(row.tables));
+		output.SetValue(2, count, Value::UBIGINT(row.resolved_tables));
+		output.SetValue(3, count, Value::UBIGINT(row.pinned_tables));
+		output.SetValue(4, count, Value::UBIGINT(row.memory_usage));
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+BigQueryCatalogMemoryFunction::BigQueryCatalogMemoryFunction()
+    : TableFunction("bigquery_catalog_memory", {}, CatalogMemoryFunction, CatalogMemoryBind) {
 }
 } // namespace duckdb
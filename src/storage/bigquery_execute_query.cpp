@@ -49,6 +49,8 @@ SinkFinalizeType BigQueryExecuteQuery::Finalize(Pipeline &pipeline, Event &event
 	// auto &connection = transaction.GetConnection();
 	// auto result = connection.Query(query);
 	// gstate.affected_rows = result->AffectedRows();
+	// the cached entry of the modified table is outdated
+	table.catalog.Cast<BigQueryCatalog>().InvalidateTable(table.schema.name, table.name);
 	return SinkFinalizeType::READY;
 }
 
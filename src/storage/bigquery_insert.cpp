@@ -235,6 +235,10 @@ SinkFinalizeType BigQueryInsert::Finalize(Pipeline &pipeline, Event &event, Clie
 		//auto &con = transaction.GetConnection();
 		//con.Query(gstate.base_insert_query + gstate.insert_values);
 	}
+	if (gstate.insert_count > 0) {
+		// the row count and the last modification time of the cached entry are outdated
+		gstate.table.catalog.Cast<BigQueryCatalog>().InvalidateTable(gstate.table.schema.name, gstate.table.name);
+	}
 	return SinkFinalizeType::READY;
 }
 
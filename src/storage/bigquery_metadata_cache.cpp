@@ -0,0 +1,161 @@
+#include "storage/bigquery_metadata_cache.hpp"
+#include "storage/bigquery_table_entry.hpp"
+#include "duckdb/common/local_file_system.hpp"
+#include "duckdb/common/types/uuid.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+using json = nlohmann::json;
+
+namespace duckdb {
+
+//! Files of another format version are ignored, and overwritten on the next write
+static constexpr int METADATA_CACHE_VERSION = 1;
+
+BigQueryMetadataCache::BigQueryMetadataCache(string path_p, string project_p)
+    : path(LocalFileSystem().ExpandPath(path_p)), project(std::move(project_p)), put_tables(json::object()) {
+}
+
+string BigQueryMetadataCache::GetPath(ClientContext &context) {
+	Value path;
+	if (!context.TryGetCurrentSetting("bigquery_metadata_cache_path", path) || path.IsNull()) {
+		return string();
+	}
+	return StringValue::Get(path);
+}
+
+static json ReadCacheFile(const string &path) {
+	std::ifstream file(path);
+	if (!file) {
+		return json::object();
+	}
+	auto contents = json::parse(file, nullptr, false);
+	if (contents.is_discarded() || !contents.is_object() || contents.value("version", 0) != METADATA_CACHE_VERSION) {
+		// a corrupt or outdated file is treated as an empty cache
+		return json::object();
+	}
+	return contents;
+}
+
+vector<BigQueryCachedTable> BigQueryMetadataCache::Load() {
+	lock_guard<mutex> guard(lock);
+	auto contents = ReadCacheFile(path);
+	vector<BigQueryCachedTable> result;
+	if (!contents.contains("projects") || !contents["projects"].contains(project)) {
+		return result;
+	}
+	auto &tables = contents["projects"][project];
+	for (auto &item : tables.items()) {
+		auto &json_table = item.value();
+		BigQueryCachedTable cached_table;
+		cached_table.dataset = json_table.value("dataset", "");
+		cached_table.table = json_table.value("table", "");
+		auto &metadata = cached_table.metadata;
+		try {
+			for (auto &column : json_table["columns"]) {
+				metadata.columns.emplace_back(column[0].get<std::string>(),
+				                              BigQueryUtils::SQLTypeToLogicalType(column[1].get<std::string>()));
+			}
+		} catch (std::exception &) {
+			// written by a version that knew more types, the table is fetched again when it is used
+			continue;
+		}
+		metadata.table_type = json_table.value("table_type", "TABLE");
+		metadata.num_rows = json_table.value("num_rows", idx_t(0));
+		metadata.num_bytes = json_table.value("num_bytes", idx_t(0));
+		metadata.last_modified_time = json_table.value("last_modified_time", "");
+		metadata.etag = json_table.value("etag", "");
+		auto primary_key = json_table.value("primary_key", std::vector<std::string>());
+		metadata.primary_key = vector<string>(primary_key.begin(), primary_key.end());
+		auto clustering_fields = json_table.value("clustering_fields", std::vector<std::string>());
+		metadata.clustering_fields = vector<string>(clustering_fields.begin(), clustering_fields.end());
+		metadata.partition_type = json_table.value("partition_type", "");
+		metadata.partition_column = json_table.value("partition_column", "");
+		metadata.partition_range_interval = json_table.value("partition_range_interval", int64_t(0));
+		metadata.external_format = json_table.value("external_format", "");
+		auto external_uris = json_table.value("external_uris", std::vector<std::string>());
+		metadata.external_uris = vector<string>(external_uris.begin(), external_uris.end());
+		metadata.external_hive_partitioning = json_table.value("external_hive_partitioning", false);
+		if (cached_table.dataset.empty() || cached_table.table.empty() || metadata.columns.empty()) {
+			continue;
+		}
+		result.push_back(std::move(cached_table));
+	}
+	return result;
+}
+
+void BigQueryMetadataCache::Put(const string &dataset, const BigQueryTableEntry &table_entry) {
+	json json_table;
+	json_table["dataset"] = dataset;
+	json_table["table"] = table_entry.name;
+	auto columns = json::array();
+	for (auto &column : table_entry.GetColumns().Logical()) {
+		columns.push_back({column.GetName(), BigQueryUtils::LogicalTypeToSQLType(column.GetType())});
+	}
+	json_table["columns"] = std::move(columns);
+	json_table["table_type"] = table_entry.table_type;
+	json_table["num_rows"] = table_entry.num_rows;
+	json_table["num_bytes"] = table_entry.num_bytes;
+	json_table["last_modified_time"] = table_entry.last_modified_time;
+	json_table["etag"] = table_entry.etag;
+	json_table["primary_key"] = std::vector<std::string>(table_entry.primary_key.begin(), table_entry.primary_key.end());
+	json_table["clustering_fields"] =
+	    std::vector<std::string>(table_entry.clustering_fields.begin(), table_entry.clustering_fields.end());
+	json_table["partition_type"] = table_entry.partition_type;
+	json_table["partition_column"] = table_entry.partition_column;
+	json_table["partition_range_interval"] = table_entry.partition_range_interval;
+	json_table["external_format"] = table_entry.external_format;
+	json_table["external_uris"] =
+	    std::vector<std::string>(table_entry.external_uris.begin(), table_entry.external_uris.end());
+	json_table["external_hive_partitioning"] = table_entry.external_hive_partitioning;
+
+	lock_guard<mutex> guard(lock);
+	put_tables[dataset + "." + table_entry.name] = std::move(json_table);
+	dirty = true;
+}
+
+void BigQueryMetadataCache::Clear() {
+	lock_guard<mutex> guard(lock);
+	put_tables = json::object();
+	cleared = true;
+	dirty = true;
+}
+
+void BigQueryMetadataCache::Flush() {
+	lock_guard<mutex> guard(lock);
+	if (!dirty) {
+		return;
+	}
+	// other processes, and catalogs of other projects, write the same file: only the tables this catalog has put are
+	// replaced, and the file is locked so that a concurrent write does not drop the tables that another process added
+	LocalFileSystem fs;
+	auto file_lock = BigQueryUtils::LockFile(fs, path);
+	auto contents = ReadCacheFile(path);
+	contents["version"] = METADATA_CACHE_VERSION;
+	auto &tables = contents["projects"][project];
+	if (cleared || !tables.is_object()) {
+		tables = json::object();
+	}
+	for (auto &item : put_tables.items()) {
+		tables[item.key()] = item.value();
+	}
+	// a unique name, so that writers that do not take the lock never write into the same temporary file
+	auto temp_path = path + "." + UUID::ToString(UUID::GenerateRandomUUID()) + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::trunc);
+		file << contents.dump();
+		if (!file) {
+			throw IOException("Failed to write the BigQuery metadata cache \"%s\"", temp_path);
+		}
+	}
+	if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+		std::remove(temp_path.c_str());
+		throw IOException("Failed to write the BigQuery metadata cache \"%s\"", path);
+	}
+	put_tables = json::object();
+	cleared = false;
+	dirty = false;
+}
+
+} // namespace duckdb
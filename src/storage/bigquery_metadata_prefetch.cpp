@@ -0,0 +1,295 @@
+#include "storage/bigquery_metadata_prefetch.hpp"
+#include "storage/bigquery_catalog.hpp"
+#include "storage/bigquery_schema_entry.hpp"
+#include "storage/bigquery_table_entry.hpp"
+#include "duckdb/catalog/catalog_search_path.hpp"
+#include "duckdb/main/attached_database.hpp"
+#include "duckdb/main/client_data.hpp"
+#include "duckdb/main/database_manager.hpp"
+#include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/parsed_expression_iterator.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+#include "duckdb/parser/expression/subquery_expression.hpp"
+#include "duckdb/parser/parsed_data/create_table_info.hpp"
+#include "duckdb/parser/query_node/cte_node.hpp"
+#include "duckdb/parser/query_node/recursive_cte_node.hpp"
+#include "duckdb/parser/query_node/select_node.hpp"
+#include "duckdb/parser/query_node/set_operation_node.hpp"
+#include "duckdb/parser/statement/create_statement.hpp"
+#include "duckdb/parser/statement/delete_statement.hpp"
+#include "duckdb/parser/statement/explain_statement.hpp"
+#include "duckdb/parser/statement/insert_statement.hpp"
+#include "duckdb/parser/statement/select_statement.hpp"
+#include "duckdb/parser/statement/update_statement.hpp"
+#include "duckdb/parser/tableref/list.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace duckdb {
+
+static constexpr const char *METADATA_PREFETCH_STATE = "bigquery_metadata_prefetch";
+//! The number of tables whose metadata is fetched at the same time
+static constexpr idx_t METADATA_PREFETCH_PARALLELISM = 16;
+
+//! Collects the names of the tables a statement reads or writes, without binding it
+struct BigQueryTableNameCollector {
+	vector<QualifiedName> tables;
+	//! Unqualified references to these names read a CTE rather than a table
+	case_insensitive_set_t cte_names;
+
+	void CollectStatement(SQLStatement &statement);
+	void CollectNode(QueryNode &node);
+	void CollectRef(TableRef &ref);
+	void CollectExpression(const ParsedExpression &expr);
+};
+
+void BigQueryTableNameCollector::CollectStatement(SQLStatement &statement) {
+	switch (statement.type) {
+	case StatementType::SELECT_STATEMENT:
+		CollectNode(*statement.Cast<SelectStatement>().node);
+		break;
+	case StatementType::INSERT_STATEMENT: {
+		auto &insert = statement.Cast<InsertStatement>();
+		tables.push_back(QualifiedName {insert.catalog, insert.schema, insert.table});
+		if (insert.select_statement) {
+			CollectNode(*insert.select_statement->node);
+		}
+		break;
+	}
+	case StatementType::UPDATE_STATEMENT: {
+		auto &update = statement.Cast<UpdateStatement>();
+		CollectRef(*update.table);
+		if (update.from_table) {
+			CollectRef(*update.from_table);
+		}
+		break;
+	}
+	case StatementType::DELETE_STATEMENT: {
+		auto &del = statement.Cast<DeleteStatement>();
+		CollectRef(*del.table);
+		for (auto &using_clause : del.using_clauses) {
+			CollectRef(*using_clause);
+		}
+		break;
+	}
+	case StatementType::CREATE_STATEMENT: {
+		auto &create = statement.Cast<CreateStatement>();
+		if (create.info->type == CatalogType::TABLE_ENTRY) {
+			auto &create_table = create.info->Cast<CreateTableInfo>();
+			if (create_table.query) {
+				CollectNode(*create_table.query->node);
+			}
+		}
+		break;
+	}
+	case StatementType::EXPLAIN_STATEMENT:
+		CollectStatement(*statement.Cast<ExplainStatement>().stmt);
+		break;
+	default:
+		break;
+	}
+}
+
+void BigQueryTableNameCollector::CollectNode(QueryNode &node) {
+	for (auto &cte : node.cte_map.map) {
+		cte_names.insert(cte.first);
+		CollectNode(*cte.second->query->node);
+	}
+	switch (node.type) {
+	case QueryNodeType::SELECT_NODE: {
+		auto &select = node.Cast<SelectNode>();
+		if (select.from_table) {
+			CollectRef(*select.from_table);
+		}
+		for (auto &expr : select.select_list) {
+			CollectExpression(*expr);
+		}
+		if (select.where_clause) {
+			CollectExpression(*select.where_clause);
+		}
+		if (select.having) {
+			CollectExpression(*select.having);
+		}
+		if (select.qualify) {
+			CollectExpression(*select.qualify);
+		}
+		break;
+	}
+	case QueryNodeType::SET_OPERATION_NODE: {
+		auto &set_operation = node.Cast<SetOperationNode>();
+		CollectNode(*set_operation.left);
+		CollectNode(*set_operation.right);
+		break;
+	}
+	case QueryNodeType::RECURSIVE_CTE_NODE: {
+		auto &recursive_cte = node.Cast<RecursiveCTENode>();
+		cte_names.insert(recursive_cte.ctename);
+		CollectNode(*recursive_cte.left);
+		CollectNode(*recursive_cte.right);
+		break;
+	}
+	case QueryNodeType::CTE_NODE: {
+		auto &cte = node.Cast<CTENode>();
+		cte_names.insert(cte.ctename);
+		CollectNode(*cte.query);
+		CollectNode(*cte.child);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void BigQueryTableNameCollector::CollectRef(TableRef &ref) {
+	switch (ref.type) {
+	case TableReferenceType::BASE_TABLE: {
+		auto &base_table = ref.Cast<BaseTableRef>();
+		tables.push_back(QualifiedName {base_table.catalog_name, base_table.schema_name, base_table.table_name});
+		break;
+	}
+	case TableReferenceType::JOIN: {
+		auto &join = ref.Cast<JoinRef>();
+		CollectRef(*join.left);
+		CollectRef(*join.right);
+		if (join.condition) {
+			CollectExpression(*join.condition);
+		}
+		break;
+	}
+	case TableReferenceType::SUBQUERY:
+		CollectNode(*ref.Cast<SubqueryRef>().subquery->node);
+		break;
+	case TableReferenceType::PIVOT:
+		CollectRef(*ref.Cast<PivotRef>().source);
+		break;
+	default:
+		break;
+	}
+}
+
+void BigQueryTableNameCollector::CollectExpression(const ParsedExpression &expr) {
+	if (expr.GetExpressionClass() == ExpressionClass::SUBQUERY) {
+		CollectNode(*expr.Cast<SubqueryExpression>().subquery->node);
+	}
+	ParsedExpressionIterator::EnumerateChildren(expr,
+	                                            [&](const ParsedExpression &child) { CollectExpression(child); });
+}
+
+static optional_ptr<BigQueryCatalog> GetBigQueryCatalog(ClientContext &context, const string &catalog_name) {
+	auto &db_manager = DatabaseManager::Get(context);
+	auto db = db_manager.GetDatabase(context, catalog_name.empty() ? DatabaseManager::GetDefaultDatabase(context)
+	                                                               : catalog_name);
+	if (!db || db->GetCatalog().GetCatalogType() != "bigquery") {
+		return nullptr;
+	}
+	return &db->GetCatalog().Cast<BigQueryCatalog>();
+}
+
+vector<BigQueryTableReference> BigQueryMetadataPrefetch::GetTableReferences(ClientContext &context,
+                                                                           const string &query) {
+	BigQueryTableNameCollector collector;
+	try {
+		Parser parser(context.GetParserOptions());
+		parser.ParseQuery(query);
+		for (auto &statement : parser.statements) {
+			collector.CollectStatement(*statement);
+		}
+	} catch (std::exception &) {
+		// the query is not plain SQL, e.g. it is handled by a parser extension
+		return vector<BigQueryTableReference>();
+	}
+
+	// resolve the names the way the binder does, as far as BigQuery tables are concerned
+	auto &search_path = ClientData::Get(context).catalog_search_path->Get();
+	vector<BigQueryTableReference> result;
+	case_insensitive_set_t seen;
+	auto add_table = [&](BigQueryCatalog &catalog, const string &dataset, const string &table) {
+		// wildcard tables are resolved from the list of shards by the binder
+		if (dataset.empty() || dataset == DEFAULT_SCHEMA || StringUtil::EndsWith(table, "*")) {
+			return;
+		}
+		auto key = catalog.GetName() + "." + dataset + "." + table;
+		if (seen.insert(key).second) {
+			result.push_back(BigQueryTableReference {catalog, dataset, table});
+		}
+	};
+	for (auto &name : collector.tables) {
+		if (!name.catalog.empty()) {
+			auto catalog = GetBigQueryCatalog(context, name.catalog);
+			if (catalog) {
+				add_table(*catalog, name.schema, name.name);
+			}
+			continue;
+		}
+		if (name.schema.empty() && collector.cte_names.count(name.name)) {
+			continue;
+		}
+		if (!name.schema.empty() && GetBigQueryCatalog(context, name.schema)) {
+			// "catalog.table", which the binder looks up in the catalog's default schema
+			continue;
+		}
+		for (auto &entry : search_path) {
+			auto catalog = GetBigQueryCatalog(context, entry.catalog);
+			if (catalog) {
+				add_table(*catalog, name.schema.empty() ? entry.schema : name.schema, name.name);
+			}
+		}
+	}
+	return result;
+}
+
+void BigQueryMetadataPrefetch::ResolveTables(const vector<BigQueryTableReference> &tables) {
+	vector<reference<const BigQueryTableReference>> unresolved;
+	for (auto &table : tables) {
+		auto entry = table.catalog.GetLoadedSchema(table.dataset).GetTableSet().GetLoadedEntry(table.table);
+		if (!entry || !entry->Cast<BigQueryTableEntry>().resolved) {
+			unresolved.push_back(table);
+		}
+	}
+	// a single table is resolved by the binder just as fast
+	if (unresolved.size() < 2) {
+		return;
+	}
+	std::atomic<idx_t> next_table {0};
+	auto resolve_tables = [&]() {
+		for (auto i = next_table++; i < unresolved.size(); i = next_table++) {
+			auto &table = unresolved[i].get();
+			try {
+				table.catalog.PreloadTable(table.dataset, table.table);
+			} catch (std::exception &) {
+				// e.g. the table does not exist, the binder reports the error
+			}
+		}
+	};
+	vector<std::thread> workers;
+	auto worker_count = MinValue<idx_t>(unresolved.size(), METADATA_PREFETCH_PARALLELISM);
+	for (idx_t i = 1; i < worker_count; i++) {
+		workers.emplace_back(resolve_tables);
+	}
+	resolve_tables();
+	for (auto &worker : workers) {
+		worker.join();
+	}
+}
+
+void BigQueryMetadataPrefetch::QueryBegin(ClientContext &context) {
+	Value setting;
+	if (context.TryGetCurrentSetting("bigquery_prefetch_statement_metadata", setting) && !BooleanValue::Get(setting)) {
+		return;
+	}
+	try {
+		ResolveTables(GetTableReferences(context, context.GetCurrentQuery()));
+	} catch (std::exception &) {
+		// the prefetch is only an optimization, binding looks up the tables again
+	}
+}
+
+void BigQueryMetadataPrefetch::Register(ClientContext &context) {
+	auto &registered_state = context.registered_state;
+	if (registered_state.find(METADATA_PREFETCH_STATE) == registered_state.end()) {
+		registered_state[METADATA_PREFETCH_STATE] = make_shared_ptr<BigQueryMetadataPrefetch>();
+	}
+}
+
+} // namespace duckdb
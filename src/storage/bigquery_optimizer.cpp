@@ -1,8 +1,14 @@
 #include "storage/bigquery_optimizer.hpp"
 #include "duckdb/planner/operator/logical_get.hpp"
 #include "duckdb/planner/operator/logical_limit.hpp"
+#include "duckdb/planner/logical_operator_visitor.hpp"
+#include "duckdb/planner/expression_iterator.hpp"
+#include "duckdb/planner/column_binding_map.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
 #include "bigquery_scanner.hpp"
 
+#include <algorithm>
+
 namespace duckdb {
 
 static bool IsBigQueryScan(const string &function_name) {
@@ -51,6 +57,10 @@ void OptimizeBigQueryScan(unique_ptr<LogicalOperator> &op) {
         }
         // Cast the bind data of the GET operator to BigQueryScanBindData for modification
         auto &bind_data = get.bind_data->Cast<BigQueryScanBindData>();
+        // the shards of wildcard tables are read in parallel, in no particular order, so rows cannot be skipped
+        if (bind_data.suffix_column.IsValid() && limit.offset_val.Type() != LimitNodeType::UNSET) {
+            return;
+        }
 		//Printer::Print("OptimizeBigQueryScan");
         // If a limit is set, apply it to the bind data
         if (limit.limit_val.Type() != LimitNodeType::UNSET) {
@@ -71,7 +81,141 @@ void OptimizeBigQueryScan(unique_ptr<LogicalOperator> &op) {
     }
 }
 
+//! How a STRUCT column of a BigQuery scan is used by the rest of the plan
+struct BigQueryStructUsage {
+	//! Whether the column is referenced as a whole somewhere
+	bool full = false;
+	//! The subfield paths that are extracted from the column
+	vector<vector<string>> paths;
+};
+
+struct BigQueryStructUsageState {
+	//! The BigQuery scans in the plan, by table index
+	unordered_map<idx_t, reference<LogicalGet>> gets;
+	column_binding_map_t<BigQueryStructUsage> usages;
+};
+
+static void CollectBigQueryGets(LogicalOperator &op, BigQueryStructUsageState &state) {
+	if (op.type == LogicalOperatorType::LOGICAL_GET) {
+		auto &get = op.Cast<LogicalGet>();
+		if (IsBigQueryScan(get.function.name)) {
+			state.gets.emplace(get.table_index, get);
+		}
+	}
+	for (auto &child : op.children) {
+		CollectBigQueryGets(*child, state);
+	}
+}
+
+static void CollectStructUsage(Expression &expr, BigQueryStructUsageState &state) {
+	if (expr.expression_class == ExpressionClass::BOUND_FUNCTION) {
+		vector<string> path;
+		auto column_ref = BigQueryUtils::GetStructExtractPath(expr, path);
+		if (column_ref && !path.empty()) {
+			state.usages[column_ref->binding].paths.push_back(std::move(path));
+			return;
+		}
+	}
+	if (expr.type == ExpressionType::BOUND_COLUMN_REF) {
+		state.usages[expr.Cast<BoundColumnRefExpression>().binding].full = true;
+		return;
+	}
+	ExpressionIterator::EnumerateChildren(expr, [&](Expression &child) { CollectStructUsage(child, state); });
+}
+
+static bool ReferencesChildrenThroughExpressions(LogicalOperator &op) {
+	switch (op.type) {
+	case LogicalOperatorType::LOGICAL_PROJECTION:
+	case LogicalOperatorType::LOGICAL_FILTER:
+	case LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY:
+	case LogicalOperatorType::LOGICAL_WINDOW:
+	case LogicalOperatorType::LOGICAL_ORDER_BY:
+	case LogicalOperatorType::LOGICAL_TOP_N:
+	case LogicalOperatorType::LOGICAL_LIMIT:
+	case LogicalOperatorType::LOGICAL_COMPARISON_JOIN:
+	case LogicalOperatorType::LOGICAL_ANY_JOIN:
+	case LogicalOperatorType::LOGICAL_CROSS_PRODUCT:
+	case LogicalOperatorType::LOGICAL_GET:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void CollectStructUsage(LogicalOperator &op, BigQueryStructUsageState &state) {
+	if (op.type == LogicalOperatorType::LOGICAL_GET) {
+		// a filter on the column itself needs the whole column
+		auto &get = op.Cast<LogicalGet>();
+		for (auto &filter : get.table_filters.filters) {
+			state.usages[ColumnBinding(get.table_index, filter.first)].full = true;
+		}
+	}
+	if (!ReferencesChildrenThroughExpressions(op)) {
+		// operators such as set operations consume their children's columns positionally
+		for (auto &child : op.children) {
+			for (auto &binding : child->GetColumnBindings()) {
+				state.usages[binding].full = true;
+			}
+		}
+	}
+	LogicalOperatorVisitor::EnumerateExpressions(
+	    op, [&](unique_ptr<Expression> *child) { CollectStructUsage(**child, state); });
+	for (auto &child : op.children) {
+		CollectStructUsage(*child, state);
+	}
+}
+
+static vector<string> GetSubfieldPaths(vector<vector<string>> &paths) {
+	// a path makes all the longer paths that start with it redundant, sorting puts it right before them
+	std::sort(paths.begin(), paths.end());
+	vector<string> result;
+	vector<string> previous;
+	for (auto &path : paths) {
+		if (!previous.empty() && path.size() >= previous.size() &&
+		    std::equal(previous.begin(), previous.end(), path.begin())) {
+			continue;
+		}
+		result.push_back(StringUtil::Join(path, "."));
+		previous = path;
+	}
+	return result;
+}
+
+// Translates struct_extract chains on STRUCT columns of a BigQuery scan into nested selected fields, so only the
+// requested subfields of a record get downloaded.
+void OptimizeBigQueryStructProjection(unique_ptr<LogicalOperator> &plan) {
+	BigQueryStructUsageState state;
+	CollectBigQueryGets(*plan, state);
+	if (state.gets.empty()) {
+		return;
+	}
+	// the result of the plan itself is used as a whole
+	for (auto &binding : plan->GetColumnBindings()) {
+		state.usages[binding].full = true;
+	}
+	CollectStructUsage(*plan, state);
+
+	for (auto &entry : state.gets) {
+		auto &get = entry.second.get();
+		auto &bind_data = get.bind_data->Cast<BigQueryScanBindData>();
+		bind_data.selected_subfields.clear();
+		for (idx_t i = 0; i < get.column_ids.size(); i++) {
+			auto column_id = get.column_ids[i];
+			if (column_id >= bind_data.column_types.size() ||
+			    bind_data.column_types[column_id].id() != LogicalTypeId::STRUCT) {
+				continue;
+			}
+			auto usage = state.usages.find(ColumnBinding(get.table_index, i));
+			if (usage == state.usages.end() || usage->second.full || usage->second.paths.empty()) {
+				continue;
+			}
+			bind_data.selected_subfields[column_id] = GetSubfieldPaths(usage->second.paths);
+		}
+	}
+}
+
 void BigQueryOptimizer::Optimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan){
+	 OptimizeBigQueryStructProjection(plan);
 	 OptimizeBigQueryScan(plan);
 }
 
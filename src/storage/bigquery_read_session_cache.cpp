@@ -0,0 +1,106 @@
+#include "storage/bigquery_read_session_cache.hpp"
+#include "bigquery_utils.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+
+namespace duckdb {
+
+//! Sessions are not handed out anymore when they expire within this time, so that the scan can finish reading
+static constexpr int64_t READ_SESSION_EXPIRY_MARGIN_MS = 15 * 60 * 1000;
+static constexpr idx_t READ_SESSION_CACHE_MAX_ENTRIES = 64;
+
+static int64_t CurrentTimeMs() {
+	return Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp());
+}
+
+bool BigQueryReadSessionCache::IsEnabled(ClientContext &context) {
+	Value setting;
+	return context.TryGetCurrentSetting("bigquery_read_session_cache", setting) && BooleanValue::Get(setting);
+}
+
+shared_ptr<const bigquery_storage_read::ReadSession>
+BigQueryReadSessionCache::TryGet(const BigQueryScanCacheKey &key, const string &service_account_json) {
+	auto session = TryGetEntry(key);
+	if (!session) {
+		return nullptr;
+	}
+	// a session reads the snapshot of its creation, which is only the current data if the table has not been
+	// modified since. The catalog's version of the table may be outdated, so it is read again.
+	auto table_path = StringUtil::Split(key.table, '/');
+	if (table_path.size() != 6) {
+		return nullptr;
+	}
+	auto version = BigQueryUtils::BigQueryReadTableVersion(table_path[1], table_path[3], table_path[5],
+	                                                       service_account_json);
+	if (version.last_modified_time != key.version) {
+		lock_guard<mutex> guard(lock);
+		for (idx_t i = 0; i < entries.size(); i++) {
+			if (entries[i].key.table == key.table) {
+				entries.erase_at(i);
+				i--;
+			}
+		}
+		return nullptr;
+	}
+	return session;
+}
+
+shared_ptr<const bigquery_storage_read::ReadSession> BigQueryReadSessionCache::TryGetEntry(
+    const BigQueryScanCacheKey &key) {
+	lock_guard<mutex> guard(lock);
+	auto now = CurrentTimeMs();
+	BigQueryReadSessionCacheEntry *result = nullptr;
+	for (idx_t i = 0; i < entries.size(); i++) {
+		auto &entry = entries[i];
+		bool stale = entry.key.table == key.table && entry.key.version != key.version;
+		if (stale || entry.expire_time - now < READ_SESSION_EXPIRY_MARGIN_MS) {
+			entries.erase_at(i);
+			i--;
+			continue;
+		}
+		if (!entry.key.Covers(key)) {
+			continue;
+		}
+		// prefer the session with the fewest extra fields
+		if (!result || entry.key.fields.size() < result->key.fields.size()) {
+			result = &entry;
+		}
+	}
+	if (!result) {
+		return nullptr;
+	}
+	result->last_access = now;
+	return result->session;
+}
+
+void BigQueryReadSessionCache::Put(const BigQueryScanCacheKey &key,
+                                   shared_ptr<const bigquery_storage_read::ReadSession> session) {
+	lock_guard<mutex> guard(lock);
+	BigQueryReadSessionCacheEntry entry;
+	entry.key = key;
+	entry.expire_time = session->expire_time().seconds() * 1000 + session->expire_time().nanos() / 1000000;
+	entry.last_access = CurrentTimeMs();
+	entry.session = std::move(session);
+	for (idx_t i = 0; i < entries.size(); i++) {
+		if (entry.key.Covers(entries[i].key)) {
+			entries.erase_at(i);
+			i--;
+		}
+	}
+	while (entries.size() >= READ_SESSION_CACHE_MAX_ENTRIES) {
+		idx_t lru_entry = 0;
+		for (idx_t i = 1; i < entries.size(); i++) {
+			if (entries[i].last_access < entries[lru_entry].last_access) {
+				lru_entry = i;
+			}
+		}
+		entries.erase_at(lru_entry);
+	}
+	entries.push_back(std::move(entry));
+}
+
+void BigQueryReadSessionCache::Clear() {
+	lock_guard<mutex> guard(lock);
+	entries.clear();
+}
+
+} // namespace duckdb
@@ -8,6 +8,9 @@
 #include <arrow/record_batch.h>
 #include <arrow/status.h>
 #include "bigquery_result.hpp"
+#include "bigquery_utils.hpp"
+
+#include <algorithm>
 
 namespace bigquery_storage = ::google::cloud::bigquery_storage_v1;
 namespace bigquery_storage_read = ::google::cloud::bigquery::storage::v1;
@@ -33,4 +36,291 @@ std::shared_ptr<arrow::RecordBatch> BigQueryResult::GetArrowRecordBatch(
   return record_batch;
 }
 
+BigQueryStreamBatchReader::BigQueryStreamBatchReader(bigquery_storage::BigQueryReadClient client_p,
+                                                     const bigquery_storage_read::ReadSession &session,
+                                                     idx_t stream_idx, idx_t offset)
+    : client(std::move(client_p)), schema(BigQueryUtils::GetArrowSchema(session.arrow_schema())),
+      read_rows(client.ReadRows(session.streams(static_cast<int>(stream_idx)).name(), offset)),
+      current(read_rows.begin()) {
+}
+
+std::shared_ptr<arrow::RecordBatch> BigQueryStreamBatchReader::Next() {
+	if (current == read_rows.end()) {
+		return nullptr;
+	}
+	auto &response = *current;
+	if (!response.ok()) {
+		throw response.status();
+	}
+	auto record_batch = BigQueryResult::GetArrowRecordBatch(response->arrow_record_batch(), schema);
+	++current;
+	return record_batch;
+}
+
+//! The number of decoded batches the workers of a parallel reader may buffer ahead of the scan
+static constexpr idx_t PARALLEL_READER_MAX_BUFFERED_BATCHES = 32;
+
+void BigQueryParallelBatchReader::StartWorkers(idx_t first_task, idx_t task_count_p, idx_t parallelism) {
+	next_task = first_task;
+	task_count = task_count_p;
+	if (first_task >= task_count) {
+		return;
+	}
+	auto worker_count = MinValue<idx_t>(MaxValue<idx_t>(parallelism, 1), task_count - first_task);
+	running_workers = worker_count;
+	for (idx_t i = 0; i < worker_count; i++) {
+		workers.emplace_back([this]() { WorkerLoop(); });
+	}
+}
+
+void BigQueryParallelBatchReader::StopWorkers() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		cancelled = true;
+	}
+	space_available.notify_all();
+	for (auto &worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+}
+
+bool BigQueryParallelBatchReader::Emit(std::shared_ptr<arrow::RecordBatch> batch) {
+	std::unique_lock<std::mutex> guard(lock);
+	space_available.wait(guard,
+	                     [&]() { return cancelled || batches.size() < PARALLEL_READER_MAX_BUFFERED_BATCHES; });
+	if (cancelled) {
+		return false;
+	}
+	batches.push_back(std::move(batch));
+	batch_available.notify_one();
+	return true;
+}
+
+void BigQueryParallelBatchReader::WorkerLoop() {
+	try {
+		while (true) {
+			idx_t task_idx;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				if (cancelled || next_task >= task_count) {
+					break;
+				}
+				task_idx = next_task++;
+			}
+			ReadTask(task_idx);
+		}
+	} catch (...) {
+		std::lock_guard<std::mutex> guard(lock);
+		if (!error) {
+			error = std::current_exception();
+		}
+		cancelled = true;
+		space_available.notify_all();
+	}
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		running_workers--;
+	}
+	batch_available.notify_all();
+}
+
+std::shared_ptr<arrow::RecordBatch> BigQueryParallelBatchReader::Next() {
+	std::unique_lock<std::mutex> guard(lock);
+	batch_available.wait(guard, [&]() { return error || !batches.empty() || running_workers == 0; });
+	if (error) {
+		std::rethrow_exception(error);
+	}
+	if (batches.empty()) {
+		return nullptr;
+	}
+	auto batch = std::move(batches.front());
+	batches.pop_front();
+	space_available.notify_one();
+	return batch;
+}
+
+BigQueryShardedBatchReader::BigQueryShardedBatchReader(bigquery_storage::BigQueryReadClient client_p, string parent_p,
+                                                       const bigquery_storage_read::ReadSession &session_template_p,
+                                                       string table_prefix_p, vector<string> suffixes_p,
+                                                       idx_t parallelism)
+    : client(std::move(client_p)), parent(std::move(parent_p)), session_template(session_template_p),
+      table_prefix(std::move(table_prefix_p)), suffixes(std::move(suffixes_p)) {
+	// the newest shard has the schema of the wildcard table, for date-sharded tables it sorts last
+	std::sort(suffixes.rbegin(), suffixes.rend());
+	// BigQuery does not create streams (nor send a schema) for empty tables
+	for (first_shard = 0; first_shard < suffixes.size(); first_shard++) {
+		first_session = CreateSession(first_shard);
+		if (first_session->streams_size() > 0) {
+			break;
+		}
+	}
+	if (first_shard >= suffixes.size()) {
+		return;
+	}
+	// every selected column is part of the schema, the columns that even the newest shard with rows lacks read as NULL
+	auto shard_schema = BigQueryUtils::GetArrowSchema(first_session->arrow_schema());
+	arrow::FieldVector fields;
+	for (auto &selected_field : session_template.read_options().selected_fields()) {
+		auto column_name = selected_field.substr(0, selected_field.find('.'));
+		bool selected = false;
+		for (auto &field : fields) {
+			selected = selected || field->name() == column_name;
+		}
+		if (selected) {
+			continue;
+		}
+		auto field = shard_schema->GetFieldByName(column_name);
+		fields.push_back(field ? field : arrow::field(column_name, arrow::null()));
+	}
+	fields.push_back(arrow::field(WILDCARD_SUFFIX_COLUMN, arrow::utf8()));
+	schema = arrow::schema(std::move(fields));
+	StartWorkers(first_shard, suffixes.size(), parallelism);
+}
+
+BigQueryShardedBatchReader::~BigQueryShardedBatchReader() {
+	StopWorkers();
+}
+
+std::shared_ptr<bigquery_storage_read::ReadSession> BigQueryShardedBatchReader::CreateSession(idx_t shard_idx) {
+	auto shard_session = session_template;
+	shard_session.set_table(table_prefix + suffixes[shard_idx]);
+	auto session = client.CreateReadSession(parent, shard_session, 1);
+	if (!session && session.status().code() == google::cloud::StatusCode::kInvalidArgument) {
+		// older shards can lack columns that were added later, the session then only selects the columns they have
+		SelectShardFields(shard_session);
+		session = client.CreateReadSession(parent, shard_session, 1);
+	}
+	if (!session) {
+		throw std::move(session).status();
+	}
+	return std::make_shared<bigquery_storage_read::ReadSession>(*std::move(session));
+}
+
+void BigQueryShardedBatchReader::SelectShardFields(bigquery_storage_read::ReadSession &shard_session) {
+	// a session without read options has the full schema of the shard
+	auto schema_session = shard_session;
+	schema_session.clear_read_options();
+	auto session = client.CreateReadSession(parent, schema_session, 1);
+	if (!session) {
+		throw std::move(session).status();
+	}
+	if (session->streams_size() == 0) {
+		// nothing to read, the shard keeps its selection and fails as before
+		return;
+	}
+	auto shard_schema = BigQueryUtils::GetArrowSchema(session->arrow_schema());
+	auto &read_options = *shard_session.mutable_read_options();
+	auto selected_fields = read_options.selected_fields();
+	read_options.clear_selected_fields();
+	for (auto &selected_field : selected_fields) {
+		if (shard_schema->GetFieldIndex(selected_field.substr(0, selected_field.find('.'))) >= 0) {
+			read_options.add_selected_fields(selected_field);
+		}
+	}
+	if (read_options.selected_fields_size() == 0 && shard_schema->num_fields() > 0) {
+		// BigQuery reads every column when none is selected, only the row count matters
+		read_options.add_selected_fields(shard_schema->field(0)->name());
+	}
+}
+
+std::shared_ptr<arrow::RecordBatch> BigQueryShardedBatchReader::ConformBatch(const arrow::RecordBatch &batch,
+                                                                             const string &suffix) {
+	// the shards can differ in column order, and older shards can lack newer columns, which then read as NULL
+	auto row_count = batch.num_rows();
+	std::vector<std::shared_ptr<arrow::Array>> columns;
+	for (int i = 0; i + 1 < schema->num_fields(); i++) {
+		auto &field = schema->field(i);
+		auto column_idx = batch.schema()->GetFieldIndex(field->name());
+		if (column_idx >= 0) {
+			columns.push_back(batch.column(column_idx));
+			continue;
+		}
+		auto nulls = arrow::MakeArrayOfNull(field->type(), row_count);
+		if (!nulls.ok()) {
+			throw IOException("Failed to read wildcard table shard: " + nulls.status().message());
+		}
+		columns.push_back(nulls.ValueOrDie());
+	}
+	auto suffix_column = arrow::MakeArrayFromScalar(arrow::StringScalar(suffix), row_count);
+	if (!suffix_column.ok()) {
+		throw IOException("Failed to read wildcard table shard: " + suffix_column.status().message());
+	}
+	columns.push_back(suffix_column.ValueOrDie());
+	return arrow::RecordBatch::Make(schema, row_count, std::move(columns));
+}
+
+void BigQueryShardedBatchReader::ReadTask(idx_t task_idx) {
+	auto session = task_idx == first_shard ? first_session : CreateSession(task_idx);
+	if (session->streams_size() == 0) {
+		return;
+	}
+	BigQueryStreamBatchReader reader(client, *session, 0, 0);
+	while (auto batch = reader.Next()) {
+		if (!Emit(ConformBatch(*batch, suffixes[task_idx]))) {
+			return;
+		}
+	}
+}
+
+BigQueryMultiStreamBatchReader::BigQueryMultiStreamBatchReader(
+    bigquery_storage::BigQueryReadClient client_p, shared_ptr<const bigquery_storage_read::ReadSession> session_p,
+    idx_t parallelism)
+    : client(std::move(client_p)), session(std::move(session_p)),
+      schema(BigQueryUtils::GetArrowSchema(session->arrow_schema())) {
+	StartWorkers(0, static_cast<idx_t>(session->streams_size()), parallelism);
+}
+
+BigQueryMultiStreamBatchReader::~BigQueryMultiStreamBatchReader() {
+	StopWorkers();
+}
+
+void BigQueryMultiStreamBatchReader::ReadTask(idx_t task_idx) {
+	BigQueryStreamBatchReader reader(client, *session, task_idx, 0);
+	while (auto batch = reader.Next()) {
+		if (!Emit(std::move(batch))) {
+			return;
+		}
+	}
+}
+
+BigQueryAsyncBatchReader::BigQueryAsyncBatchReader(open_function_t open)
+    : cancelled(make_shared_ptr<std::atomic<bool>>(false)) {
+	// unlike the future of std::async, the future of a promise does not wait for the thread when it is destroyed
+	auto promise = make_shared_ptr<std::promise<unique_ptr<BigQueryBatchReader>>>();
+	pending_reader = promise->get_future();
+	std::thread([open, promise, cancelled = cancelled]() {
+		try {
+			promise->set_value(open(*cancelled));
+		} catch (...) {
+			promise->set_exception(std::current_exception());
+		}
+	}).detach();
+}
+
+BigQueryAsyncBatchReader::~BigQueryAsyncBatchReader() {
+	if (pending_reader.valid()) {
+		// e.g. the query was cancelled before the first batch. The open function stops at its next step, and the
+		// thread owns whatever it still opens, so this does not wait for e.g. a view's query job.
+		*cancelled = true;
+	}
+}
+
+BigQueryBatchReader *BigQueryAsyncBatchReader::WaitForReader() {
+	if (pending_reader.valid()) {
+		reader = pending_reader.get();
+	}
+	return reader.get();
+}
+
+std::shared_ptr<arrow::Schema> BigQueryAsyncBatchReader::GetSchema() {
+	auto opened_reader = WaitForReader();
+	return opened_reader ? opened_reader->GetSchema() : nullptr;
+}
+
+std::shared_ptr<arrow::RecordBatch> BigQueryAsyncBatchReader::Next() {
+	auto opened_reader = WaitForReader();
+	return opened_reader ? opened_reader->Next() : nullptr;
+}
+
 } // namespace duckdb
@@ -2,6 +2,7 @@
 #include "storage/bigquery_table_entry.hpp"
 #include "storage/bigquery_transaction.hpp"
 #include "storage/bigquery_catalog.hpp"
+#include "storage/bigquery_metadata_prefetch.hpp"
 
 #include "duckdb/parser/parsed_data/create_view_info.hpp"
 #include "duckdb/parser/parsed_data/create_schema_info.hpp"
@@ -135,7 +136,7 @@ optional_ptr<CatalogEntry> BigQuerySchemaEntry::CreateView(CatalogTransaction tr
 	}
 	auto &bigquery_transaction = GetBigQueryTransaction(transaction);
 	bigquery_transaction.Query(GetBigQueryCreateView(info));
-	return tables.RefreshTable(transaction.GetContext(), info.view_name);
+	return tables.RefreshTable(info.view_name);
 }
 
 optional_ptr<CatalogEntry> BigQuerySchemaEntry::CreateType(CatalogTransaction transaction, CreateTypeInfo &info) {
@@ -191,6 +192,17 @@ void BigQuerySchemaEntry::Scan(ClientContext &context, CatalogType type,
 	if (!CatalogTypeIsSupported(type)) {
 		return;
 	}
+	if (&GetCatalogSet(type) == &tables) {
+		// enumerating lists the table names only, their columns are fetched when a table is bound
+		catalog.Cast<BigQueryCatalog>().ListTables(context);
+		auto &transaction = BigQueryTransaction::Get(context, catalog);
+		tables.ScanLoaded([&](CatalogEntry &entry) {
+			// e.g. duckdb_tables() keeps the entries until it has produced its output
+			transaction.PinTable(entry.Cast<BigQueryTableEntry>());
+			callback(entry);
+		});
+		return;
+	}
 	GetCatalogSet(type).Scan(context, callback);
 }
 void BigQuerySchemaEntry::Scan(CatalogType type, const std::function<void(CatalogEntry &)> &callback) {
@@ -201,19 +213,62 @@ void BigQuerySchemaEntry::DropEntry(ClientContext &context, DropInfo &info) {
 	GetCatalogSet(info.type).DropEntry(context, info);
 }
 
+static bool TableEntryIsResolved(CatalogEntry &entry) {
+	// entries created by listing the dataset have no columns yet
+	return entry.Cast<BigQueryTableEntry>().resolved;
+}
+
+static bool TableEntryIsCurrent(CatalogEntry &entry) {
+	auto &table_entry = entry.Cast<BigQueryTableEntry>();
+	return table_entry.resolved && !table_entry.revalidate;
+}
+
+static optional_ptr<CatalogEntry> PinTableEntry(CatalogTransaction transaction, optional_ptr<CatalogEntry> entry) {
+	if (entry && transaction.transaction) {
+		// the binder and the planned query reference the entry until the transaction ends
+		transaction.transaction->Cast<BigQueryTransaction>().PinTable(entry->Cast<BigQueryTableEntry>());
+	}
+	return entry;
+}
+
 optional_ptr<CatalogEntry> BigQuerySchemaEntry::GetEntry(CatalogTransaction transaction, CatalogType type,
                                                       const string &name) {
 	if (!CatalogTypeIsSupported(type)) {
 		return nullptr;
 	}
-	auto entry = GetCatalogSet(type).GetEntry(transaction.GetContext(), name);
-	if(!entry && type != CatalogType::INDEX_ENTRY) {
-		//Printer::Print("BigQuerySchemaEntry::GetEntry not found creating");
-		// cast catalog to BigQueryCatalog
-		auto bq_catalog = dynamic_cast<BigQueryCatalog*>(&this->catalog);
-
-		auto info = this->GetInfo();
-		auto table_entry = BigQueryUtils::BigQueryCreateBigQueryTableEntry(
+	auto bq_catalog = dynamic_cast<BigQueryCatalog*>(&this->catalog);
+	auto &catalog_set = GetCatalogSet(type);
+	// a table that is resolved already, e.g. by the metadata prefetch of the statement, is used without loading the
+	// dataset's metadata first
+	auto entry = catalog_set.GetLoadedEntry(name);
+	if (!entry || !TableEntryIsResolved(*entry)) {
+		// unless the dataset is loaded already, the table is looked up on its own below instead of waiting for the
+		// metadata of the whole dataset, which is loaded in the background for the tables that are bound next
+		bool load_in_background =
+		    !catalog_set.IsLoaded() && bq_catalog->LoadDatasetInBackground(transaction.GetContext(), this->name);
+		if (!load_in_background) {
+			entry = catalog_set.GetEntry(transaction.GetContext(), name);
+		}
+	}
+	if (type == CatalogType::INDEX_ENTRY) {
+		return entry;
+	}
+	// connections other than the attaching one resolve the tables of their next queries up front
+	BigQueryMetadataPrefetch::Register(transaction.GetContext());
+	if (entry && TableEntryIsResolved(*entry)) {
+		// a stale entry is still returned, it is replaced in the background if the table changed
+		bq_catalog->RevalidateTable(transaction.GetContext(), entry->Cast<BigQueryTableEntry>());
+		return PinTableEntry(transaction, entry);
+	}
+	// concurrent binders of the same table share a single metadata request
+	entry = GetCatalogSet(type).LoadEntry(name, [&]() -> unique_ptr<CatalogEntry> {
+		if (StringUtil::EndsWith(name, "*")) {
+			// wildcard table over date-sharded tables
+			return BigQueryUtils::BigQueryCreateWildcardTableEntry(
+				catalog, *this, bq_catalog->execution_project, bq_catalog->storage_project, this->name, name,
+				bq_catalog->service_account_json);
+		}
+		return BigQueryUtils::BigQueryCreateBigQueryTableEntry(
 			catalog,
 			this,
 			bq_catalog->execution_project,
@@ -221,15 +276,29 @@ optional_ptr<CatalogEntry> BigQuerySchemaEntry::GetEntry(CatalogTransaction tran
 			this->name,
 			name,
 			bq_catalog->service_account_json);
-		//Printer::Print("BigQuerySchemaEntry::GetEntry creating table entry");
-		// print the columns from create_info inside table_info
-		// auto &columns = table_entry->GetColumns();
-		// for (auto &col : columns.GetColumnNames()) {
-		// 	Printer::Print("BigQuerySchemaEntry::GetEntry column: " + col);
-		// }
-		return GetCatalogSet(type).CreateEntry(std::move(table_entry));
-	}
-	return GetCatalogSet(type).GetEntry(transaction.GetContext(), name);
+	}, TableEntryIsResolved);
+	PinTableEntry(transaction, entry);
+	// the catalog only grows when metadata is loaded
+	BigQueryCatalog::EnforceMemoryLimit(transaction.GetContext());
+	return entry;
+}
+
+optional_ptr<BigQueryTableEntry> BigQuerySchemaEntry::PreloadTable(const string &name) {
+	auto &bq_catalog = catalog.Cast<BigQueryCatalog>();
+	auto entry = tables.LoadEntry(name, [&]() -> unique_ptr<CatalogEntry> {
+		return BigQueryUtils::BigQueryCreateBigQueryTableEntry(
+			catalog,
+			this,
+			bq_catalog.execution_project,
+			bq_catalog.storage_project,
+			this->name,
+			name,
+			bq_catalog.service_account_json);
+	}, TableEntryIsCurrent);
+	if (!entry) {
+		return nullptr;
+	}
+	return &entry->Cast<BigQueryTableEntry>();
 }
 
 BigQueryCatalogSet &BigQuerySchemaEntry::GetCatalogSet(CatalogType type) {
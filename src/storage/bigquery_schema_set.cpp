@@ -1,6 +1,9 @@
 #include "storage/bigquery_schema_set.hpp"
 #include "storage/bigquery_transaction.hpp"
 #include "duckdb/parser/parsed_data/create_schema_info.hpp"
+#include "storage/bigquery_catalog.hpp"
+#include "storage/bigquery_schema_entry.hpp"
+#include "bigquery_utils.hpp"
 
 namespace duckdb {
 
@@ -15,21 +18,20 @@ BigQuerySchemaSet::BigQuerySchemaSet(Catalog &catalog) : BigQueryCatalogSet(cata
 }
 
 void BigQuerySchemaSet::LoadEntries(ClientContext &context) {
-	// TODO implement this, we don't have access to the catalog with current BQ C++ API
-// 	auto query = R"(
-// SELECT schema_name
-// FROM information_schema.schemata;
-// )";
-
-	//auto &transaction = BigQueryTransaction::Get(context, catalog);
-	//auto result = transaction.Query(query);
-	//while (result->Next()) {
-	// CreateSchemaInfo info;
-	// info.schema = result->GetString(0);
-	// info.internal = BigQuerySchemaIsInternal(info.schema);
-	// auto schema = make_uniq<BigQuerySchemaEntry>(catalog, info);
-	// CreateEntry(std::move(schema));
-	// }
+	auto &bq_catalog = catalog.Cast<BigQueryCatalog>();
+	vector<string> datasets;
+	try {
+		datasets = BigQueryUtils::BigQueryListDatasets(bq_catalog.storage_project, bq_catalog.service_account_json);
+	} catch (std::exception &) {
+		// e.g. no permission to list the datasets, which are then only known once they are referenced
+		return;
+	}
+	for (auto &dataset : datasets) {
+		CreateSchemaInfo info;
+		info.catalog = bq_catalog.storage_project;
+		info.schema = dataset;
+		CreateEntry(make_uniq<BigQuerySchemaEntry>(catalog, info));
+	}
 }
 
 optional_ptr<CatalogEntry> BigQuerySchemaSet::CreateSchema(ClientContext &context, CreateSchemaInfo &info) {
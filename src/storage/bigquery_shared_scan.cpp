@@ -0,0 +1,239 @@
+#include "storage/bigquery_shared_scan.hpp"
+#include "bigquery_utils.hpp"
+
+namespace duckdb {
+
+//! Beyond this many buffered batches, the slowest consumers are left behind to read from their own stream
+static constexpr idx_t SHARED_SCAN_MAX_WINDOW_BATCHES = 16;
+
+class BigQuerySharedScanReader : public BigQueryBatchReader {
+public:
+	BigQuerySharedScanReader(shared_ptr<BigQuerySharedScan> scan_p, idx_t consumer_id_p)
+	    : scan(std::move(scan_p)), consumer_id(consumer_id_p) {
+	}
+	~BigQuerySharedScanReader() override {
+		scan->Detach(consumer_id);
+	}
+
+	std::shared_ptr<arrow::Schema> GetSchema() override {
+		return scan->schema;
+	}
+	std::shared_ptr<arrow::RecordBatch> Next() override {
+		return scan->Next(consumer_id);
+	}
+
+private:
+	shared_ptr<BigQuerySharedScan> scan;
+	idx_t consumer_id;
+};
+
+BigQuerySharedScan::BigQuerySharedScan(BigQueryScanCacheKey key_p) : key(std::move(key_p)) {
+}
+
+void BigQuerySharedScan::Start(bigquery_storage::BigQueryReadClient client,
+                               shared_ptr<const bigquery_storage_read::ReadSession> session) {
+	Start([client, session](idx_t offset) -> unique_ptr<BigQueryBatchReader> {
+		return make_uniq<BigQueryStreamBatchReader>(client, *session, 0, offset);
+	});
+}
+
+void BigQuerySharedScan::Start(open_stream_t open_stream_p) {
+	auto new_producer = open_stream_p(0);
+	{
+		lock_guard<mutex> guard(lock);
+		open_stream = std::move(open_stream_p);
+		schema = new_producer->GetSchema();
+		producer = std::move(new_producer);
+		started = true;
+	}
+	state_changed.notify_all();
+}
+
+void BigQuerySharedScan::Fail() {
+	{
+		lock_guard<mutex> guard(lock);
+		failed = true;
+	}
+	state_changed.notify_all();
+}
+
+bool BigQuerySharedScan::IsJoinable() {
+	lock_guard<mutex> guard(lock);
+	return !failed && !exhausted;
+}
+
+unique_ptr<BigQueryBatchReader> BigQuerySharedScan::Attach(shared_ptr<BigQuerySharedScan> scan) {
+	idx_t consumer_id;
+	{
+		unique_lock<mutex> guard(scan->lock);
+		scan->state_changed.wait(guard, [&]() { return scan->started || scan->failed; });
+		if (scan->failed) {
+			return nullptr;
+		}
+		consumer_id = scan->next_consumer_id++;
+		auto &consumer = scan->consumers[consumer_id];
+		// a late consumer first reads the rows that have already left the window from its own stream
+		consumer.behind = scan->window_start > 0;
+	}
+	return make_uniq<BigQuerySharedScanReader>(std::move(scan), consumer_id);
+}
+
+std::shared_ptr<arrow::RecordBatch> BigQuerySharedScan::Next(idx_t consumer_id) {
+	unique_lock<mutex> guard(lock);
+	// elements of an unordered_map stay in place while other consumers attach or detach
+	auto &consumer = consumers[consumer_id];
+	while (true) {
+		if (consumer.behind) {
+			std::shared_ptr<arrow::RecordBatch> batch;
+			if (CatchUp(consumer, guard, batch)) {
+				return batch;
+			}
+			continue;
+		}
+		if (consumer.next_batch < window_start + window.size()) {
+			break;
+		}
+		if (exhausted) {
+			return nullptr;
+		}
+		if (fetching) {
+			state_changed.wait(guard);
+			continue;
+		}
+		// this consumer is ahead of the others, it reads the next batch for all of them
+		fetching = true;
+		guard.unlock();
+		std::shared_ptr<arrow::RecordBatch> batch;
+		try {
+			batch = producer->Next();
+		} catch (...) {
+			guard.lock();
+			fetching = false;
+			state_changed.notify_all();
+			throw;
+		}
+		guard.lock();
+		fetching = false;
+		if (batch) {
+			window.push_back(std::move(batch));
+		} else {
+			exhausted = true;
+		}
+		state_changed.notify_all();
+	}
+	auto batch = window[consumer.next_batch - window_start];
+	consumer.next_batch++;
+	consumer.row += static_cast<idx_t>(batch->num_rows());
+	TrimWindow();
+	return batch;
+}
+
+bool BigQuerySharedScan::TryRejoin(Consumer &consumer, idx_t min_row, idx_t max_row, idx_t &rejoin_row) {
+	auto batch_start_row = window_start_row;
+	for (idx_t i = 0; i <= window.size(); i++) {
+		if (batch_start_row >= min_row && batch_start_row <= max_row) {
+			consumer.behind = false;
+			consumer.next_batch = window_start + i;
+			rejoin_row = batch_start_row;
+			return true;
+		}
+		if (i < window.size()) {
+			batch_start_row += static_cast<idx_t>(window[i]->num_rows());
+		}
+	}
+	return false;
+}
+
+bool BigQuerySharedScan::CatchUp(Consumer &consumer, unique_lock<mutex> &guard,
+                                 std::shared_ptr<arrow::RecordBatch> &result) {
+	idx_t rejoin_row;
+	if (TryRejoin(consumer, consumer.row, consumer.row, rejoin_row)) {
+		consumer.reader.reset();
+		return false;
+	}
+	// open_stream does not change after Start, only this consumer uses its own stream
+	if (!consumer.reader) {
+		auto row = consumer.row;
+		guard.unlock();
+		auto reader = open_stream(row);
+		guard.lock();
+		consumer.reader = std::move(reader);
+	}
+	guard.unlock();
+	auto batch = consumer.reader->Next();
+	guard.lock();
+	if (!batch) {
+		result = nullptr;
+		return true;
+	}
+	auto batch_start_row = consumer.row;
+	auto batch_end_row = batch_start_row + static_cast<idx_t>(batch->num_rows());
+	if (TryRejoin(consumer, batch_start_row + 1, batch_end_row, rejoin_row)) {
+		// emit the rows up to the window batch, and continue from the window
+		consumer.reader.reset();
+		batch = batch->Slice(0, static_cast<int64_t>(rejoin_row - batch_start_row));
+		batch_end_row = rejoin_row;
+	}
+	consumer.row = batch_end_row;
+	result = std::move(batch);
+	return true;
+}
+
+void BigQuerySharedScan::Detach(idx_t consumer_id) {
+	{
+		lock_guard<mutex> guard(lock);
+		consumers.erase(consumer_id);
+		TrimWindow();
+	}
+	state_changed.notify_all();
+}
+
+void BigQuerySharedScan::TrimWindow() {
+	auto min_batch = window_start + window.size();
+	for (auto &entry : consumers) {
+		if (!entry.second.behind) {
+			min_batch = MinValue<idx_t>(min_batch, entry.second.next_batch);
+		}
+	}
+	while (!window.empty() && (window_start < min_batch || window.size() > SHARED_SCAN_MAX_WINDOW_BATCHES)) {
+		window_start_row += static_cast<idx_t>(window.front()->num_rows());
+		window.pop_front();
+		window_start++;
+	}
+	for (auto &entry : consumers) {
+		auto &consumer = entry.second;
+		if (!consumer.behind && consumer.next_batch < window_start) {
+			// the consumer continues from its own stream at the row it has reached
+			consumer.behind = true;
+		}
+	}
+}
+
+bool BigQuerySharedScans::IsEnabled(ClientContext &context) {
+	Value setting;
+	return context.TryGetCurrentSetting("bigquery_shared_scans", setting) && BooleanValue::Get(setting);
+}
+
+shared_ptr<BigQuerySharedScan> BigQuerySharedScans::GetOrCreate(const BigQueryScanCacheKey &key, bool &created) {
+	lock_guard<mutex> guard(lock);
+	shared_ptr<BigQuerySharedScan> result;
+	for (idx_t i = 0; i < scans.size(); i++) {
+		auto scan = scans[i].lock();
+		if (!scan || !scan->IsJoinable()) {
+			scans.erase_at(i);
+			i--;
+			continue;
+		}
+		if (!result && scan->key.Covers(key)) {
+			result = std::move(scan);
+		}
+	}
+	created = !result;
+	if (created) {
+		result = make_shared_ptr<BigQuerySharedScan>(key);
+		scans.push_back(result);
+	}
+	return result;
+}
+
+} // namespace duckdb
@@ -0,0 +1,111 @@
+#include "storage/bigquery_table_cache.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+
+#include <algorithm>
+
+namespace duckdb {
+
+static int64_t CurrentTimeMs() {
+	return Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp());
+}
+
+int64_t BigQueryTableCache::GetTTL(ClientContext &context) {
+	Value ttl;
+	if (!context.TryGetCurrentSetting("bigquery_table_cache_ttl", ttl) || ttl.IsNull()) {
+		return 0;
+	}
+	return UBigIntValue::Get(ttl) * 1000;
+}
+
+idx_t BigQueryTableCache::GetMaxBytes(ClientContext &context) {
+	Value max_bytes;
+	if (!context.TryGetCurrentSetting("bigquery_table_cache_max_bytes", max_bytes) || max_bytes.IsNull()) {
+		return NumericLimits<idx_t>::Maximum();
+	}
+	return UBigIntValue::Get(max_bytes);
+}
+
+static bool ContainsColumns(const BigQueryTableCacheEntry &entry, const vector<column_t> &column_ids) {
+	for (auto &column_id : column_ids) {
+		if (std::find(entry.column_ids.begin(), entry.column_ids.end(), column_id) == entry.column_ids.end()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+shared_ptr<BigQueryTableCacheEntry> BigQueryTableCache::TryGet(const BigQueryScanCacheKey &key,
+                                                               const vector<column_t> &column_ids, int64_t ttl) {
+	lock_guard<mutex> guard(lock);
+	auto now = CurrentTimeMs();
+	shared_ptr<BigQueryTableCacheEntry> result;
+	for (idx_t i = 0; i < entries.size(); i++) {
+		auto &entry = *entries[i];
+		bool stale = entry.key.table == key.table && entry.key.version != key.version;
+		if (stale || now - entry.created > ttl) {
+			// running scans keep their reference to the collection
+			entries.erase_at(i);
+			i--;
+			continue;
+		}
+		if (!entry.key.Covers(key) || !ContainsColumns(entry, column_ids)) {
+			continue;
+		}
+		if (!result || entry.collection->SizeInBytes() < result->collection->SizeInBytes()) {
+			result = entries[i];
+		}
+	}
+	if (result) {
+		result->last_access = now;
+	}
+	return result;
+}
+
+void BigQueryTableCache::RemoveExpiredEntries(int64_t now, int64_t ttl) {
+	for (idx_t i = 0; i < entries.size(); i++) {
+		if (now - entries[i]->created > ttl) {
+			entries.erase_at(i);
+			i--;
+		}
+	}
+}
+
+void BigQueryTableCache::Put(shared_ptr<BigQueryTableCacheEntry> entry, int64_t ttl, idx_t max_bytes) {
+	lock_guard<mutex> guard(lock);
+	auto now = CurrentTimeMs();
+	entry->created = now;
+	entry->last_access = now;
+	// expired entries are dropped here as well, lookups may not come by again
+	RemoveExpiredEntries(now, ttl);
+	for (idx_t i = 0; i < entries.size(); i++) {
+		// drop entries that are superseded by the new one
+		if (entry->key.Covers(entries[i]->key) && ContainsColumns(*entry, entries[i]->column_ids)) {
+			entries.erase_at(i);
+			i--;
+		}
+	}
+	entries.push_back(std::move(entry));
+
+	// the buffer manager spills collections instead of freeing them, so the cache itself is kept within its limit
+	idx_t total_size = 0;
+	for (auto &cached_entry : entries) {
+		total_size += cached_entry->collection->SizeInBytes();
+	}
+	while (total_size > max_bytes && !entries.empty()) {
+		idx_t lru_entry = 0;
+		for (idx_t i = 1; i < entries.size(); i++) {
+			if (entries[i]->last_access < entries[lru_entry]->last_access) {
+				lru_entry = i;
+			}
+		}
+		total_size -= entries[lru_entry]->collection->SizeInBytes();
+		entries.erase_at(lru_entry);
+	}
+}
+
+void BigQueryTableCache::Clear() {
+	lock_guard<mutex> guard(lock);
+	entries.clear();
+}
+
+} // namespace duckdb
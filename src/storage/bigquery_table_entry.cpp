@@ -4,8 +4,13 @@
 #include "storage/bigquery_transaction.hpp"
 #include "duckdb/storage/statistics/base_statistics.hpp"
 #include "duckdb/storage/table_storage_info.hpp"
+#include "duckdb/catalog/catalog_entry/table_function_catalog_entry.hpp"
+#include "duckdb/common/error_data.hpp"
+#include "duckdb/main/extension_helper.hpp"
 #include "bigquery_scanner.hpp"
 
+#include <algorithm>
+
 namespace duckdb {
 
 static bool TableIsInternal(const SchemaCatalogEntry &schema, const string &name) {
@@ -36,8 +41,78 @@ void BigQueryTableEntry::BindUpdateConstraints(Binder &binder, LogicalGet &get,
 	                                   ClientContext &context) {
 }
 
+bool BigQueryTableEntry::TryBindExternalScan(ClientContext &context, const string &external_format,
+                                             const vector<string> &external_uris, bool hive_partitioning,
+                                             const ColumnList &columns, TableFunction &function,
+                                             unique_ptr<FunctionData> &bind_data) {
+	Value setting;
+	if (!context.TryGetCurrentSetting("bigquery_external_tables_direct", setting) || !BooleanValue::Get(setting)) {
+		return false;
+	}
+	// DuckDB does not read ORC, other formats go through BigQuery
+	if (external_format != "PARQUET" || external_uris.empty()) {
+		return false;
+	}
+	ExtensionHelper::TryAutoLoadExtension(context, "parquet");
+	auto parquet_scan = Catalog::GetSystemCatalog(context).GetEntry<TableFunctionCatalogEntry>(
+	    context, DEFAULT_SCHEMA, "parquet_scan", OnEntryNotFound::RETURN_NULL);
+	if (!parquet_scan) {
+		return false;
+	}
+	function = parquet_scan->functions.GetFunctionByArguments(context, {LogicalType::LIST(LogicalType::VARCHAR)});
+
+	vector<Value> uris;
+	for (auto &uri : external_uris) {
+		uris.emplace_back(uri);
+	}
+	vector<Value> inputs {Value::LIST(LogicalType::VARCHAR, std::move(uris))};
+	named_parameter_map_t named_parameters;
+	if (hive_partitioning) {
+		// the partition keys become columns, and filters on them skip whole directories
+		named_parameters["hive_partitioning"] = Value::BOOLEAN(true);
+	}
+	vector<LogicalType> input_table_types;
+	vector<string> input_table_names;
+	TableFunctionBindInput bind_input(inputs, named_parameters, input_table_types, input_table_names,
+	                                  function.function_info.get());
+	vector<LogicalType> return_types;
+	vector<string> names;
+	unique_ptr<FunctionData> parquet_bind_data;
+	try {
+		parquet_bind_data = function.bind(context, bind_input, return_types, names);
+	} catch (std::exception &ex) {
+		// e.g. the files are not accessible with DuckDB's credentials or are not Parquet files after all, BigQuery
+		// reads them instead
+		ErrorData error(ex);
+		if (error.Type() == ExceptionType::INTERRUPT) {
+			throw;
+		}
+		return false;
+	}
+
+	// the scan is planned against the columns of the table entry, which the files have to match exactly
+	if (names.size() != columns.LogicalColumnCount()) {
+		return false;
+	}
+	for (auto &column : columns.Logical()) {
+		auto column_idx = column.Logical().index;
+		if (!StringUtil::CIEquals(names[column_idx], column.GetName()) || return_types[column_idx] != column.GetType()) {
+			return false;
+		}
+	}
+	bind_data = std::move(parquet_bind_data);
+	return true;
+}
+
 TableFunction BigQueryTableEntry::GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data) {
 	//Printer::Print("BigQueryTableEntry::GetScanFunction");
+	if (!external_format.empty()) {
+		TableFunction external_function;
+		if (TryBindExternalScan(context, external_format, external_uris, external_hive_partitioning, columns,
+		                        external_function, bind_data)) {
+			return external_function;
+		}
+	}
 
 	auto scan_bind_data = make_uniq<BigQueryScanBindData>(*this);
 
@@ -46,7 +121,18 @@ TableFunction BigQueryTableEntry::GetScanFunction(ClientContext &context, unique
 		scan_bind_data->column_names.push_back(col.GetName());
 	}
 
-	scan_bind_data-> service_account_json = this->catalog.Cast<BigQueryCatalog>().service_account_json;
+	scan_bind_data->estimated_rows = num_rows;
+	scan_bind_data->estimated_bytes = num_bytes;
+	// reading the matching keys first only saves work if BigQuery can locate the rows of a key, which it can if the
+	// table is clustered on the key. Otherwise the second phase scans as much as a single-phase read.
+	if (!primary_key.empty() && primary_key.size() <= clustering_fields.size() &&
+	    std::equal(primary_key.begin(), primary_key.end(), clustering_fields.begin())) {
+		scan_bind_data->key_columns = primary_key;
+	}
+	if (wildcard) {
+		scan_bind_data->suffix_column = columns.GetColumn(string(WILDCARD_SUFFIX_COLUMN)).Oid();
+		scan_bind_data->shard_suffixes = shard_suffixes;
+	}
 
 	bind_data = std::move(scan_bind_data);
 
@@ -55,15 +141,54 @@ TableFunction BigQueryTableEntry::GetScanFunction(ClientContext &context, unique
 	if (context.TryGetCurrentSetting("bigquery_filter_pushdown", filter_pushdown)) {
 		//Printer::Print("BigQueryTableEntry::GetScanFunction filter_pushdown: " + filter_pushdown.ToString());
 		function.filter_pushdown = BooleanValue::Get(filter_pushdown);
+		if (!function.filter_pushdown) {
+			function.pushdown_complex_filter = nullptr;
+		}
 	}
 	return function;
 }
 
+static idx_t EstimateTypeSize(const LogicalType &type) {
+	idx_t size = sizeof(LogicalType);
+	switch (type.id()) {
+	case LogicalTypeId::STRUCT:
+		for (auto &child : StructType::GetChildTypes(type)) {
+			size += child.first.size() + EstimateTypeSize(child.second);
+		}
+		break;
+	case LogicalTypeId::LIST:
+		size += EstimateTypeSize(ListType::GetChildType(type));
+		break;
+	default:
+		break;
+	}
+	return size;
+}
+
+static idx_t EstimateStringsSize(const vector<string> &strings) {
+	idx_t size = 0;
+	for (auto &str : strings) {
+		size += sizeof(string) + str.size();
+	}
+	return size;
+}
+
+idx_t BigQueryTableEntry::EstimateMemoryUsage() const {
+	idx_t size = sizeof(BigQueryTableEntry) + name.size() + table_type.size() + last_modified_time.size() +
+	             etag.size() + partition_column.size() + shard_prefix.size();
+	for (auto &column : columns.Logical()) {
+		size += sizeof(ColumnDefinition) + column.GetName().size() + EstimateTypeSize(column.GetType());
+	}
+	size += EstimateStringsSize(primary_key) + EstimateStringsSize(clustering_fields) +
+	        EstimateStringsSize(external_uris) + EstimateStringsSize(shard_suffixes);
+	return size;
+}
+
 TableStorageInfo BigQueryTableEntry::GetStorageInfo(ClientContext &context) {
 	//auto &transaction = Transaction::Get(context, catalog).Cast<BigQueryTransaction>();
 	//auto &db = transaction.GetConnection();
 	TableStorageInfo result;
-	result.cardinality = 0;
+	result.cardinality = num_rows;
 	//result.index_info = db.GetIndexInfo(name);
 	return result;
 }
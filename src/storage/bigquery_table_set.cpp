@@ -9,7 +9,10 @@
 #include "duckdb/parser/parsed_data/create_table_info.hpp"
 #include "duckdb/parser/constraints/list.hpp"
 #include "storage/bigquery_schema_entry.hpp"
+#include "storage/bigquery_catalog.hpp"
+#include "bigquery_utils.hpp"
 #include "duckdb/parser/parser.hpp"
+#include "duckdb/common/types/timestamp.hpp"
 
 namespace duckdb {
 
@@ -47,37 +50,81 @@ void BigQueryTableSet::AddColumn(ClientContext &context, BigQueryResult &result,
 }
 
 void BigQueryTableSet::LoadEntries(ClientContext &context) {
-// 	auto query = StringUtil::Replace(R"(
-// SELECT table_name, column_name, data_type, column_type, column_default, is_nullable, numeric_precision, numeric_scale
-// FROM information_schema.columns
-// WHERE table_schema=${SCHEMA_NAME}
-// ORDER BY table_name, ordinal_position;
-// )",
-// 	                                 "${SCHEMA_NAME}", BigQueryUtils::WriteLiteral(schema.name));
+	Value load_dataset_metadata;
+	if (context.TryGetCurrentSetting("bigquery_load_dataset_metadata", load_dataset_metadata) &&
+	    !BooleanValue::Get(load_dataset_metadata)) {
+		return;
+	}
+	LoadDatasetMetadata();
+}
 
-// 	auto &transaction = BigQueryTransaction::Get(context, catalog);
-// 	auto result = transaction.Query(query);
+bool BigQueryTableSet::LoadDatasetMetadata() {
+	// one query instead of a tables.get call per table that is bound
+	auto &bq_catalog = catalog.Cast<BigQueryCatalog>();
+	vector<unique_ptr<BigQueryTableEntry>> table_entries;
+	try {
+		table_entries = BigQueryUtils::BigQueryCreateDatasetTableEntries(
+		    catalog, schema, bq_catalog.execution_project, bq_catalog.storage_project, schema.name,
+		    bq_catalog.service_account_json);
+	} catch (std::exception &) {
+		// e.g. no access to INFORMATION_SCHEMA, the tables are then looked up one at a time as they are bound
+		return false;
+	}
+	for (auto &table_entry : table_entries) {
+		// replace the unresolved entries of a listing that happened first
+		auto existing = GetLoadedEntry(table_entry->name);
+		if (existing && ((existing->Cast<BigQueryTableEntry>().resolved &&
+		                  !existing->Cast<BigQueryTableEntry>().revalidate) ||
+		                 !table_entry->resolved)) {
+			continue;
+		}
+		ReplaceEntry(std::move(table_entry));
+	}
+	// every table of the dataset now has an entry
+	is_listed = true;
+	return true;
+}
 
-// 	vector<unique_ptr<BigQueryTableInfo>> tables;
-// 	unique_ptr<BigQueryTableInfo> info;
+static void CacheTableMetadata(BigQuerySchemaEntry &schema, CatalogEntry &entry) {
+	auto &table_entry = entry.Cast<BigQueryTableEntry>();
+	auto metadata_cache = schema.ParentCatalog().Cast<BigQueryCatalog>().GetMetadataCache();
+	if (!metadata_cache || !table_entry.resolved || table_entry.revalidate || table_entry.wildcard) {
+		return;
+	}
+	metadata_cache->Put(schema.name, table_entry);
+}
 
-// 	while (result->Next()) {
-// 		auto table_name = result->GetString(0);
-// 		if (!info || info->GetTableName() != table_name) {
-// 			if (info) {
-// 				tables.push_back(std::move(info));
-// 			}
-// 			info = make_uniq<BigQueryTableInfo>(schema, table_name);
-// 		}
-// 		AddColumn(context, *result, *info, 1);
-// 	}
-// 	if (info) {
-// 		tables.push_back(std::move(info));
-// 	}
-// 	for (auto &tbl_info : tables) {
-// 		auto table_entry = make_uniq<BigQueryTableEntry>(catalog, schema, *tbl_info);
-// 		CreateEntry(std::move(table_entry));
-//	}
+optional_ptr<CatalogEntry> BigQueryTableSet::CreateEntry(unique_ptr<CatalogEntry> entry) {
+	auto result = BigQueryInSchemaSet::CreateEntry(std::move(entry));
+	CacheTableMetadata(schema, *result);
+	return result;
+}
+
+optional_ptr<CatalogEntry> BigQueryTableSet::ReplaceEntry(unique_ptr<CatalogEntry> entry) {
+	auto result = BigQueryInSchemaSet::ReplaceEntry(std::move(entry));
+	CacheTableMetadata(schema, *result);
+	return result;
+}
+
+idx_t BigQueryTableSet::GetEntrySize(CatalogEntry &entry) {
+	return entry.Cast<BigQueryTableEntry>().EstimateMemoryUsage();
+}
+
+void BigQueryTableSet::TouchEntry(CatalogEntry &entry) {
+	entry.Cast<BigQueryTableEntry>().last_access = Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp());
+}
+
+void BigQueryTableSet::AddListedTables(const vector<string> &table_names) {
+	for (auto &table_name : table_names) {
+		if (GetLoadedEntry(table_name)) {
+			continue;
+		}
+		BigQueryTableInfo table_info(schema.name, table_name);
+		auto table_entry = make_uniq<BigQueryTableEntry>(catalog, schema, table_info);
+		table_entry->resolved = false;
+		CreateEntry(std::move(table_entry));
+	}
+	is_listed = true;
 }
 
 // string GetTableInfoQuery(const string &schema_name, const string &table_name) {
@@ -105,12 +152,18 @@ unique_ptr<BigQueryTableInfo> BigQueryTableSet::GetTableInfo(ClientContext &cont
 	return nullptr;
 }
 
-optional_ptr<CatalogEntry> BigQueryTableSet::RefreshTable(ClientContext &context, const string &table_name) {
-	auto table_info = GetTableInfo(context, schema, table_name);
-	auto table_entry = make_uniq<BigQueryTableEntry>(catalog, schema, *table_info);
-	auto table_ptr = table_entry.get();
-	CreateEntry(std::move(table_entry));
-	return table_ptr;
+optional_ptr<CatalogEntry> BigQueryTableSet::RefreshTable(const string &table_name) {
+	// re-read the metadata, e.g. to pick up a view after CREATE VIEW
+	auto &bq_catalog = catalog.Cast<BigQueryCatalog>();
+	auto entry = LoadEntry(table_name, [&]() -> unique_ptr<CatalogEntry> {
+		return BigQueryUtils::BigQueryCreateBigQueryTableEntry(
+		    catalog, &schema, bq_catalog.execution_project, bq_catalog.storage_project, schema.name, table_name,
+		    bq_catalog.service_account_json);
+	}, [](CatalogEntry &) { return false; });
+	if (!entry) {
+		throw CatalogException("Failed to read the metadata of BigQuery table \"%s\"", table_name);
+	}
+	return entry;
 }
 
 // FIXME - this is almost entirely copied from TableCatalogEntry::ColumnsToSQL -
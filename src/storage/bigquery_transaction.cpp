@@ -1,5 +1,6 @@
 #include "storage/bigquery_transaction.hpp"
 #include "storage/bigquery_catalog.hpp"
+#include "storage/bigquery_table_entry.hpp"
 #include "duckdb/parser/parsed_data/create_view_info.hpp"
 #include "duckdb/catalog/catalog_entry/index_catalog_entry.hpp"
 #include "duckdb/catalog/catalog_entry/view_catalog_entry.hpp"
@@ -12,7 +13,11 @@ BigQueryTransaction::BigQueryTransaction(BigQueryCatalog &bigquery_catalog, Tran
 	//connection = BigQueryConnection::Open(bigquery_catalog.path);
 }
 
-BigQueryTransaction::~BigQueryTransaction() = default;
+BigQueryTransaction::~BigQueryTransaction() {
+	for (auto table_entry : pinned_tables) {
+		table_entry->pin_count--;
+	}
+}
 
 void BigQueryTransaction::Start() {
 	transaction_state = BigQueryTransactionState::TRANSACTION_NOT_YET_STARTED;
@@ -57,6 +62,27 @@ unique_ptr<BigQueryResult> BigQueryTransaction::Query(const string &query) {
 	return nullptr;
 }
 
+timestamp_t BigQueryTransaction::GetSnapshotTime(ClientContext &context) {
+	if (has_snapshot) {
+		return snapshot_time;
+	}
+	Value setting;
+	if (context.TryGetCurrentSetting("bigquery_snapshot_time", setting) && !setting.IsNull()) {
+		snapshot_time = setting.GetValue<timestamp_t>();
+		time_travel = true;
+	} else {
+		snapshot_time = Timestamp::GetCurrentTimestamp();
+	}
+	has_snapshot = true;
+	return snapshot_time;
+}
+
+void BigQueryTransaction::PinTable(BigQueryTableEntry &table_entry) {
+	if (pinned_tables.insert(&table_entry).second) {
+		table_entry.pin_count++;
+	}
+}
+
 BigQueryTransaction &BigQueryTransaction::Get(ClientContext &context, Catalog &catalog) {
 	return Transaction::Get(context, catalog).Cast<BigQueryTransaction>();
 }
@@ -0,0 +1,56 @@
+#include "storage/bigquery_view_cache.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+
+namespace duckdb {
+
+//! The number of query results that are remembered, older ones are dropped beyond it
+static constexpr idx_t VIEW_CACHE_MAX_ENTRIES = 256;
+
+static int64_t CurrentTimeMs() {
+	return Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp());
+}
+
+int64_t BigQueryViewCache::GetTTL(ClientContext &context) {
+	Value ttl;
+	if (!context.TryGetCurrentSetting("bigquery_view_cache_ttl", ttl) || ttl.IsNull()) {
+		return 0;
+	}
+	return UBigIntValue::Get(ttl) * 1000;
+}
+
+string BigQueryViewCache::TryGet(const string &query, int64_t ttl_ms) {
+	lock_guard<mutex> guard(lock);
+	auto entry = entries.find(query);
+	if (entry == entries.end()) {
+		return string();
+	}
+	if (CurrentTimeMs() - entry->second.created >= ttl_ms) {
+		entries.erase(entry);
+		return string();
+	}
+	return entry->second.destination_table;
+}
+
+void BigQueryViewCache::Put(const string &query, string destination_table) {
+	lock_guard<mutex> guard(lock);
+	auto now = CurrentTimeMs();
+	if (entries.size() >= VIEW_CACHE_MAX_ENTRIES && entries.find(query) == entries.end()) {
+		auto oldest = entries.begin();
+		for (auto it = entries.begin(); it != entries.end(); it++) {
+			if (it->second.created < oldest->second.created) {
+				oldest = it;
+			}
+		}
+		entries.erase(oldest);
+	}
+	auto &entry = entries[query];
+	entry.destination_table = std::move(destination_table);
+	entry.created = now;
+}
+
+void BigQueryViewCache::Clear() {
+	lock_guard<mutex> guard(lock);
+	entries.clear();
+}
+
+} // namespace duckdb
@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+#include "duckdb.hpp"
+#include "bigquery_storage.hpp"
+#include "storage/bigquery_catalog.hpp"
+#include "storage/bigquery_schema_entry.hpp"
+#include "storage/bigquery_table_set.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/main/attached_database.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/main/database_manager.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace duckdb {
+
+//! Attaches a BigQuery catalog without talking to BigQuery, its entries are created by the tests
+class BigQueryCatalogSetTest : public ::testing::Test {
+protected:
+	BigQueryCatalogSetTest() : db(nullptr), con(db) {
+		auto &config = DBConfig::GetConfig(*db.instance);
+		config.storage_extensions["duckdb_bigquery"] = make_uniq<BigQueryStorageExtension>();
+		config.AddExtensionOption("bigquery_catalog_max_bytes", "", LogicalType::UBIGINT, Value::UBIGINT(0));
+		auto result = con.Query("ATTACH 'test_project' AS bq (TYPE duckdb_bigquery)");
+		if (result->HasError()) {
+			throw std::runtime_error(result->GetError());
+		}
+		auto attached = DatabaseManager::Get(*con.context).GetDatabase(*con.context, "bq");
+		catalog = &attached->GetCatalog().Cast<BigQueryCatalog>();
+	}
+
+	BigQuerySchemaEntry &GetSchema() {
+		return catalog->GetLoadedSchema("test_dataset");
+	}
+
+	BigQueryTableSet &GetTableSet() {
+		return GetSchema().GetTableSet();
+	}
+
+	unique_ptr<BigQueryTableEntry> MakeTable(const string &name) {
+		BigQueryTableInfo table_info("test_dataset", name);
+		table_info.create_info->columns.AddColumn(ColumnDefinition("id", LogicalType::BIGINT));
+		return make_uniq<BigQueryTableEntry>(*catalog, GetSchema(), table_info);
+	}
+
+	//! Adds a table entry that was last looked up the given number of milliseconds ago
+	BigQueryTableEntry &AddTable(const string &name, int64_t idle_ms, idx_t pin_count = 0) {
+		auto &entry = GetTableSet().CreateEntry(MakeTable(name))->Cast<BigQueryTableEntry>();
+		entry.last_access = Timestamp::GetEpochMs(Timestamp::GetCurrentTimestamp()) - idle_ms;
+		entry.pin_count = pin_count;
+		return entry;
+	}
+
+	void EnforceMemoryLimit(idx_t max_bytes) {
+		con.Query("SET bigquery_catalog_max_bytes=" + std::to_string(max_bytes));
+		con.context->RunFunctionInTransaction([&]() { BigQueryCatalog::EnforceMemoryLimit(*con.context); });
+	}
+
+	DuckDB db;
+	Connection con;
+	optional_ptr<BigQueryCatalog> catalog;
+};
+
+//! The number of threads that look up the same table concurrently
+static constexpr idx_t LOAD_THREADS = 8;
+
+//! Calls LoadEntry for the same name from several threads, the load runs once all of them have started
+static void LoadConcurrently(BigQueryTableSet &table_set, const std::function<unique_ptr<CatalogEntry>()> &load,
+                             vector<optional_ptr<CatalogEntry>> &results, vector<string> &errors) {
+	std::atomic<idx_t> started {0};
+	auto blocking_load = [&]() {
+		while (started < LOAD_THREADS) {
+			std::this_thread::yield();
+		}
+		// the other threads are about to wait for this load
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		return load();
+	};
+	results.resize(LOAD_THREADS);
+	errors.resize(LOAD_THREADS);
+	vector<std::thread> threads;
+	for (idx_t i = 0; i < LOAD_THREADS; i++) {
+		threads.emplace_back([&, i]() {
+			started++;
+			try {
+				results[i] = table_set.LoadEntry("events", blocking_load, [](CatalogEntry &entry) {
+					return entry.Cast<BigQueryTableEntry>().resolved;
+				});
+			} catch (std::exception &ex) {
+				errors[i] = ex.what();
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+}
+
+TEST_F(BigQueryCatalogSetTest, LoadsConcurrentlyRequestedEntriesOnce) {
+	std::atomic<idx_t> load_count {0};
+	vector<optional_ptr<CatalogEntry>> results;
+	vector<string> errors;
+	LoadConcurrently(
+	    GetTableSet(),
+	    [&]() -> unique_ptr<CatalogEntry> {
+		    load_count++;
+		    return MakeTable("events");
+	    },
+	    results, errors);
+
+	EXPECT_EQ(load_count.load(), 1u);
+	auto entry = GetTableSet().GetLoadedEntry("events");
+	ASSERT_TRUE(entry);
+	for (idx_t i = 0; i < LOAD_THREADS; i++) {
+		EXPECT_EQ(errors[i], "");
+		EXPECT_EQ(results[i].get(), entry.get());
+	}
+}
+
+TEST_F(BigQueryCatalogSetTest, ReportsLoadErrorsToEveryWaiter) {
+	std::atomic<idx_t> load_count {0};
+	vector<optional_ptr<CatalogEntry>> results;
+	vector<string> errors;
+	LoadConcurrently(
+	    GetTableSet(),
+	    [&]() -> unique_ptr<CatalogEntry> {
+		    load_count++;
+		    throw IOException("table not found");
+	    },
+	    results, errors);
+
+	EXPECT_EQ(load_count.load(), 1u);
+	for (idx_t i = 0; i < LOAD_THREADS; i++) {
+		EXPECT_NE(errors[i].find("table not found"), string::npos) << errors[i];
+		EXPECT_FALSE(results[i]);
+	}
+	EXPECT_FALSE(GetTableSet().GetLoadedEntry("events"));
+
+	// the failed load is not remembered, the next lookup loads again
+	auto entry = GetTableSet().LoadEntry(
+	    "events",
+	    [&]() -> unique_ptr<CatalogEntry> {
+		    load_count++;
+		    return MakeTable("events");
+	    },
+	    [](CatalogEntry &) { return true; });
+	EXPECT_TRUE(entry);
+	EXPECT_EQ(load_count.load(), 2u);
+}
+
+TEST_F(BigQueryCatalogSetTest, ReplacesIncompleteEntries) {
+	auto unresolved = MakeTable("events");
+	unresolved->resolved = false;
+	GetTableSet().CreateEntry(std::move(unresolved));
+	idx_t load_count = 0;
+	auto entry = GetTableSet().LoadEntry(
+	    "events",
+	    [&]() -> unique_ptr<CatalogEntry> {
+		    load_count++;
+		    return MakeTable("events");
+	    },
+	    [](CatalogEntry &loaded) { return loaded.Cast<BigQueryTableEntry>().resolved; });
+	ASSERT_TRUE(entry);
+	EXPECT_TRUE(entry->Cast<BigQueryTableEntry>().resolved);
+	EXPECT_EQ(GetTableSet().GetLoadedEntry("events").get(), entry.get());
+	EXPECT_EQ(load_count, 1u);
+}
+
+//! Longer than the grace period in which looked up entries are not evicted
+static constexpr int64_t IDLE_MS = 60 * 1000;
+
+TEST_F(BigQueryCatalogSetTest, EvictsIdleUnpinnedEntries) {
+	AddTable("idle", IDLE_MS);
+	auto &pinned = AddTable("pinned", IDLE_MS, 1);
+	auto &recent = AddTable("recent", 0);
+	auto &replaced = AddTable("replaced", IDLE_MS);
+	// the replaced entry is no longer looked up, and freed when nothing references it
+	auto &replacement = GetTableSet().ReplaceEntry(MakeTable("replaced"))->Cast<BigQueryTableEntry>();
+	replaced.last_access = replacement.last_access - IDLE_MS;
+
+	EnforceMemoryLimit(1);
+	EXPECT_EQ(catalog->memory_usage.load(), pinned.EstimateMemoryUsage() + recent.EstimateMemoryUsage() +
+	                                            replacement.EstimateMemoryUsage());
+	EXPECT_FALSE(GetTableSet().GetLoadedEntry("idle"));
+	EXPECT_EQ(GetTableSet().GetLoadedEntry("pinned").get(), &pinned);
+	EXPECT_EQ(GetTableSet().GetLoadedEntry("recent").get(), &recent);
+	EXPECT_EQ(GetTableSet().GetLoadedEntry("replaced").get(), &replacement);
+}
+
+TEST_F(BigQueryCatalogSetTest, EvictsTheLeastRecentlyUsedEntriesUpToTheLimit) {
+	AddTable("t1", 2 * IDLE_MS);
+	auto &newer = AddTable("t2", IDLE_MS);
+	auto memory_usage = catalog->memory_usage.load();
+
+	// evicting the older entry brings the usage below the limit
+	EnforceMemoryLimit(memory_usage - 1);
+	EXPECT_FALSE(GetTableSet().GetLoadedEntry("t1"));
+	EXPECT_EQ(GetTableSet().GetLoadedEntry("t2").get(), &newer);
+	EXPECT_EQ(catalog->memory_usage.load(), newer.EstimateMemoryUsage());
+
+	// nothing is evicted within the limit
+	EnforceMemoryLimit(catalog->memory_usage);
+	EXPECT_TRUE(GetTableSet().GetLoadedEntry("t2"));
+}
+
+TEST_F(BigQueryCatalogSetTest, DoesNotEvictWithoutALimit) {
+	AddTable("idle", IDLE_MS);
+	EnforceMemoryLimit(0);
+	EXPECT_TRUE(GetTableSet().GetLoadedEntry("idle"));
+}
+
+TEST_F(BigQueryCatalogSetTest, AccountsMemoryBackToZero) {
+	auto &pinned = AddTable("pinned", IDLE_MS, 1);
+	AddTable("idle", IDLE_MS);
+	GetTableSet().ReplaceEntry(MakeTable("idle"));
+	EXPECT_GT(catalog->memory_usage.load(), pinned.EstimateMemoryUsage());
+
+	// the pinned entry stays alive until the query that references it is done
+	catalog->ClearCache();
+	EXPECT_EQ(catalog->memory_usage.load(), pinned.EstimateMemoryUsage());
+	pinned.pin_count = 0;
+	catalog->ClearCache();
+	EXPECT_EQ(catalog->memory_usage.load(), 0u);
+}
+
+} // namespace duckdb
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "bigquery_filter_pushdown.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
+
+namespace duckdb {
+
+static LogicalType PayloadType() {
+	child_list_t<LogicalType> user_fields {{"id", LogicalType::BIGINT}};
+	child_list_t<LogicalType> fields {{"country", LogicalType::VARCHAR},
+	                                  {"zip code", LogicalType::VARCHAR},
+	                                  {"we`ird", LogicalType::BIGINT},
+	                                  {"user", LogicalType::STRUCT(user_fields)}};
+	return LogicalType::STRUCT(fields);
+}
+
+//! A scan of a table with a single STRUCT column "payload", at table index 0
+static unique_ptr<LogicalGet> PayloadGet() {
+	auto get = make_uniq<LogicalGet>(0, TableFunction(), nullptr, vector<LogicalType> {PayloadType()},
+	                                 vector<string> {"payload"});
+	get->column_ids.push_back(0);
+	return get;
+}
+
+static unique_ptr<Expression> Payload(idx_t table_index = 0) {
+	return make_uniq<BoundColumnRefExpression>(PayloadType(), ColumnBinding(table_index, 0));
+}
+
+//! struct_extract(child, key), which binds the key case insensitively
+static unique_ptr<Expression> StructExtract(unique_ptr<Expression> child, const string &key) {
+	LogicalType return_type;
+	for (auto &field : StructType::GetChildTypes(child->return_type)) {
+		if (StringUtil::CIEquals(field.first, key)) {
+			return_type = field.second;
+		}
+	}
+	ScalarFunction function("struct_extract", {child->return_type, LogicalType::VARCHAR}, return_type, nullptr);
+	vector<unique_ptr<Expression>> children;
+	children.push_back(std::move(child));
+	children.push_back(make_uniq<BoundConstantExpression>(Value(key)));
+	return make_uniq<BoundFunctionExpression>(return_type, function, std::move(children), nullptr);
+}
+
+static unique_ptr<Expression> Constant(const Value &value) {
+	return make_uniq<BoundConstantExpression>(value);
+}
+
+static string TransformNestedFilter(Expression &expr) {
+	auto get = PayloadGet();
+	return BigQueryFilterPushdown::TransformNestedFilter(expr, *get, get->names);
+}
+
+TEST(BigQueryFilterPushdownTest, QuotesStructPaths) {
+	BoundComparisonExpression equal(ExpressionType::COMPARE_EQUAL, StructExtract(Payload(), "COUNTRY"),
+	                                Constant(Value("FR")));
+	// the field name is written as declared, not as spelled in the query
+	EXPECT_EQ(TransformNestedFilter(equal), "`payload`.`country` = 'FR'");
+
+	BoundComparisonExpression space(ExpressionType::COMPARE_NOTEQUAL, StructExtract(Payload(), "zip code"),
+	                                Constant(Value("75001")));
+	EXPECT_EQ(TransformNestedFilter(space), "`payload`.`zip code` != '75001'");
+
+	BoundComparisonExpression backtick(ExpressionType::COMPARE_GREATERTHAN, StructExtract(Payload(), "we`ird"),
+	                                   Constant(Value::BIGINT(3)));
+	EXPECT_EQ(TransformNestedFilter(backtick), "`payload`.`we\\`ird` > 3");
+
+	BoundComparisonExpression deep(ExpressionType::COMPARE_EQUAL, StructExtract(StructExtract(Payload(), "user"), "id"),
+	                               Constant(Value::BIGINT(42)));
+	EXPECT_EQ(TransformNestedFilter(deep), "`payload`.`user`.`id` = 42");
+}
+
+TEST(BigQueryFilterPushdownTest, FlipsConstantOnTheLeft) {
+	BoundComparisonExpression less(ExpressionType::COMPARE_LESSTHAN, Constant(Value::BIGINT(10)),
+	                               StructExtract(StructExtract(Payload(), "user"), "id"));
+	EXPECT_EQ(TransformNestedFilter(less), "`payload`.`user`.`id` > 10");
+}
+
+TEST(BigQueryFilterPushdownTest, PushesNullChecks) {
+	BoundOperatorExpression is_null(ExpressionType::OPERATOR_IS_NULL, LogicalType::BOOLEAN);
+	is_null.children.push_back(StructExtract(Payload(), "country"));
+	EXPECT_EQ(TransformNestedFilter(is_null), "`payload`.`country` IS NULL");
+
+	BoundOperatorExpression is_not_null(ExpressionType::OPERATOR_IS_NOT_NULL, LogicalType::BOOLEAN);
+	is_not_null.children.push_back(StructExtract(StructExtract(Payload(), "user"), "id"));
+	EXPECT_EQ(TransformNestedFilter(is_not_null), "`payload`.`user`.`id` IS NOT NULL");
+
+	// comparisons with NULL are never true, they are left to DuckDB
+	BoundComparisonExpression equal_null(ExpressionType::COMPARE_EQUAL, StructExtract(Payload(), "country"),
+	                                     Constant(Value(LogicalType::VARCHAR)));
+	EXPECT_EQ(TransformNestedFilter(equal_null), "");
+}
+
+TEST(BigQueryFilterPushdownTest, PushesInLists) {
+	BoundOperatorExpression in(ExpressionType::COMPARE_IN, LogicalType::BOOLEAN);
+	in.children.push_back(StructExtract(Payload(), "country"));
+	in.children.push_back(Constant(Value("FR")));
+	in.children.push_back(Constant(Value("DE")));
+	EXPECT_EQ(TransformNestedFilter(in), "`payload`.`country` IN ('FR', 'DE')");
+
+	// a NULL in the list cannot be rendered as a literal, the whole filter stays local
+	BoundOperatorExpression in_null(ExpressionType::COMPARE_IN, LogicalType::BOOLEAN);
+	in_null.children.push_back(StructExtract(Payload(), "country"));
+	in_null.children.push_back(Constant(Value("FR")));
+	in_null.children.push_back(Constant(Value(LogicalType::VARCHAR)));
+	EXPECT_EQ(TransformNestedFilter(in_null), "");
+}
+
+TEST(BigQueryFilterPushdownTest, SkipsFiltersThatCannotBePushed) {
+	// top-level columns go through the table filters
+	BoundComparisonExpression top_level(ExpressionType::COMPARE_EQUAL, Payload(), Constant(Value("FR")));
+	EXPECT_EQ(TransformNestedFilter(top_level), "");
+
+	// columns of another table in the same filter
+	BoundComparisonExpression other_table(ExpressionType::COMPARE_EQUAL, StructExtract(Payload(1), "country"),
+	                                      Constant(Value("FR")));
+	EXPECT_EQ(TransformNestedFilter(other_table), "");
+
+	// an OR is only pushed if all of its children are
+	BoundConjunctionExpression partial_or(ExpressionType::CONJUNCTION_OR,
+	                                      make_uniq<BoundComparisonExpression>(ExpressionType::COMPARE_EQUAL,
+	                                                                           StructExtract(Payload(), "country"),
+	                                                                           Constant(Value("FR"))),
+	                                      make_uniq<BoundComparisonExpression>(ExpressionType::COMPARE_EQUAL,
+	                                                                           StructExtract(Payload(1), "country"),
+	                                                                           Constant(Value("DE"))));
+	EXPECT_EQ(TransformNestedFilter(partial_or), "");
+}
+
+} // namespace duckdb
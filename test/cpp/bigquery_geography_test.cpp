@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "bigquery_geography.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace duckdb {
+
+static string WKTToWKB(const string &wkt) {
+	return BigQueryGeography::WKTToWKB(string_t(wkt.c_str(), static_cast<uint32_t>(wkt.size())));
+}
+
+static uint32_t ReadUInt32(const string &wkb, idx_t offset) {
+	uint32_t value;
+	memcpy(&value, wkb.data() + offset, sizeof(uint32_t));
+	return value;
+}
+
+static double ReadDouble(const string &wkb, idx_t offset) {
+	double value;
+	memcpy(&value, wkb.data() + offset, sizeof(double));
+	return value;
+}
+
+TEST(BigQueryGeographyTest, ConvertsPoint) {
+	auto wkb = WKTToWKB("POINT(1.5 -2)");
+	ASSERT_EQ(wkb.size(), 21u);
+	EXPECT_EQ(wkb[0], 1);
+	EXPECT_EQ(ReadUInt32(wkb, 1), 1u);
+	EXPECT_EQ(ReadDouble(wkb, 5), 1.5);
+	EXPECT_EQ(ReadDouble(wkb, 13), -2.0);
+}
+
+TEST(BigQueryGeographyTest, ConvertsMultiPolygon) {
+	auto wkb = WKTToWKB("MULTIPOLYGON(((0 0, 1 0, 1 1, 0 0)), ((2 2, 3 2, 3 3, 2 2), (2.1 2.1, 2.2 2.1, 2.2 2.2, "
+	                    "2.1 2.1)))");
+	// header, polygon count
+	EXPECT_EQ(ReadUInt32(wkb, 1), 6u);
+	EXPECT_EQ(ReadUInt32(wkb, 5), 2u);
+	// first polygon: header, one ring of four points
+	idx_t offset = 9;
+	EXPECT_EQ(ReadUInt32(wkb, offset + 1), 3u);
+	EXPECT_EQ(ReadUInt32(wkb, offset + 5), 1u);
+	EXPECT_EQ(ReadUInt32(wkb, offset + 9), 4u);
+	offset += 13 + 4 * 16;
+	// second polygon: two rings
+	EXPECT_EQ(ReadUInt32(wkb, offset + 1), 3u);
+	EXPECT_EQ(ReadUInt32(wkb, offset + 5), 2u);
+	EXPECT_EQ(ReadUInt32(wkb, offset + 9), 4u);
+	EXPECT_EQ(ReadDouble(wkb, offset + 13), 2.0);
+	offset += 13 + 4 * 16;
+	EXPECT_EQ(ReadUInt32(wkb, offset), 4u);
+	EXPECT_EQ(ReadDouble(wkb, offset + 4 + 3 * 16 + 8), 2.1);
+	EXPECT_EQ(wkb.size(), offset + 4 + 4 * 16);
+}
+
+TEST(BigQueryGeographyTest, ConvertsEmptyGeometries) {
+	auto point = WKTToWKB("POINT EMPTY");
+	ASSERT_EQ(point.size(), 21u);
+	EXPECT_TRUE(std::isnan(ReadDouble(point, 5)));
+	EXPECT_TRUE(std::isnan(ReadDouble(point, 13)));
+
+	auto collection = WKTToWKB("GEOMETRYCOLLECTION EMPTY");
+	ASSERT_EQ(collection.size(), 9u);
+	EXPECT_EQ(ReadUInt32(collection, 1), 7u);
+	EXPECT_EQ(ReadUInt32(collection, 5), 0u);
+
+	auto polygon = WKTToWKB("polygon empty");
+	EXPECT_EQ(ReadUInt32(polygon, 1), 3u);
+	EXPECT_EQ(ReadUInt32(polygon, 5), 0u);
+}
+
+TEST(BigQueryGeographyTest, ConvertsColumnSlice) {
+	arrow::StringBuilder builder;
+	ASSERT_TRUE(builder.Append("POINT(0 0)").ok());
+	ASSERT_TRUE(builder.AppendNull().ok());
+	ASSERT_TRUE(builder.Append("POINT(1 2)").ok());
+	std::shared_ptr<arrow::Array> array;
+	ASSERT_TRUE(builder.Finish(&array).ok());
+	auto slice = std::static_pointer_cast<arrow::StringArray>(array->Slice(1));
+
+	Vector result(BigQueryGeography::GeographyType(), 4);
+	BigQueryGeography::WKTColumnToWKB(*slice, 0, 2, result, 1);
+	EXPECT_FALSE(FlatVector::Validity(result).RowIsValid(1));
+	auto wkb = FlatVector::GetData<string_t>(result)[2].GetString();
+	ASSERT_EQ(wkb.size(), 21u);
+	EXPECT_EQ(ReadDouble(wkb, 5), 1.0);
+	EXPECT_EQ(ReadDouble(wkb, 13), 2.0);
+}
+
+TEST(BigQueryGeographyTest, RejectsInvalidWKT) {
+	EXPECT_THROW(WKTToWKB("POINT(1)"), InvalidInputException);
+	EXPECT_THROW(WKTToWKB("POINT(1 2"), InvalidInputException);
+	EXPECT_THROW(WKTToWKB("POINT(1 2) trailing"), InvalidInputException);
+	EXPECT_THROW(WKTToWKB("CIRCLE(1 2, 3)"), InvalidInputException);
+	EXPECT_THROW(WKTToWKB(""), InvalidInputException);
+}
+
+} // namespace duckdb
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include "duckdb.hpp"
+#include "bigquery_scan_cache.hpp"
+#include "duckdb/common/local_file_system.hpp"
+#include "duckdb/common/types/uuid.hpp"
+#include "duckdb/main/config.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace duckdb {
+
+static BigQueryScanCacheKey MakeKey(vector<string> fields, string row_restriction = "",
+                                    string version = "1700000000000") {
+	BigQueryScanCacheKey key;
+	key.table = "projects/p/datasets/d/tables/t";
+	key.version = std::move(version);
+	key.fields = std::move(fields);
+	key.row_restriction = std::move(row_restriction);
+	return key;
+}
+
+TEST(BigQueryScanCacheKeyTest, WiderKeysCoverNarrowerOnes) {
+	auto wide = MakeKey({"a", "b", "c"});
+	EXPECT_TRUE(wide.Covers(MakeKey({"a", "c"})));
+	EXPECT_TRUE(wide.Covers(wide));
+	EXPECT_FALSE(MakeKey({"a", "c"}).Covers(wide));
+	EXPECT_FALSE(wide.Covers(MakeKey({"a", "d"})));
+}
+
+TEST(BigQueryScanCacheKeyTest, KeysOnlyCoverTheSameVersionAndRestriction) {
+	auto key = MakeKey({"a", "b"}, "a > 1");
+	EXPECT_FALSE(key.Covers(MakeKey({"a"})));
+	EXPECT_FALSE(MakeKey({"a", "b"}).Covers(MakeKey({"a"}, "a > 1")));
+	EXPECT_FALSE(key.Covers(MakeKey({"a"}, "a > 1", "1700000000001")));
+	auto other_table = MakeKey({"a"}, "a > 1");
+	other_table.table = "projects/p/datasets/d/tables/u";
+	EXPECT_FALSE(key.Covers(other_table));
+}
+
+class BigQueryScanCacheTest : public ::testing::Test {
+protected:
+	BigQueryScanCacheTest() : db(nullptr), con(db) {
+		auto &config = DBConfig::GetConfig(*db.instance);
+		config.AddExtensionOption("bigquery_scan_cache_directory", "", LogicalType::VARCHAR, Value(""));
+		config.AddExtensionOption("bigquery_scan_cache_max_bytes", "", LogicalType::UBIGINT,
+		                          Value::UBIGINT(10ULL * 1024 * 1024 * 1024));
+		directory = fs.ExpandPath("bigquery_scan_cache_test_" + UUID::ToString(UUID::GenerateRandomUUID()));
+		con.Query("SET bigquery_scan_cache_directory='" + directory + "'");
+	}
+
+	~BigQueryScanCacheTest() override {
+		fs.RemoveDirectory(directory);
+	}
+
+	shared_ptr<BigQueryScanCache> GetCache() {
+		return BigQueryScanCache::TryGet(*con.context);
+	}
+
+	//! Writes a cache entry with a single batch of the given fields, and returns its file name
+	static string Write(shared_ptr<BigQueryScanCache> cache, BigQueryScanCacheKey key) {
+		arrow::FieldVector fields;
+		vector<std::shared_ptr<arrow::Array>> columns;
+		for (auto &field : key.fields) {
+			arrow::Int64Builder builder;
+			EXPECT_TRUE(builder.AppendValues({1, 2, 3}).ok());
+			std::shared_ptr<arrow::Array> column;
+			EXPECT_TRUE(builder.Finish(&column).ok());
+			fields.push_back(arrow::field(field, arrow::int64()));
+			columns.push_back(std::move(column));
+		}
+		auto schema = arrow::schema(fields);
+		auto before = cache->GetEntries();
+		BigQueryScanCacheWriter writer(cache, std::move(key), schema);
+		writer.Append(*arrow::RecordBatch::Make(schema, 3, columns));
+		writer.Commit();
+		// entries are ordered by their last access, which has millisecond resolution
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		for (auto &entry : cache->GetEntries()) {
+			auto it = std::find_if(before.begin(), before.end(), [&](const BigQueryScanCacheEntry &other) {
+				return other.file_name == entry.file_name;
+			});
+			if (it == before.end()) {
+				return entry.file_name;
+			}
+		}
+		return string();
+	}
+
+	bool HasFile(const string &file_name) {
+		return fs.FileExists(fs.JoinPath(directory, file_name));
+	}
+
+	static vector<string> GetFileNames(const vector<BigQueryScanCacheEntry> &entries) {
+		vector<string> result;
+		for (auto &entry : entries) {
+			result.push_back(entry.file_name);
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	DuckDB db;
+	Connection con;
+	LocalFileSystem fs;
+	string directory;
+};
+
+TEST_F(BigQueryScanCacheTest, ServesNarrowerProjections) {
+	auto cache = GetCache();
+	ASSERT_TRUE(cache);
+	Write(cache, MakeKey({"a", "b"}));
+	auto reader = cache->TryOpen(MakeKey({"b"}));
+	ASSERT_TRUE(reader);
+	auto batch = reader->Next();
+	ASSERT_TRUE(batch);
+	EXPECT_EQ(batch->num_rows(), 3);
+	EXPECT_TRUE(batch->schema()->GetFieldByName("b"));
+	EXPECT_FALSE(cache->TryOpen(MakeKey({"c"})));
+	EXPECT_FALSE(cache->TryOpen(MakeKey({"a"}, "a > 1")));
+}
+
+TEST_F(BigQueryScanCacheTest, RemovesOlderVersionsOnly) {
+	auto cache = GetCache();
+	auto newer_file = Write(cache, MakeKey({"a"}, "", "1700000000002"));
+	// a lookup with outdated metadata keeps the newer entry
+	EXPECT_FALSE(cache->TryOpen(MakeKey({"a"}, "", "1700000000001")));
+	EXPECT_TRUE(HasFile(newer_file));
+	ASSERT_EQ(cache->GetEntries().size(), 1u);
+
+	EXPECT_FALSE(cache->TryOpen(MakeKey({"a"}, "", "1700000000003")));
+	EXPECT_FALSE(HasFile(newer_file));
+	EXPECT_TRUE(cache->GetEntries().empty());
+}
+
+TEST_F(BigQueryScanCacheTest, MergesTheEntriesOfOtherProcesses) {
+	auto cache = GetCache();
+	auto first_file = Write(cache, MakeKey({"a"}));
+	// another process sharing the directory
+	auto other_cache = make_shared_ptr<BigQueryScanCache>(directory);
+	EXPECT_EQ(GetFileNames(other_cache->GetEntries()), vector<string>({first_file}));
+	auto second_file = Write(other_cache, MakeKey({"b"}));
+
+	auto third_file = Write(cache, MakeKey({"c"}));
+	vector<string> all_files {first_file, second_file, third_file};
+	std::sort(all_files.begin(), all_files.end());
+	EXPECT_EQ(GetFileNames(cache->GetEntries()), all_files);
+	EXPECT_EQ(GetFileNames(BigQueryScanCache(directory).GetEntries()), all_files);
+}
+
+TEST_F(BigQueryScanCacheTest, DoesNotMergeRemovedEntriesBack) {
+	auto cache = GetCache();
+	Write(cache, MakeKey({"a"}));
+	Write(cache, MakeKey({"b"}, "b > 1"));
+	// both entries are of an older version, the index on disk still lists them when they are removed
+	EXPECT_FALSE(cache->TryOpen(MakeKey({"a"}, "", "1700000000001")));
+	EXPECT_TRUE(cache->GetEntries().empty());
+	EXPECT_TRUE(BigQueryScanCache(directory).GetEntries().empty());
+	Write(cache, MakeKey({"c"}, "", "1700000000001"));
+	EXPECT_EQ(cache->GetEntries().size(), 1u);
+}
+
+TEST_F(BigQueryScanCacheTest, DropsEntriesWhoseFileWasRemoved) {
+	auto cache = GetCache();
+	auto file_name = Write(cache, MakeKey({"a"}));
+	fs.RemoveFile(fs.JoinPath(directory, file_name));
+	EXPECT_FALSE(cache->TryOpen(MakeKey({"a"})));
+	EXPECT_TRUE(cache->GetEntries().empty());
+	EXPECT_TRUE(BigQueryScanCache(directory).GetEntries().empty());
+}
+
+TEST_F(BigQueryScanCacheTest, EvictsTheLeastRecentlyUsedEntries) {
+	auto cache = GetCache();
+	auto first_file = Write(cache, MakeKey({"a"}));
+	auto second_file = Write(cache, MakeKey({"b"}));
+	// reading the first entry makes the second one the least recently used
+	ASSERT_TRUE(cache->TryOpen(MakeKey({"a"})));
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+	auto entries = cache->GetEntries();
+	ASSERT_EQ(entries.size(), 2u);
+	auto entry_size = MaxValue(entries[0].size, entries[1].size);
+	con.Query("SET bigquery_scan_cache_max_bytes=" + std::to_string(entry_size * 5 / 2));
+	GetCache();
+	auto third_file = Write(cache, MakeKey({"c"}));
+
+	vector<string> remaining_files {first_file, third_file};
+	std::sort(remaining_files.begin(), remaining_files.end());
+	EXPECT_EQ(GetFileNames(cache->GetEntries()), remaining_files);
+	EXPECT_FALSE(HasFile(second_file));
+	EXPECT_EQ(GetFileNames(BigQueryScanCache(directory).GetEntries()), remaining_files);
+}
+
+TEST_F(BigQueryScanCacheTest, PurgesAllEntries) {
+	auto cache = GetCache();
+	auto first_file = Write(cache, MakeKey({"a"}));
+	// purging also removes the entries that other processes added
+	auto other_cache = make_shared_ptr<BigQueryScanCache>(directory);
+	auto second_file = Write(other_cache, MakeKey({"b"}));
+
+	EXPECT_EQ(cache->Purge(), 2u);
+	EXPECT_TRUE(cache->GetEntries().empty());
+	EXPECT_FALSE(HasFile(first_file));
+	EXPECT_FALSE(HasFile(second_file));
+	EXPECT_TRUE(BigQueryScanCache(directory).GetEntries().empty());
+	EXPECT_FALSE(cache->TryOpen(MakeKey({"a"})));
+}
+
+} // namespace duckdb
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "bigquery_scanner.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_reference_expression.hpp"
+#include "duckdb/planner/filter/conjunction_filter.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/filter/null_filter.hpp"
+
+namespace duckdb {
+
+static BigQueryScanBindData MakeBindData() {
+	return BigQueryScanBindData("exec-project", "storage-project", "dataset", "table", "");
+}
+
+TEST(BigQueryScannerTest, CachesCompleteScans) {
+	auto bind_data = MakeBindData();
+	EXPECT_TRUE(BigQueryScanFunction::CanCacheResult(bind_data));
+}
+
+TEST(BigQueryScannerTest, DoesNotCacheScansWithALimit) {
+	auto bind_data = MakeBindData();
+	bind_data.has_limit = true;
+	bind_data.limit = 10;
+	EXPECT_FALSE(BigQueryScanFunction::CanCacheResult(bind_data));
+}
+
+TEST(BigQueryScannerTest, DoesNotCacheScansWithAnOffset) {
+	// OFFSET without LIMIT
+	auto bind_data = MakeBindData();
+	bind_data.offset = 5;
+	EXPECT_FALSE(BigQueryScanFunction::CanCacheResult(bind_data));
+}
+
+TEST(BigQueryScannerTest, MatchesSuffixComparisons) {
+	ConstantFilter from(ExpressionType::COMPARE_GREATERTHANOREQUALTO, Value("20240102"));
+	EXPECT_FALSE(BigQueryScanFunction::SuffixMatchesFilter(from, Value("20240101")));
+	EXPECT_TRUE(BigQueryScanFunction::SuffixMatchesFilter(from, Value("20240102")));
+	EXPECT_TRUE(BigQueryScanFunction::SuffixMatchesFilter(from, Value("20240103")));
+	// no shard has a NULL suffix
+	EXPECT_FALSE(BigQueryScanFunction::SuffixMatchesFilter(IsNullFilter(), Value("20240101")));
+	EXPECT_TRUE(BigQueryScanFunction::SuffixMatchesFilter(IsNotNullFilter(), Value("20240101")));
+}
+
+TEST(BigQueryScannerTest, MatchesSuffixConjunctions) {
+	ConjunctionAndFilter between;
+	between.child_filters.push_back(
+	    make_uniq<ConstantFilter>(ExpressionType::COMPARE_GREATERTHANOREQUALTO, Value("20240102")));
+	between.child_filters.push_back(make_uniq<ConstantFilter>(ExpressionType::COMPARE_LESSTHAN, Value("20240104")));
+	EXPECT_FALSE(BigQueryScanFunction::SuffixMatchesFilter(between, Value("20240101")));
+	EXPECT_TRUE(BigQueryScanFunction::SuffixMatchesFilter(between, Value("20240103")));
+	EXPECT_FALSE(BigQueryScanFunction::SuffixMatchesFilter(between, Value("20240104")));
+
+	ConjunctionOrFilter either;
+	either.child_filters.push_back(make_uniq<ConstantFilter>(ExpressionType::COMPARE_EQUAL, Value("20240101")));
+	either.child_filters.push_back(make_uniq<ConstantFilter>(ExpressionType::COMPARE_EQUAL, Value("20240103")));
+	EXPECT_TRUE(BigQueryScanFunction::SuffixMatchesFilter(either, Value("20240101")));
+	EXPECT_FALSE(BigQueryScanFunction::SuffixMatchesFilter(either, Value("20240102")));
+	EXPECT_TRUE(BigQueryScanFunction::SuffixMatchesFilter(either, Value("20240103")));
+}
+
+TEST(BigQueryScannerTest, PrunesShards) {
+	DuckDB db(nullptr);
+	Connection con(db);
+	auto bind_data = MakeBindData();
+	bind_data.shard_suffixes = {"20240101", "20240102", "20240103", "20240104"};
+	// _TABLE_SUFFIX > '20240102'
+	BoundComparisonExpression filter(ExpressionType::COMPARE_GREATERTHAN,
+	                                 make_uniq<BoundReferenceExpression>(LogicalType::VARCHAR, 0),
+	                                 make_uniq<BoundConstantExpression>(Value("20240102")));
+	BigQueryScanFunction::PruneShards(*con.context, filter, bind_data);
+	EXPECT_EQ(bind_data.shard_suffixes, vector<string>({"20240103", "20240104"}));
+}
+
+TEST(BigQueryScannerTest, PrunesAllShards) {
+	DuckDB db(nullptr);
+	Connection con(db);
+	auto bind_data = MakeBindData();
+	bind_data.shard_suffixes = {"20240101", "20240102"};
+	BoundComparisonExpression filter(ExpressionType::COMPARE_EQUAL,
+	                                 make_uniq<BoundReferenceExpression>(LogicalType::VARCHAR, 0),
+	                                 make_uniq<BoundConstantExpression>(Value("20231231")));
+	BigQueryScanFunction::PruneShards(*con.context, filter, bind_data);
+	EXPECT_TRUE(bind_data.shard_suffixes.empty());
+}
+
+TEST(BigQueryScannerTest, ParsesTableURLs) {
+	string project, dataset, table;
+	ASSERT_TRUE(BigQueryScanFunction::ParseTableURL("bq://my-project.my_dataset.my_table", project, dataset, table));
+	EXPECT_EQ(project, "my-project");
+	EXPECT_EQ(dataset, "my_dataset");
+	EXPECT_EQ(table, "my_table");
+}
+
+TEST(BigQueryScannerTest, ParsesTableURLsOfDomainScopedProjects) {
+	// the project id may contain dots, the dataset and the table name cannot
+	string project, dataset, table;
+	ASSERT_TRUE(BigQueryScanFunction::ParseTableURL("bq://example.com:project.dataset.table", project, dataset, table));
+	EXPECT_EQ(project, "example.com:project");
+	EXPECT_EQ(dataset, "dataset");
+	EXPECT_EQ(table, "table");
+}
+
+TEST(BigQueryScannerTest, IgnoresOtherTableNames) {
+	string project, dataset, table;
+	EXPECT_FALSE(BigQueryScanFunction::ParseTableURL("my_table", project, dataset, table));
+	EXPECT_FALSE(BigQueryScanFunction::ParseTableURL("s3://bucket/file.parquet", project, dataset, table));
+}
+
+TEST(BigQueryScannerTest, RejectsInvalidTableURLs) {
+	string project, dataset, table;
+	EXPECT_THROW(BigQueryScanFunction::ParseTableURL("bq://", project, dataset, table), BinderException);
+	EXPECT_THROW(BigQueryScanFunction::ParseTableURL("bq://dataset.table", project, dataset, table), BinderException);
+	EXPECT_THROW(BigQueryScanFunction::ParseTableURL("bq://.dataset.table", project, dataset, table), BinderException);
+	EXPECT_THROW(BigQueryScanFunction::ParseTableURL("bq://project..table", project, dataset, table), BinderException);
+	EXPECT_THROW(BigQueryScanFunction::ParseTableURL("bq://project.dataset.", project, dataset, table),
+	             BinderException);
+}
+
+} // namespace duckdb
@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+#include "duckdb.hpp"
+#include "storage/bigquery_shared_scan.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace duckdb {
+
+//! A stream of numbered rows that stands in for a read session, the value of every row is its row number
+class FakeBatchSource {
+public:
+	FakeBatchSource(idx_t row_count_p, idx_t batch_size_p) : row_count(row_count_p), batch_size(batch_size_p) {
+		schema = arrow::schema({arrow::field("id", arrow::int64())});
+	}
+
+	idx_t row_count;
+	//! The rows per batch of the first stream, which the shared scan reads as its producer
+	idx_t batch_size;
+	//! The rows per batch of the streams that are opened later
+	idx_t catch_up_batch_size = 0;
+	std::shared_ptr<arrow::Schema> schema;
+
+	mutex lock;
+	//! The row offsets the streams were opened at
+	vector<idx_t> opened;
+	//! The number of batches each stream has returned
+	vector<idx_t> served;
+
+	BigQuerySharedScan::open_stream_t Opener() {
+		return [this](idx_t offset) -> unique_ptr<BigQueryBatchReader> {
+			lock_guard<mutex> guard(lock);
+			auto stream_size = opened.empty() || catch_up_batch_size == 0 ? batch_size : catch_up_batch_size;
+			opened.push_back(offset);
+			served.push_back(0);
+			return make_uniq<Reader>(*this, opened.size() - 1, offset, stream_size);
+		};
+	}
+
+private:
+	class Reader : public BigQueryBatchReader {
+	public:
+		Reader(FakeBatchSource &source_p, idx_t stream_p, idx_t offset, idx_t stream_size_p)
+		    : source(source_p), stream(stream_p), row(offset), stream_size(stream_size_p) {
+		}
+
+		std::shared_ptr<arrow::Schema> GetSchema() override {
+			return source.schema;
+		}
+		std::shared_ptr<arrow::RecordBatch> Next() override {
+			if (row >= source.row_count) {
+				return nullptr;
+			}
+			auto end = MinValue<idx_t>(row + stream_size, source.row_count);
+			arrow::Int64Builder builder;
+			for (; row < end; row++) {
+				EXPECT_TRUE(builder.Append(static_cast<int64_t>(row)).ok());
+			}
+			std::shared_ptr<arrow::Array> column;
+			EXPECT_TRUE(builder.Finish(&column).ok());
+			{
+				lock_guard<mutex> guard(source.lock);
+				source.served[stream]++;
+			}
+			return arrow::RecordBatch::Make(source.schema, column->length(), {column});
+		}
+
+	private:
+		FakeBatchSource &source;
+		idx_t stream;
+		idx_t row;
+		idx_t stream_size;
+	};
+};
+
+//! Reads up to max_batches batches of a consumer and appends their row numbers, returns false once it is exhausted
+static bool Read(BigQueryBatchReader &reader, vector<int64_t> &rows,
+                 idx_t max_batches = NumericLimits<idx_t>::Maximum()) {
+	for (idx_t i = 0; i < max_batches; i++) {
+		auto batch = reader.Next();
+		if (!batch) {
+			return false;
+		}
+		auto column = std::static_pointer_cast<arrow::Int64Array>(batch->column(0));
+		for (int64_t row_idx = 0; row_idx < column->length(); row_idx++) {
+			rows.push_back(column->Value(row_idx));
+		}
+	}
+	return true;
+}
+
+static vector<int64_t> AllRows(const FakeBatchSource &source) {
+	vector<int64_t> result;
+	for (idx_t row = 0; row < source.row_count; row++) {
+		result.push_back(static_cast<int64_t>(row));
+	}
+	return result;
+}
+
+static BigQueryScanCacheKey MakeKey(vector<string> fields) {
+	BigQueryScanCacheKey key;
+	key.table = "projects/p/datasets/d/tables/t";
+	key.version = "1700000000000";
+	key.fields = std::move(fields);
+	return key;
+}
+
+TEST(BigQuerySharedScanTest, ConsumersShareTheProducer) {
+	FakeBatchSource source(400, 10);
+	auto scan = make_shared_ptr<BigQuerySharedScan>(MakeKey({"id"}));
+	scan->Start(source.Opener());
+	auto first = BigQuerySharedScan::Attach(scan);
+	auto second = BigQuerySharedScan::Attach(scan);
+	ASSERT_TRUE(first && second);
+
+	vector<int64_t> first_rows, second_rows;
+	bool first_open = true, second_open = true;
+	while (first_open || second_open) {
+		first_open = first_open && Read(*first, first_rows, 1);
+		second_open = second_open && Read(*second, second_rows, 1);
+	}
+	EXPECT_EQ(first_rows, AllRows(source));
+	EXPECT_EQ(second_rows, AllRows(source));
+	// consumers in lockstep never open a stream of their own
+	EXPECT_EQ(source.opened, vector<idx_t>({0}));
+	EXPECT_EQ(source.served[0], 40u);
+	EXPECT_FALSE(scan->IsJoinable());
+}
+
+TEST(BigQuerySharedScanTest, LaggingConsumerReadsFromItsOwnStream) {
+	FakeBatchSource source(400, 10);
+	auto scan = make_shared_ptr<BigQuerySharedScan>(MakeKey({"id"}));
+	scan->Start(source.Opener());
+	auto fast = BigQuerySharedScan::Attach(scan);
+	auto slow = BigQuerySharedScan::Attach(scan);
+
+	// the window does not hold all batches, so the slow consumer falls behind while the fast one reads them
+	vector<int64_t> fast_rows, slow_rows;
+	Read(*fast, fast_rows, 5);
+	Read(*slow, slow_rows, 2);
+	EXPECT_FALSE(Read(*fast, fast_rows));
+	EXPECT_FALSE(Read(*slow, slow_rows));
+	EXPECT_EQ(fast_rows, AllRows(source));
+	EXPECT_EQ(slow_rows, AllRows(source));
+	// the slow consumer continues at the row it has reached instead of starting over
+	EXPECT_EQ(source.opened, vector<idx_t>({0, 20}));
+	EXPECT_EQ(source.served[0], 40u);
+	EXPECT_EQ(source.served[1], 38u);
+}
+
+TEST(BigQuerySharedScanTest, LateConsumerRejoinsTheWindow) {
+	FakeBatchSource source(400, 10);
+	// batches of the catch-up stream end past the window's batch boundaries
+	source.catch_up_batch_size = 15;
+	auto scan = make_shared_ptr<BigQuerySharedScan>(MakeKey({"id"}));
+	scan->Start(source.Opener());
+	auto early = BigQuerySharedScan::Attach(scan);
+	vector<int64_t> early_rows, late_rows;
+	Read(*early, early_rows, 20);
+
+	auto late = BigQuerySharedScan::Attach(scan);
+	ASSERT_TRUE(late);
+	// the late consumer catches up to row 200, where the next batch of the window starts
+	Read(*late, late_rows, 14);
+	ASSERT_EQ(late_rows.size(), 200u);
+	EXPECT_EQ(source.opened, vector<idx_t>({0, 0}));
+	EXPECT_EQ(source.served[1], 14u);
+
+	bool early_open = true, late_open = true;
+	while (early_open || late_open) {
+		early_open = early_open && Read(*early, early_rows, 1);
+		late_open = late_open && Read(*late, late_rows, 1);
+	}
+	EXPECT_EQ(early_rows, AllRows(source));
+	EXPECT_EQ(late_rows, AllRows(source));
+	// after rejoining, both consumers share the producer again
+	EXPECT_EQ(source.opened.size(), 2u);
+	EXPECT_EQ(source.served[1], 14u);
+	EXPECT_EQ(source.served[0], 40u);
+}
+
+TEST(BigQuerySharedScanTest, ConsumersAtDifferentSpeeds) {
+	FakeBatchSource source(2000, 10);
+	auto scan = make_shared_ptr<BigQuerySharedScan>(MakeKey({"id"}));
+	vector<unique_ptr<BigQueryBatchReader>> readers;
+	std::thread starter([&]() { scan->Start(source.Opener()); });
+	// Attach waits for the scan to start
+	for (idx_t i = 0; i < 4; i++) {
+		readers.push_back(BigQuerySharedScan::Attach(scan));
+	}
+	starter.join();
+	for (auto &reader : readers) {
+		ASSERT_TRUE(reader);
+	}
+
+	vector<vector<int64_t>> rows(readers.size());
+	vector<std::thread> threads;
+	for (idx_t i = 0; i < readers.size(); i++) {
+		threads.emplace_back([&, i]() {
+			while (Read(*readers[i], rows[i], 1)) {
+				if (i == 0) {
+					std::this_thread::sleep_for(std::chrono::microseconds(200));
+				}
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	for (auto &consumer_rows : rows) {
+		EXPECT_EQ(consumer_rows, AllRows(source));
+	}
+	EXPECT_EQ(source.served[0], 200u);
+}
+
+TEST(BigQuerySharedScanTest, DetachedConsumersDoNotHoldTheWindow) {
+	FakeBatchSource source(400, 10);
+	auto scan = make_shared_ptr<BigQuerySharedScan>(MakeKey({"id"}));
+	scan->Start(source.Opener());
+	auto reader = BigQuerySharedScan::Attach(scan);
+	auto abandoned = BigQuerySharedScan::Attach(scan);
+	abandoned.reset();
+
+	vector<int64_t> rows;
+	EXPECT_FALSE(Read(*reader, rows));
+	EXPECT_EQ(rows, AllRows(source));
+	EXPECT_EQ(source.opened, vector<idx_t>({0}));
+}
+
+TEST(BigQuerySharedScanTest, FailedScanHasNoConsumers) {
+	auto scan = make_shared_ptr<BigQuerySharedScan>(MakeKey({"id"}));
+	std::thread failer([&]() { scan->Fail(); });
+	EXPECT_FALSE(BigQuerySharedScan::Attach(scan));
+	failer.join();
+	EXPECT_FALSE(scan->IsJoinable());
+}
+
+TEST(BigQuerySharedScanTest, RegistersScansUntilTheyFinish) {
+	BigQuerySharedScans scans;
+	bool created;
+	auto scan = scans.GetOrCreate(MakeKey({"id", "name"}), created);
+	EXPECT_TRUE(created);
+	// a scan of fewer fields joins the wider scan
+	EXPECT_EQ(scans.GetOrCreate(MakeKey({"id"}), created), scan);
+	EXPECT_FALSE(created);
+	EXPECT_NE(scans.GetOrCreate(MakeKey({"id", "value"}), created), scan);
+	EXPECT_TRUE(created);
+
+	FakeBatchSource source(10, 10);
+	scan->Start(source.Opener());
+	auto reader = BigQuerySharedScan::Attach(scan);
+	vector<int64_t> rows;
+	EXPECT_FALSE(Read(*reader, rows));
+	// once its producer is exhausted, the scan no longer takes new consumers
+	EXPECT_NE(scans.GetOrCreate(MakeKey({"id"}), created), scan);
+	EXPECT_TRUE(created);
+}
+
+} // namespace duckdb
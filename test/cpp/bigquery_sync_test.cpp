@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "bigquery_sync.hpp"
+
+namespace duckdb {
+
+static BigQueryPartitioning DayPartitioning() {
+	BigQueryPartitioning partitioning;
+	partitioning.type = "DAY";
+	partitioning.column = "event_date";
+	partitioning.column_type = LogicalType::DATE;
+	return partitioning;
+}
+
+TEST(BigQuerySyncTest, SelectsDayPartitions) {
+	string predicate;
+	ASSERT_TRUE(BigQuerySyncFunction::PartitionPredicate(DayPartitioning(), "20240229", {"20240229"}, predicate));
+	EXPECT_EQ(predicate, "event_date >= DATE '2024-02-29' AND event_date < DATE '2024-03-01'");
+}
+
+TEST(BigQuerySyncTest, SelectsMonthPartitionsAcrossTheYear) {
+	auto partitioning = DayPartitioning();
+	partitioning.type = "MONTH";
+	partitioning.column_type = LogicalType::TIMESTAMP;
+	string predicate;
+	ASSERT_TRUE(BigQuerySyncFunction::PartitionPredicate(partitioning, "202312", {"202312"}, predicate));
+	EXPECT_EQ(predicate,
+	          "event_date >= TIMESTAMP '2023-12-01 00:00:00' AND event_date < TIMESTAMP '2024-01-01 00:00:00'");
+}
+
+TEST(BigQuerySyncTest, SelectsRangePartitions) {
+	BigQueryPartitioning partitioning;
+	partitioning.type = "RANGE";
+	partitioning.column = "id";
+	partitioning.column_type = LogicalType::BIGINT;
+	partitioning.range_interval = 10;
+	string predicate;
+	ASSERT_TRUE(BigQuerySyncFunction::PartitionPredicate(partitioning, "-20", {"-20"}, predicate));
+	EXPECT_EQ(predicate, "id >= -20 AND id < -10");
+}
+
+TEST(BigQuerySyncTest, SelectsTheNullPartition) {
+	string predicate;
+	ASSERT_TRUE(BigQuerySyncFunction::PartitionPredicate(DayPartitioning(), "__NULL__", {"__NULL__"}, predicate));
+	EXPECT_EQ(predicate, "event_date IS NULL");
+}
+
+TEST(BigQuerySyncTest, SelectsTheUnpartitionedRowsOutsideTheOtherPartitions) {
+	vector<string> partition_ids {"20240101", "20240102", "__NULL__", "__UNPARTITIONED__"};
+	string predicate;
+	ASSERT_TRUE(BigQuerySyncFunction::PartitionPredicate(DayPartitioning(), "__UNPARTITIONED__", partition_ids,
+	                                                     predicate));
+	EXPECT_EQ(predicate, "event_date IS NOT NULL AND NOT ((event_date >= DATE '2024-01-01' AND event_date < DATE "
+	                     "'2024-01-02') OR (event_date >= DATE '2024-01-02' AND event_date < DATE '2024-01-03'))");
+
+	ASSERT_TRUE(BigQuerySyncFunction::PartitionPredicate(DayPartitioning(), "__UNPARTITIONED__",
+	                                                     {"__UNPARTITIONED__"}, predicate));
+	EXPECT_EQ(predicate, "event_date IS NOT NULL");
+}
+
+TEST(BigQuerySyncTest, RejectsPartitionsWithoutAColumn) {
+	// ingestion time partitioning
+	auto partitioning = DayPartitioning();
+	partitioning.column.clear();
+	string predicate;
+	EXPECT_FALSE(BigQuerySyncFunction::PartitionPredicate(partitioning, "20240101", {"20240101"}, predicate));
+	EXPECT_FALSE(BigQuerySyncFunction::PartitionPredicate(DayPartitioning(), "", {""}, predicate));
+	EXPECT_FALSE(BigQuerySyncFunction::PartitionPredicate(DayPartitioning(), "not-a-date", {"not-a-date"},
+	                                                      predicate));
+}
+
+} // namespace duckdb
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "duckdb.hpp"
+#include "storage/bigquery_table_cache.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace duckdb {
+
+static constexpr int64_t NO_EXPIRY = 3600 * 1000;
+
+static BigQueryScanCacheKey MakeKey(const string &table, vector<string> fields, string row_restriction = "") {
+	BigQueryScanCacheKey key;
+	key.table = "projects/p/datasets/d/tables/" + table;
+	key.version = "1700000000000";
+	key.fields = std::move(fields);
+	key.row_restriction = std::move(row_restriction);
+	return key;
+}
+
+//! Creates an entry with the given columns, the value of every row is the column id
+static shared_ptr<BigQueryTableCacheEntry> MakeEntry(BigQueryScanCacheKey key, vector<column_t> column_ids,
+                                                     idx_t row_count = 10) {
+	auto entry = make_shared_ptr<BigQueryTableCacheEntry>();
+	entry->key = std::move(key);
+	entry->column_ids = std::move(column_ids);
+	vector<LogicalType> types(entry->column_ids.size(), LogicalType::BIGINT);
+	entry->collection = make_shared_ptr<ColumnDataCollection>(Allocator::DefaultAllocator(), types);
+	DataChunk chunk;
+	chunk.Initialize(Allocator::DefaultAllocator(), types);
+	for (idx_t col_idx = 0; col_idx < types.size(); col_idx++) {
+		for (idx_t row_idx = 0; row_idx < row_count; row_idx++) {
+			chunk.SetValue(col_idx, row_idx, Value::BIGINT(static_cast<int64_t>(entry->column_ids[col_idx])));
+		}
+	}
+	chunk.SetCardinality(row_count);
+	entry->collection->Append(chunk);
+	return entry;
+}
+
+static void Sleep() {
+	// entries are timed in milliseconds
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
+
+TEST(BigQueryTableCacheTest, ServesColumnSubsets) {
+	BigQueryTableCache cache;
+	auto entry = MakeEntry(MakeKey("t", {"a", "b", "c"}), {0, 1, 2});
+	cache.Put(entry, NO_EXPIRY, NumericLimits<idx_t>::Maximum());
+
+	auto result = cache.TryGet(MakeKey("t", {"a", "c"}), {2, 0}, NO_EXPIRY);
+	ASSERT_TRUE(result);
+	EXPECT_EQ(result, entry);
+	EXPECT_EQ(result->collection->Count(), 10u);
+	EXPECT_EQ(result->collection->GetValue(2, 0), Value::BIGINT(2));
+
+	EXPECT_FALSE(cache.TryGet(MakeKey("t", {"a", "d"}), {0, 3}, NO_EXPIRY));
+	// the columns must be cached as well, e.g. not for the row id
+	EXPECT_FALSE(cache.TryGet(MakeKey("t", {"a"}), {0, COLUMN_IDENTIFIER_ROW_ID}, NO_EXPIRY));
+	EXPECT_FALSE(cache.TryGet(MakeKey("t", {"a"}, "a > 1"), {0}, NO_EXPIRY));
+	EXPECT_FALSE(cache.TryGet(MakeKey("u", {"a"}), {0}, NO_EXPIRY));
+}
+
+TEST(BigQueryTableCacheTest, ExpiresEntries) {
+	BigQueryTableCache cache;
+	cache.Put(MakeEntry(MakeKey("t", {"a"}), {0}), NO_EXPIRY, NumericLimits<idx_t>::Maximum());
+	Sleep();
+	EXPECT_TRUE(cache.TryGet(MakeKey("t", {"a"}), {0}, NO_EXPIRY));
+	EXPECT_FALSE(cache.TryGet(MakeKey("t", {"a"}), {0}, 1));
+	// the expired entry has been removed
+	EXPECT_FALSE(cache.TryGet(MakeKey("t", {"a"}), {0}, NO_EXPIRY));
+}
+
+TEST(BigQueryTableCacheTest, RemovesExpiredEntriesOnPut) {
+	BigQueryTableCache cache;
+	cache.Put(MakeEntry(MakeKey("t", {"a"}), {0}), NO_EXPIRY, NumericLimits<idx_t>::Maximum());
+	Sleep();
+	cache.Put(MakeEntry(MakeKey("u", {"a"}), {0}), 1, NumericLimits<idx_t>::Maximum());
+	EXPECT_FALSE(cache.TryGet(MakeKey("t", {"a"}), {0}, NO_EXPIRY));
+	EXPECT_TRUE(cache.TryGet(MakeKey("u", {"a"}), {0}, NO_EXPIRY));
+}
+
+TEST(BigQueryTableCacheTest, RemovesOtherVersions) {
+	BigQueryTableCache cache;
+	cache.Put(MakeEntry(MakeKey("t", {"a"}), {0}), NO_EXPIRY, NumericLimits<idx_t>::Maximum());
+	auto newer_key = MakeKey("t", {"a"});
+	newer_key.version = "1700000000001";
+	EXPECT_FALSE(cache.TryGet(newer_key, {0}, NO_EXPIRY));
+	EXPECT_FALSE(cache.TryGet(MakeKey("t", {"a"}), {0}, NO_EXPIRY));
+}
+
+TEST(BigQueryTableCacheTest, SupersedesNarrowerEntries) {
+	BigQueryTableCache cache;
+	auto narrow_entry = MakeEntry(MakeKey("t", {"a"}), {0});
+	auto filtered_entry = MakeEntry(MakeKey("t", {"a"}, "a > 1"), {0});
+	cache.Put(narrow_entry, NO_EXPIRY, NumericLimits<idx_t>::Maximum());
+	cache.Put(filtered_entry, NO_EXPIRY, NumericLimits<idx_t>::Maximum());
+	auto wide_entry = MakeEntry(MakeKey("t", {"a", "b"}), {0, 1});
+	cache.Put(wide_entry, NO_EXPIRY, NumericLimits<idx_t>::Maximum());
+
+	// the smaller narrow entry would be preferred if it was still cached
+	EXPECT_EQ(cache.TryGet(MakeKey("t", {"a"}), {0}, NO_EXPIRY), wide_entry);
+	// entries with another restriction are not superseded
+	EXPECT_EQ(cache.TryGet(MakeKey("t", {"a"}, "a > 1"), {0}, NO_EXPIRY), filtered_entry);
+}
+
+TEST(BigQueryTableCacheTest, EvictsTheLeastRecentlyUsedEntries) {
+	BigQueryTableCache cache;
+	auto first_entry = MakeEntry(MakeKey("t", {"a"}), {0});
+	auto entry_size = first_entry->collection->SizeInBytes();
+	auto max_bytes = entry_size * 5 / 2;
+	cache.Put(first_entry, NO_EXPIRY, max_bytes);
+	Sleep();
+	cache.Put(MakeEntry(MakeKey("u", {"a"}), {0}), NO_EXPIRY, max_bytes);
+	Sleep();
+	// reading the first entry makes the second one the least recently used
+	EXPECT_TRUE(cache.TryGet(MakeKey("t", {"a"}), {0}, NO_EXPIRY));
+	Sleep();
+	cache.Put(MakeEntry(MakeKey("v", {"a"}), {0}), NO_EXPIRY, max_bytes);
+
+	EXPECT_TRUE(cache.TryGet(MakeKey("t", {"a"}), {0}, NO_EXPIRY));
+	EXPECT_FALSE(cache.TryGet(MakeKey("u", {"a"}), {0}, NO_EXPIRY));
+	EXPECT_TRUE(cache.TryGet(MakeKey("v", {"a"}), {0}, NO_EXPIRY));
+}
+
+TEST(BigQueryTableCacheTest, DoesNotKeepEntriesLargerThanTheLimit) {
+	BigQueryTableCache cache;
+	auto entry = MakeEntry(MakeKey("t", {"a"}), {0});
+	cache.Put(entry, NO_EXPIRY, entry->collection->SizeInBytes() - 1);
+	EXPECT_FALSE(cache.TryGet(MakeKey("t", {"a"}), {0}, NO_EXPIRY));
+}
+
+} // namespace duckdb
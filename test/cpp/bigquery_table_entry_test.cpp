@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "duckdb.hpp"
+#include "storage/bigquery_table_entry.hpp"
+#include "duckdb/main/config.hpp"
+
+namespace duckdb {
+
+class BigQueryExternalScanTest : public ::testing::Test {
+protected:
+	BigQueryExternalScanTest() : db(nullptr), con(db) {
+		DBConfig::GetConfig(*db.instance)
+		    .AddExtensionOption("bigquery_external_tables_direct", "", LogicalType::BOOLEAN, Value::BOOLEAN(true));
+		columns.AddColumn(ColumnDefinition("id", LogicalType::BIGINT));
+	}
+
+	bool TryBind(const string &format, const vector<string> &uris) {
+		TableFunction function;
+		unique_ptr<FunctionData> bind_data;
+		bool bound = false;
+		con.context->RunFunctionInTransaction([&]() {
+			bound = BigQueryTableEntry::TryBindExternalScan(*con.context, format, uris, false, columns, function,
+			                                                bind_data);
+		});
+		return bound;
+	}
+
+	DuckDB db;
+	Connection con;
+	ColumnList columns;
+};
+
+TEST_F(BigQueryExternalScanTest, FallsBackForFilesThatCannotBeRead) {
+	// the Parquet reader fails to bind, the table is read through BigQuery instead of failing the query
+	EXPECT_FALSE(TryBind("PARQUET", {"/nonexistent/bigquery_external_table/*.parquet"}));
+}
+
+TEST_F(BigQueryExternalScanTest, FallsBackForOtherFormats) {
+	EXPECT_FALSE(TryBind("ORC", {"/nonexistent/bigquery_external_table/data.orc"}));
+	EXPECT_FALSE(TryBind("PARQUET", {}));
+}
+
+TEST_F(BigQueryExternalScanTest, FallsBackWhenDisabled) {
+	con.Query("SET bigquery_external_tables_direct=false");
+	EXPECT_FALSE(TryBind("PARQUET", {"/nonexistent/bigquery_external_table/*.parquet"}));
+}
+
+} // namespace duckdb
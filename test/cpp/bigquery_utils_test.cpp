@@ -1,16 +1,102 @@
 #include <gtest/gtest.h>
-//#include "bigquery_utils.hpp"
-#include <nlohmann/json.hpp>
-
-using json = nlohmann::json;
+#include "bigquery_utils.hpp"
 
 namespace duckdb {
 
-TEST(BigQueryUtilsTest, ParsesEmptySchema) {
-    json empty_schema = {{"fields", json::array()}};
-    //auto result = BigQueryUtils::ParseColumnFields(empty_schema);
-    //EXPECT_TRUE(result.empty());
-    EXPECT_TRUE(true);
+static BQTableMetadata ParseTable(const string &table_json) {
+	return BigQueryUtils::ParseTableJSONResponse(web::json::value::parse(utility::conversions::to_string_t(table_json)));
+}
+
+TEST(BigQueryUtilsTest, ParsesSQLTypes) {
+	EXPECT_EQ(BigQueryUtils::SQLTypeToLogicalType("INT64"), LogicalType::BIGINT);
+	EXPECT_EQ(BigQueryUtils::SQLTypeToLogicalType("FLOAT64"), LogicalType::DOUBLE);
+	EXPECT_EQ(BigQueryUtils::SQLTypeToLogicalType("BOOL"), LogicalType::BOOLEAN);
+	// the parameters do not change the type
+	EXPECT_EQ(BigQueryUtils::SQLTypeToLogicalType("STRING(10)"), LogicalType::VARCHAR);
+	EXPECT_EQ(BigQueryUtils::SQLTypeToLogicalType("NUMERIC(10, 2)"), LogicalType::DECIMAL(38, 9));
+	EXPECT_EQ(BigQueryUtils::SQLTypeToLogicalType("ARRAY<INT64>"), LogicalType::LIST(LogicalType::BIGINT));
+	EXPECT_EQ(BigQueryUtils::SQLTypeToLogicalType("STRUCT<a INT64, `b c` ARRAY<STRING>>"),
+	          LogicalType::STRUCT({{"a", LogicalType::BIGINT}, {"b c", LogicalType::LIST(LogicalType::VARCHAR)}}));
+	EXPECT_THROW(BigQueryUtils::SQLTypeToLogicalType("ARRAY<INT64"), IOException);
+	EXPECT_THROW(BigQueryUtils::SQLTypeToLogicalType("INT64 INT64"), IOException);
+}
+
+TEST(BigQueryUtilsTest, RoundTripsSQLTypes) {
+	vector<LogicalType> types {LogicalType::BIGINT,
+	                           LogicalType::DOUBLE,
+	                           LogicalType::BOOLEAN,
+	                           LogicalType::DATE,
+	                           LogicalType::TIMESTAMP,
+	                           LogicalType::TIMESTAMP_TZ,
+	                           LogicalType::DECIMAL(38, 9),
+	                           LogicalType::BLOB,
+	                           LogicalType::VARCHAR,
+	                           LogicalType::JSON(),
+	                           LogicalType::LIST(LogicalType::DATE),
+	                           LogicalType::STRUCT({{"id", LogicalType::BIGINT},
+	                                                {"tags", LogicalType::LIST(LogicalType::VARCHAR)}})};
+	for (auto &type : types) {
+		EXPECT_EQ(BigQueryUtils::SQLTypeToLogicalType(BigQueryUtils::LogicalTypeToSQLType(type)), type)
+		    << type.ToString();
+	}
+}
+
+TEST(BigQueryUtilsTest, RoundTripsRepeatedFields) {
+	// REPEATED fields of the REST schema become lists, which are written back as ARRAY
+	auto metadata = ParseTable(R"({"schema": {"fields": [
+		{"name": "ids", "type": "INTEGER", "mode": "REPEATED"},
+		{"name": "events", "type": "RECORD", "mode": "REPEATED", "fields": [
+			{"name": "name", "type": "STRING"},
+			{"name": "at", "type": "TIMESTAMP"}
+		]}
+	]}})");
+	ASSERT_EQ(metadata.columns.size(), 2u);
+	EXPECT_EQ(metadata.columns[0].type, LogicalType::LIST(LogicalType::BIGINT));
+	EXPECT_EQ(BigQueryUtils::LogicalTypeToSQLType(metadata.columns[0].type), "ARRAY<INT64>");
+	EXPECT_EQ(metadata.columns[1].type.id(), LogicalTypeId::LIST);
+	for (auto &column : metadata.columns) {
+		EXPECT_EQ(BigQueryUtils::SQLTypeToLogicalType(BigQueryUtils::LogicalTypeToSQLType(column.type)), column.type);
+	}
+}
+
+TEST(BigQueryUtilsTest, ParsesPartitionedTables) {
+	auto metadata = ParseTable(R"({"type": "TABLE", "numRows": "42", "lastModifiedTime": "1700000000000",
+		"etag": "abc", "schema": {"fields": [{"name": "event_date", "type": "DATE"}]},
+		"timePartitioning": {"type": "MONTH", "field": "event_date"},
+		"clustering": {"fields": ["event_date", "id"]},
+		"tableConstraints": {"primaryKey": {"columns": ["event_date"]}}})");
+	EXPECT_EQ(metadata.table_type, "TABLE");
+	EXPECT_EQ(metadata.num_rows, 42u);
+	EXPECT_EQ(metadata.last_modified_time, "1700000000000");
+	EXPECT_EQ(metadata.etag, "abc");
+	EXPECT_EQ(metadata.partition_type, "MONTH");
+	EXPECT_EQ(metadata.partition_column, "event_date");
+	EXPECT_EQ(metadata.primary_key, vector<string>({"event_date"}));
+	EXPECT_EQ(metadata.clustering_fields, vector<string>({"event_date", "id"}));
+
+	auto range_metadata = ParseTable(R"({"schema": {"fields": [{"name": "id", "type": "INTEGER"}]},
+		"rangePartitioning": {"field": "id", "range": {"start": "0", "end": "1000", "interval": "10"}}})");
+	EXPECT_EQ(range_metadata.partition_type, "RANGE");
+	EXPECT_EQ(range_metadata.partition_column, "id");
+	EXPECT_EQ(range_metadata.partition_range_interval, 10);
+
+	// ingestion time partitioning has no column
+	auto ingestion_metadata = ParseTable(R"({"schema": {"fields": [{"name": "id", "type": "INTEGER"}]},
+		"timePartitioning": {"type": "DAY"}})");
+	EXPECT_EQ(ingestion_metadata.partition_type, "DAY");
+	EXPECT_TRUE(ingestion_metadata.partition_column.empty());
+}
+
+TEST(BigQueryUtilsTest, ParsesExternalTables) {
+	auto metadata = ParseTable(R"({"type": "EXTERNAL", "schema": {"fields": [{"name": "id", "type": "INTEGER"}]},
+		"externalDataConfiguration": {"sourceFormat": "PARQUET",
+			"sourceUris": ["gs://bucket/a/*.parquet", "gs://bucket/b/*.parquet"],
+			"hivePartitioningOptions": {"mode": "AUTO"}}})");
+	EXPECT_EQ(metadata.table_type, "EXTERNAL");
+	EXPECT_EQ(metadata.external_format, "PARQUET");
+	EXPECT_EQ(metadata.external_uris, vector<string>({"gs://bucket/a/*.parquet", "gs://bucket/b/*.parquet"}));
+	EXPECT_TRUE(metadata.external_hive_partitioning);
+	EXPECT_TRUE(metadata.partition_type.empty());
 }
 
 } // namespace duckdb